@@ -0,0 +1,272 @@
+//          Copyright Roman Kashitsyn 2014 - 2015.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// Throughput benchmarks of the stream, range and conversion hot paths.
+//
+// Usage: csv_bench [--size=MB] [--min-time=SECONDS] [FILTER]
+//
+// Every benchmark whose name contains FILTER is run on generated
+// inputs of about MB megabytes (default 16) until it has taken at least
+// SECONDS (default 1) of wall time. Reported are input or output
+// megabytes per second, records per second and heap allocations per
+// record, counted by the replaced global operator new.
+
+#if __cplusplus < 201103
+#error csv_bench requires C++11
+#endif
+
+#include "generators.hpp"
+
+#include "text/csv/istream.hpp"
+#include "text/csv/iterator.hpp"
+#include "text/csv/ostream.hpp"
+#include "text/csv/rows.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+unsigned long long allocations = 0;
+
+} // namespace
+
+void *operator new(std::size_t n) {
+    ++allocations;
+    if (void *p = std::malloc(n ? n : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+
+namespace csv = ::text::csv;
+namespace bench = ::text::csv::bench;
+
+namespace {
+
+/// Result of one pass over the input; <tt>check</tt> keeps the work
+/// from being optimized away.
+struct pass {
+    std::size_t bytes;
+    std::size_t rows;
+    std::size_t check;
+};
+
+struct options {
+    std::size_t megabytes;
+    double min_time;
+    const char *filter;
+};
+
+std::size_t checksum = 0;
+
+template <typename F>
+void run(const options &opt, const std::string &name, F fn) {
+    if (opt.filter && name.find(opt.filter) == std::string::npos)
+        return;
+    typedef std::chrono::steady_clock clock;
+
+    checksum += fn().check; // warm-up
+    std::size_t bytes = 0, rows = 0, iterations = 0;
+    const unsigned long long allocs_before = allocations;
+    const clock::time_point start = clock::now();
+    double elapsed = 0;
+    do {
+        const pass p = fn();
+        bytes += p.bytes;
+        rows += p.rows;
+        checksum += p.check;
+        ++iterations;
+        elapsed = std::chrono::duration<double>(clock::now() - start).count();
+    } while (elapsed < opt.min_time);
+    const unsigned long long allocs = allocations - allocs_before;
+
+    std::printf("%-36s %10.1f %12.0f %11.2f %6zu\n", name.c_str(),
+                double(bytes) / elapsed / 1e6, double(rows) / elapsed,
+                rows ? double(allocs) / double(rows) : 0.0, iterations);
+    std::fflush(stdout);
+}
+
+/// Reads every field with operator>> into one reused string.
+template <typename Char>
+pass read_fields(const std::basic_string<Char> &text, std::size_t rows) {
+    std::basic_istringstream<Char> in(text);
+    csv::basic_csv_istream<Char> is(in);
+    std::basic_string<Char> field;
+    pass p = {text.size() * sizeof(Char), rows, 0};
+    while (is) {
+        is >> field;
+        p.check += field.size();
+        if (!is.has_more_fields())
+            is.has_more_fields(true);
+    }
+    return p;
+}
+
+template <typename Char>
+pass read_rows(const std::basic_string<Char> &text, std::size_t rows) {
+    std::basic_istringstream<Char> in(text);
+    csv::basic_row_range<Char> range(in);
+    pass p = {text.size() * sizeof(Char), rows, 0};
+    for (typename csv::basic_row_range<Char>::iterator r = range.begin(),
+                                                       e = range.end();
+         r != e; ++r)
+        p.check += r->size();
+    return p;
+}
+
+pass read_map_rows(const std::string &text, std::size_t rows) {
+    std::istringstream in(text);
+    csv::map_row_range range(in);
+    pass p = {text.size(), rows, 0};
+    for (csv::map_row_range::iterator r = range.begin(), e = range.end();
+         r != e; ++r)
+        p.check += (*r)[r->name_of(0)].size();
+    return p;
+}
+
+/// Converts every field after the first with as<double>().
+template <typename Char>
+pass convert_rows(const std::basic_string<Char> &text, std::size_t rows) {
+    std::basic_istringstream<Char> in(text);
+    csv::basic_row_range<Char> range(in);
+    pass p = {text.size() * sizeof(Char), rows, 0};
+    double sum = 0;
+    typename csv::basic_row_range<Char>::iterator r = range.begin();
+    for (++r; r != range.end(); ++r) {
+        for (std::size_t i = 1; i < r->size(); ++i)
+            sum += r->template as<double>(i);
+    }
+    p.check = std::size_t(sum);
+    return p;
+}
+
+/// Parses the text once so that writing can be timed on its own.
+template <typename Char>
+std::vector<csv::basic_row<Char> >
+parse_all(const std::basic_string<Char> &text) {
+    std::basic_istringstream<Char> in(text);
+    csv::basic_row_range<Char> range(in);
+    std::vector<csv::basic_row<Char> > table;
+    for (typename csv::basic_row_range<Char>::iterator r = range.begin(),
+                                                       e = range.end();
+         r != e; ++r)
+        table.push_back(*r);
+    return table;
+}
+
+template <typename Char>
+pass write_strings(const std::vector<csv::basic_row<Char> > &table) {
+    std::basic_ostringstream<Char> out;
+    csv::basic_csv_ostream<Char> os(out);
+    for (std::size_t i = 0; i < table.size(); ++i)
+        os << table[i];
+    os.flush();
+    pass p = {out.str().size() * sizeof(Char), table.size(), 0};
+    p.check = p.bytes;
+    return p;
+}
+
+/// Writes rows of an integer and seven doubles.
+template <typename Char>
+pass write_numbers(std::size_t rows) {
+    std::basic_ostringstream<Char> out;
+    csv::basic_csv_ostream<Char> os(out);
+    bench::random rng(5);
+    for (std::size_t i = 0; i < rows; ++i) {
+        os << static_cast<unsigned long>(i);
+        for (int c = 0; c < 7; ++c)
+            os << double(rng.next() % 100000000) / 1000.0;
+        os << csv::endl;
+    }
+    os.flush();
+    pass p = {out.str().size() * sizeof(Char), rows, 0};
+    p.check = p.bytes;
+    return p;
+}
+
+bool starts_with(const char *arg, const char *prefix) {
+    return std::strncmp(arg, prefix, std::strlen(prefix)) == 0;
+}
+} // namespace
+
+int main(int argc, char **argv) {
+    options opt = {16, 1.0, 0};
+    for (int i = 1; i < argc; ++i) {
+        if (starts_with(argv[i], "--size="))
+            opt.megabytes = std::strtoul(argv[i] + 7, 0, 10);
+        else if (starts_with(argv[i], "--min-time="))
+            opt.min_time = std::strtod(argv[i] + 11, 0);
+        else if (argv[i][0] == '-') {
+            std::fprintf(stderr, "usage: %s [--size=MB] [--min-time=SECONDS] "
+                                 "[FILTER]\n",
+                         argv[0]);
+            return 2;
+        } else
+            opt.filter = argv[i];
+    }
+    const std::size_t bytes = opt.megabytes << 20;
+
+    std::vector<bench::workload> workloads;
+    workloads.push_back(bench::narrow_numeric(bytes, "\n"));
+    workloads.push_back(bench::narrow_numeric(bytes, "\r\n"));
+    workloads.push_back(bench::wide(bytes));
+    workloads.push_back(bench::quote_heavy(bytes));
+    workloads.push_back(bench::free_text(bytes));
+
+    std::printf("%-36s %10s %12s %11s %6s\n", "benchmark", "MB/s", "rows/s",
+                "allocs/row", "iters");
+
+    for (std::size_t i = 0; i < workloads.size(); ++i) {
+        const bench::workload &w = workloads[i];
+        run(opt, "istream_fields/" + w.name,
+            [&] { return read_fields(w.text, w.rows); });
+        run(opt, "row_range/" + w.name,
+            [&] { return read_rows(w.text, w.rows); });
+        run(opt, "map_row_range/" + w.name,
+            [&] { return read_map_rows(w.text, w.rows); });
+    }
+
+    const bench::workload &numeric = workloads[0];
+    run(opt, "as_double/" + numeric.name,
+        [&] { return convert_rows(numeric.text, numeric.rows); });
+    run(opt, "as_double/" + workloads[2].name,
+        [&] { return convert_rows(workloads[2].text, workloads[2].rows); });
+
+    run(opt, "ostream_numbers/char",
+        [&] { return write_numbers<char>(numeric.rows); });
+    for (std::size_t i = 2; i < workloads.size(); ++i) {
+        const bench::workload &w = workloads[i];
+        if (opt.filter && ("ostream_strings/" + w.name).find(opt.filter) ==
+                              std::string::npos)
+            continue;
+        const std::vector<csv::row> table = parse_all(w.text);
+        run(opt, "ostream_strings/" + w.name,
+            [&] { return write_strings(table); });
+    }
+
+    // The same numeric input with wide characters.
+    const std::wstring wide_text = bench::widen(numeric.text);
+    run(opt, "istream_fields/wchar_" + numeric.name,
+        [&] { return read_fields(wide_text, numeric.rows); });
+    run(opt, "row_range/wchar_" + numeric.name,
+        [&] { return read_rows(wide_text, numeric.rows); });
+    run(opt, "as_double/wchar_" + numeric.name,
+        [&] { return convert_rows(wide_text, numeric.rows); });
+    run(opt, "ostream_numbers/wchar",
+        [&] { return write_numbers<wchar_t>(numeric.rows); });
+
+    std::fprintf(stderr, "checksum %zu\n", checksum);
+    return 0;
+}
@@ -0,0 +1,195 @@
+#ifndef TEXT_CSV_BENCH_GENERATORS_HPP
+#define TEXT_CSV_BENCH_GENERATORS_HPP
+
+//          Copyright Roman Kashitsyn 2014 - 2015.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// Deterministic generators of synthetic CSV inputs for csv_bench. The
+// same size and seed give byte-identical text on every platform, so
+// numbers from different builds can be compared.
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+
+namespace text {
+namespace csv {
+namespace bench {
+
+/// SplitMix64: tiny, fast and fully specified, unlike the standard
+/// distributions.
+class random {
+public:
+    explicit random(unsigned long long seed)
+        : state_(seed) {}
+
+    unsigned long long next() {
+        unsigned long long z = (state_ += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    /// Returns a number in [0, n).
+    std::size_t below(std::size_t n) {
+        return std::size_t(next() % n);
+    }
+
+private:
+    unsigned long long state_;
+};
+
+struct workload {
+    std::string name;
+    std::string text;
+    std::size_t rows;
+};
+
+/// Appends <tt>field</tt>, quoted as RFC 4180 requires.
+inline void append_field(std::string &out, const std::string &field) {
+    if (field.find_first_of(",\"\r\n") == std::string::npos) {
+        out += field;
+        return;
+    }
+    out += '"';
+    for (std::size_t i = 0; i < field.size(); ++i) {
+        if (field[i] == '"')
+            out += '"';
+        out += field[i];
+    }
+    out += '"';
+}
+
+inline void append_number(std::string &out, unsigned long long v) {
+    char buf[32];
+    std::snprintf(buf, sizeof buf, "%llu", v);
+    out += buf;
+}
+
+inline void append_decimal(std::string &out, random &rng) {
+    char buf[32];
+    std::snprintf(buf, sizeof buf, "%.4f",
+                  double(rng.next() % 100000000) / 1000.0);
+    out += buf;
+}
+
+inline const char *word(random &rng) {
+    static const char *const words[] = {
+        "lorem", "ipsum", "dolor", "sit",   "amet",   "consectetur",
+        "adipiscing", "elit", "sed", "do",  "eiusmod", "tempor",
+        "incididunt", "ut", "labore", "et", "dolore", "magna",
+        "aliqua", "enim", "ad", "minim", "veniam", "quis"};
+    return words[rng.below(sizeof words / sizeof words[0])];
+}
+
+/// Eight columns of integers and decimals.
+inline workload narrow_numeric(std::size_t bytes, const char *eol) {
+    workload w;
+    w.name = std::string("numeric_") + (eol[0] == '\r' ? "crlf" : "lf");
+    w.rows = 0;
+    random rng(1);
+    w.text = "id,qty,price,cost,a,b,c,d";
+    w.text += eol;
+    while (w.text.size() < bytes) {
+        append_number(w.text, w.rows);
+        for (int c = 1; c < 8; ++c) {
+            w.text += ',';
+            if (c % 2)
+                append_number(w.text, rng.below(100000));
+            else
+                append_decimal(w.text, rng);
+        }
+        w.text += eol;
+        ++w.rows;
+    }
+    return w;
+}
+
+/// 500 columns of short integers.
+inline workload wide(std::size_t bytes) {
+    workload w;
+    w.name = "wide_500";
+    w.rows = 0;
+    random rng(2);
+    for (int c = 0; c < 500; ++c) {
+        if (c)
+            w.text += ',';
+        w.text += 'c';
+        append_number(w.text, c);
+    }
+    w.text += '\n';
+    while (w.text.size() < bytes) {
+        for (int c = 0; c < 500; ++c) {
+            if (c)
+                w.text += ',';
+            append_number(w.text, rng.below(1000));
+        }
+        w.text += '\n';
+        ++w.rows;
+    }
+    return w;
+}
+
+/// Short fields that mostly need quoting: embedded delimiters, doubled
+/// quotes and line breaks.
+inline workload quote_heavy(std::size_t bytes) {
+    workload w;
+    w.name = "quote_heavy";
+    w.rows = 0;
+    random rng(3);
+    w.text = "id,a,b,c,d\n";
+    std::string field;
+    while (w.text.size() < bytes) {
+        append_number(w.text, w.rows);
+        for (int c = 0; c < 4; ++c) {
+            field = word(rng);
+            switch (rng.below(4)) {
+            case 0: field += ", "; break;
+            case 1: field += " \"x\" "; break;
+            case 2: field += "\n"; break;
+            default: break;
+            }
+            field += word(rng);
+            w.text += ',';
+            append_field(w.text, field);
+        }
+        w.text += '\n';
+        ++w.rows;
+    }
+    return w;
+}
+
+/// An id and a long free-text column of 50 to 300 words.
+inline workload free_text(std::size_t bytes) {
+    workload w;
+    w.name = "free_text";
+    w.rows = 0;
+    random rng(4);
+    w.text = "id,text\n";
+    std::string field;
+    while (w.text.size() < bytes) {
+        field.clear();
+        for (std::size_t n = 50 + rng.below(250); n > 0; --n) {
+            field += word(rng);
+            field += rng.below(12) ? " " : ", ";
+        }
+        append_number(w.text, w.rows);
+        w.text += ',';
+        append_field(w.text, field);
+        w.text += '\n';
+        ++w.rows;
+    }
+    return w;
+}
+
+/// Widens an ASCII text to wchar_t.
+inline std::wstring widen(const std::string &s) {
+    return std::wstring(s.begin(), s.end());
+}
+} // namespace bench
+} // namespace csv
+} // namespace text
+
+#endif
@@ -0,0 +1,433 @@
+#ifndef TEXT_CSV_ADAPTORS_HPP
+#define TEXT_CSV_ADAPTORS_HPP
+
+//          Copyright Roman Kashitsyn 2014 - 2015.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// Lazy range adaptors. Requires C++11.
+
+#if __cplusplus >= 201103
+
+#include "iterator.hpp"
+
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Range adaptors
+// ==============
+//
+// Adaptors are applied with operator| to a basic_row_range, a
+// basic_map_row_range, any other input range or another adapted range:
+//
+//     row_range rows(in);
+//     for (const row &r : rows | filter(pred) | select({0, 2}) | take(10))
+//         ...
+//
+// The result is a single pull loop: each step of its iterator asks the
+// last adaptor for the next element, which asks the one before it, down
+// to the underlying range. Rows are passed along by pointer, so nothing
+// is copied between steps and no intermediate containers are built.
+// The underlying range is advanced only when an element is needed;
+// take(n) therefore reads exactly n records from the stream.
+
+namespace text {
+namespace csv {
+namespace detail {
+
+struct lazy_range_base {};
+
+/// Input iterator over a lazy range; an iterator with a range is at the
+/// end when the range has no current element.
+template <typename Range>
+class lazy_iterator {
+public:
+    typedef std::input_iterator_tag iterator_category;
+    typedef typename Range::value_type value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const value_type *pointer;
+    typedef const value_type &reference;
+
+    lazy_iterator()
+        : range_(0) {}
+
+    explicit lazy_iterator(Range &range)
+        : range_(&range) {}
+
+    reference operator*() const { return *range_->current(); }
+
+    pointer operator->() const { return range_->current(); }
+
+    lazy_iterator &operator++() {
+        range_->advance();
+        return *this;
+    }
+
+    lazy_iterator operator++(int) {
+        lazy_iterator tmp = *this;
+        range_->advance();
+        return tmp;
+    }
+
+    bool operator==(const lazy_iterator &rhs) const {
+        return at_end() ? rhs.at_end() : range_ == rhs.range_;
+    }
+
+    bool operator!=(const lazy_iterator &rhs) const { return !(*this == rhs); }
+
+private:
+    bool at_end() const { return !range_ || !range_->current(); }
+
+    Range *range_;
+};
+
+/// Base of all adapted ranges. <tt>Derived::next()</tt> returns a
+/// pointer to the next element, or null once the range is exhausted.
+template <typename Derived, typename Value>
+class lazy_range : public lazy_range_base {
+public:
+    typedef Value value_type;
+    typedef lazy_iterator<Derived> iterator;
+    typedef iterator const_iterator;
+
+    lazy_range()
+        : current_(0)
+        , started_(false) {}
+
+    iterator begin() {
+        if (!started_) {
+            started_ = true;
+            advance();
+        }
+        return iterator(static_cast<Derived &>(*this));
+    }
+
+    iterator end() { return iterator(); }
+
+    const value_type *current() const { return current_; }
+
+    void advance() { current_ = static_cast<Derived &>(*this).next(); }
+
+private:
+    const value_type *current_;
+    bool started_;
+};
+
+/// Pulls elements from an ordinary range, which is referenced, not
+/// copied.
+template <typename Range>
+class range_source
+    : public lazy_range<
+          range_source<Range>,
+          typename std::decay<decltype(*std::declval<Range &>().begin())>::
+              type> {
+    typedef decltype(std::declval<Range &>().begin()) range_iterator;
+
+public:
+    typedef typename std::decay<decltype(
+        *std::declval<range_iterator &>())>::type value_type;
+
+    explicit range_source(Range &range)
+        : range_(&range)
+        , started_(false) {}
+
+    const value_type *next() {
+        if (!started_) {
+            started_ = true;
+            it_ = range_->begin();
+            end_ = range_->end();
+        } else {
+            ++it_;
+        }
+        return it_ == end_ ? 0 : &*it_;
+    }
+
+private:
+    Range *range_;
+    range_iterator it_;
+    range_iterator end_;
+    bool started_;
+};
+
+/// Turns the left operand of operator| into a source: adapted ranges are
+/// moved or copied into the new adaptor, other ranges are referenced.
+template <typename Range, bool = std::is_base_of<
+                              lazy_range_base,
+                              typename std::decay<Range>::type>::value>
+struct source_of {
+    typedef range_source<typename std::remove_reference<Range>::type> type;
+
+    static type make(typename std::remove_reference<Range>::type &range) {
+        return type(range);
+    }
+};
+
+template <typename Range>
+struct source_of<Range, true> {
+    typedef typename std::decay<Range>::type type;
+
+    static type make(const type &range) { return range; }
+
+    static type make(type &&range) { return std::move(range); }
+};
+
+template <typename Source, typename Pred>
+class filter_range
+    : public lazy_range<filter_range<Source, Pred>,
+                        typename Source::value_type> {
+public:
+    typedef typename Source::value_type value_type;
+
+    filter_range(Source source, Pred pred)
+        : source_(std::move(source))
+        , pred_(std::move(pred)) {}
+
+    const value_type *next() {
+        while (const value_type *p = source_.next()) {
+            if (pred_(*p))
+                return p;
+        }
+        return 0;
+    }
+
+private:
+    Source source_;
+    Pred pred_;
+};
+
+template <typename Source, typename F>
+struct transform_result {
+    typedef typename std::decay<decltype(std::declval<F &>()(
+        std::declval<const typename Source::value_type &>()))>::type type;
+};
+
+template <typename Source, typename F>
+class transform_range
+    : public lazy_range<transform_range<Source, F>,
+                        typename transform_result<Source, F>::type> {
+public:
+    typedef typename transform_result<Source, F>::type value_type;
+
+    transform_range(Source source, F fn)
+        : source_(std::move(source))
+        , fn_(std::move(fn))
+        , value_() {}
+
+    const value_type *next() {
+        const typename Source::value_type *p = source_.next();
+        if (!p)
+            return 0;
+        value_ = fn_(*p);
+        return &value_;
+    }
+
+private:
+    Source source_;
+    F fn_;
+    value_type value_;
+};
+
+template <typename Source>
+class take_range
+    : public lazy_range<take_range<Source>, typename Source::value_type> {
+public:
+    typedef typename Source::value_type value_type;
+
+    take_range(Source source, std::size_t n)
+        : source_(std::move(source))
+        , left_(n) {}
+
+    const value_type *next() {
+        if (left_ == 0)
+            return 0;
+        --left_;
+        return source_.next();
+    }
+
+private:
+    Source source_;
+    std::size_t left_;
+};
+
+template <typename Source>
+class drop_range
+    : public lazy_range<drop_range<Source>, typename Source::value_type> {
+public:
+    typedef typename Source::value_type value_type;
+
+    drop_range(Source source, std::size_t n)
+        : source_(std::move(source))
+        , skip_(n) {}
+
+    const value_type *next() {
+        for (; skip_ > 0; --skip_) {
+            if (!source_.next())
+                return 0;
+        }
+        return source_.next();
+    }
+
+private:
+    Source source_;
+    std::size_t skip_;
+};
+
+template <typename Row>
+const typename Row::value_type &select_field(const Row &row, std::size_t col) {
+    return row.at(col);
+}
+
+template <typename Row, typename String>
+const typename Row::value_type &select_field(const Row &row,
+                                             const String &name) {
+    return row[name];
+}
+
+template <typename Row>
+struct selected_row {
+    typedef typename Row::value_type string_type;
+    typedef basic_row<typename string_type::value_type,
+                      typename string_type::traits_type> type;
+};
+
+/// Copies the fields at <tt>Key</tt>s, column indices or names, into a
+/// row that is reused for all records.
+template <typename Source, typename Key>
+class select_range
+    : public lazy_range<
+          select_range<Source, Key>,
+          typename selected_row<typename Source::value_type>::type> {
+public:
+    typedef typename selected_row<typename Source::value_type>::type
+        value_type;
+
+    select_range(Source source, std::vector<Key> keys)
+        : source_(std::move(source))
+        , keys_(std::move(keys))
+        , row_(keys_.size()) {}
+
+    const value_type *next() {
+        const typename Source::value_type *p = source_.next();
+        if (!p)
+            return 0;
+        for (std::size_t i = 0, n = keys_.size(); i < n; ++i)
+            row_[i] = select_field(*p, keys_[i]);
+        return &row_;
+    }
+
+private:
+    Source source_;
+    std::vector<Key> keys_;
+    value_type row_;
+};
+
+template <typename Pred>
+struct filter_adaptor {
+    Pred pred;
+};
+
+template <typename F>
+struct transform_adaptor {
+    F fn;
+};
+
+struct take_adaptor {
+    std::size_t n;
+};
+
+struct drop_adaptor {
+    std::size_t n;
+};
+
+template <typename Key>
+struct select_adaptor {
+    std::vector<Key> keys;
+};
+} // namespace detail
+
+/// @brief Keeps the elements for which <tt>pred(element)</tt> is true.
+template <typename Pred>
+detail::filter_adaptor<Pred> filter(Pred pred) {
+    return detail::filter_adaptor<Pred>{std::move(pred)};
+}
+
+/// @brief Replaces each element with <tt>fn(element)</tt>.
+///
+/// @details The result is stored in the adaptor, one element at a
+/// time; its type must be default constructible.
+template <typename F>
+detail::transform_adaptor<F> transform(F fn) {
+    return detail::transform_adaptor<F>{std::move(fn)};
+}
+
+/// @brief Stops after <tt>n</tt> elements without reading further.
+inline detail::take_adaptor take(std::size_t n) {
+    return detail::take_adaptor{n};
+}
+
+/// @brief Skips the first <tt>n</tt> elements.
+inline detail::drop_adaptor drop(std::size_t n) {
+    return detail::drop_adaptor{n};
+}
+
+/// @brief Projects rows onto the columns with indices <tt>cols</tt>, in
+/// that order. A row without one of them throws std::out_of_range.
+inline detail::select_adaptor<std::size_t>
+select(std::initializer_list<std::size_t> cols) {
+    return detail::select_adaptor<std::size_t>{
+        std::vector<std::size_t>(cols)};
+}
+
+/// @brief Projects map rows onto the columns named <tt>names</tt>, in
+/// that order; throws std::out_of_range for an unknown name.
+template <typename Char>
+detail::select_adaptor<std::basic_string<Char> >
+select(std::initializer_list<const Char *> names) {
+    return detail::select_adaptor<std::basic_string<Char> >{
+        std::vector<std::basic_string<Char> >(names.begin(), names.end())};
+}
+
+template <typename Range, typename Pred>
+detail::filter_range<typename detail::source_of<Range>::type, Pred>
+operator|(Range &&range, detail::filter_adaptor<Pred> a) {
+    return {detail::source_of<Range>::make(std::forward<Range>(range)),
+            std::move(a.pred)};
+}
+
+template <typename Range, typename F>
+detail::transform_range<typename detail::source_of<Range>::type, F>
+operator|(Range &&range, detail::transform_adaptor<F> a) {
+    return {detail::source_of<Range>::make(std::forward<Range>(range)),
+            std::move(a.fn)};
+}
+
+template <typename Range>
+detail::take_range<typename detail::source_of<Range>::type>
+operator|(Range &&range, detail::take_adaptor a) {
+    return {detail::source_of<Range>::make(std::forward<Range>(range)), a.n};
+}
+
+template <typename Range>
+detail::drop_range<typename detail::source_of<Range>::type>
+operator|(Range &&range, detail::drop_adaptor a) {
+    return {detail::source_of<Range>::make(std::forward<Range>(range)), a.n};
+}
+
+template <typename Range, typename Key>
+detail::select_range<typename detail::source_of<Range>::type, Key>
+operator|(Range &&range, detail::select_adaptor<Key> a) {
+    return {detail::source_of<Range>::make(std::forward<Range>(range)),
+            std::move(a.keys)};
+}
+} // namespace csv
+} // namespace text
+
+#endif
+
+#endif
@@ -0,0 +1,396 @@
+#ifndef TEXT_CSV_AGGREGATE_HPP
+#define TEXT_CSV_AGGREGATE_HPP
+
+//          Copyright Roman Kashitsyn 2014 - 2015.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "batch.hpp"
+#include "hash.hpp"
+#include "parallel.hpp"
+
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace text {
+namespace csv {
+
+enum aggregate_function {
+    /// Number of fields holding a valid number
+    count_aggregate,
+    sum_aggregate,
+    min_aggregate,
+    max_aggregate,
+    mean_aggregate
+};
+
+/// @brief Streaming hash group-by over key columns.
+///
+/// @details Groups are found through an open-addressing hash table
+/// keyed on the raw characters of the key fields; key values are copied
+/// once per group into a single buffer. Value columns are converted
+/// with convert<double>; empty and invalid fields are skipped by every
+/// aggregate function. Groups are numbered in order of first
+/// appearance, except after the multi-threaded consume().
+///
+/// Partial aggregators built over disjoint parts of the input can be
+/// combined with merge(), which is how the multi-threaded consume()
+/// works.
+template <typename Char, typename Traits = std::char_traits<Char> >
+class basic_aggregator {
+public:
+    typedef Char char_type;
+    typedef basic_field_view<Char, Traits> field_type;
+    typedef basic_row<Char, Traits> row_type;
+    typedef basic_row_batch<Char, Traits> batch_type;
+    typedef basic_batch_reader<Char, Traits> reader_type;
+
+    basic_aggregator()
+        : rows_(0) {
+        slots_.assign(16, npos());
+    }
+
+    /// @brief Adds a key column.
+    void group_by(std::size_t col) { keys_.push_back(col); }
+
+    /// @brief Adds an aggregate of column <tt>col</tt> and returns its
+    /// index for value().
+    std::size_t aggregate(aggregate_function f, std::size_t col);
+
+    void consume(const batch_type &batch);
+
+    void consume(const row_type &row);
+
+    /// @brief Consumes all remaining batches of <tt>reader</tt>.
+    void consume(reader_type &reader);
+
+#if __cplusplus >= 201103
+    /// @brief Consumes all remaining batches of <tt>reader</tt> on
+    /// <tt>threads</tt> threads, each filling its own partial table.
+    ///
+    /// @details The order in which the groups are numbered is
+    /// unspecified, and sums and means may differ from a single-threaded
+    /// run by rounding.
+    void consume(reader_type &reader, unsigned threads);
+#endif
+
+    /// @brief Adds the groups of <tt>other</tt>, which must have the same
+    /// keys and aggregates.
+    void merge(const basic_aggregator &other);
+
+    /// @brief Returns number of groups.
+    std::size_t size() const { return counts_.size(); }
+
+    /// @brief Returns key field <tt>k</tt> of group <tt>group</tt>.
+    field_type key(std::size_t group, std::size_t k) const;
+
+    /// @brief Returns number of records in group <tt>group</tt>.
+    uint64_t rows(std::size_t group) const { return counts_[group]; }
+
+    /// @brief Returns aggregate <tt>agg</tt> of group <tt>group</tt>;
+    /// NaN for min, max and mean over no values.
+    double value(std::size_t group, std::size_t agg) const;
+
+    /// @brief Returns number of records consumed.
+    uint64_t rows_consumed() const { return rows_; }
+
+    /// @brief Drops all groups, keeping keys and aggregates.
+    void clear();
+
+private:
+    struct accumulator {
+        accumulator()
+            : count(0)
+            , sum(0)
+            , min(std::numeric_limits<double>::infinity())
+            , max(-std::numeric_limits<double>::infinity()) {}
+
+        void add(double v) {
+            ++count;
+            sum += v;
+            if (v < min)
+                min = v;
+            if (v > max)
+                max = v;
+        }
+
+        void merge(const accumulator &a) {
+            count += a.count;
+            sum += a.sum;
+            if (a.min < min)
+                min = a.min;
+            if (a.max > max)
+                max = a.max;
+        }
+
+        uint64_t count;
+        double sum;
+        double min;
+        double max;
+    };
+
+    struct spec {
+        aggregate_function function;
+        std::size_t slot;
+    };
+
+    static std::size_t npos() { return static_cast<std::size_t>(-1); }
+
+    std::size_t find_or_add(const field_type *keys, uint64_t hash);
+    bool key_equals(std::size_t group, const field_type *keys) const;
+    void grow();
+    void add_record();
+
+private:
+    std::vector<std::size_t> keys_;
+    std::vector<std::size_t> columns_;
+    std::vector<spec> specs_;
+
+    std::vector<char_type> key_chars_;
+    std::vector<std::size_t> key_ends_;
+    std::vector<uint64_t> hashes_;
+    std::vector<uint64_t> counts_;
+    std::vector<accumulator> values_;
+    std::vector<std::size_t> slots_;
+    uint64_t rows_;
+
+    std::vector<field_type> key_scratch_;
+    std::vector<field_type> value_scratch_;
+};
+
+typedef basic_aggregator<char> aggregator;
+typedef basic_aggregator<wchar_t> waggregator;
+
+// Implementation
+
+template <typename Char, typename Traits>
+std::size_t basic_aggregator<Char, Traits>::aggregate(aggregate_function f,
+                                                      std::size_t col) {
+    if (!counts_.empty()) {
+        throw std::logic_error("Aggregates must be added before consuming");
+    }
+    std::size_t slot = 0;
+    while (slot < columns_.size() && columns_[slot] != col)
+        ++slot;
+    if (slot == columns_.size())
+        columns_.push_back(col);
+
+    const spec s = { f, slot };
+    specs_.push_back(s);
+    return specs_.size() - 1;
+}
+
+template <typename Char, typename Traits>
+typename basic_aggregator<Char, Traits>::field_type
+basic_aggregator<Char, Traits>::key(std::size_t group, std::size_t k) const {
+    const std::size_t i = group * keys_.size() + k;
+    const std::size_t b = i == 0 ? 0 : key_ends_[i - 1];
+    const char_type *const base = key_chars_.empty() ? 0 : &key_chars_[0];
+    return field_type(base + b, base + key_ends_[i]);
+}
+
+template <typename Char, typename Traits>
+bool basic_aggregator<Char, Traits>::key_equals(std::size_t group,
+                                                const field_type *keys) const {
+    for (std::size_t k = 0; k < keys_.size(); ++k) {
+        if (key(group, k) != keys[k])
+            return false;
+    }
+    return true;
+}
+
+template <typename Char, typename Traits>
+std::size_t basic_aggregator<Char, Traits>::find_or_add(const field_type *keys,
+                                                        uint64_t hash) {
+    const std::size_t mask = slots_.size() - 1;
+    std::size_t i = std::size_t(hash) & mask;
+    for (;; i = (i + 1) & mask) {
+        const std::size_t g = slots_[i];
+        if (g == npos())
+            break;
+        if (hashes_[g] == hash && key_equals(g, keys))
+            return g;
+    }
+
+    const std::size_t g = counts_.size();
+    for (std::size_t k = 0; k < keys_.size(); ++k) {
+        key_chars_.insert(key_chars_.end(), keys[k].begin(), keys[k].end());
+        key_ends_.push_back(key_chars_.size());
+    }
+    hashes_.push_back(hash);
+    counts_.push_back(0);
+    values_.resize(values_.size() + columns_.size());
+
+    if (2 * counts_.size() > slots_.size()) {
+        grow();
+    } else {
+        slots_[i] = g;
+    }
+    return g;
+}
+
+template <typename Char, typename Traits>
+void basic_aggregator<Char, Traits>::grow() {
+    std::vector<std::size_t>(slots_.size() * 2, npos()).swap(slots_);
+    const std::size_t mask = slots_.size() - 1;
+    for (std::size_t g = 0; g < counts_.size(); ++g) {
+        std::size_t i = std::size_t(hashes_[g]) & mask;
+        while (slots_[i] != npos())
+            i = (i + 1) & mask;
+        slots_[i] = g;
+    }
+}
+
+template <typename Char, typename Traits>
+void basic_aggregator<Char, Traits>::add_record() {
+    uint64_t h = 0;
+    for (std::size_t k = 0; k < keys_.size(); ++k) {
+        h = hash_combine(h, hash_field(key_scratch_[k].begin(),
+                                       key_scratch_[k].end()));
+    }
+    const field_type *const keys = key_scratch_.empty() ? 0 : &key_scratch_[0];
+    const std::size_t g = find_or_add(keys, h);
+    ++counts_[g];
+
+    accumulator *const acc = values_.empty() ? 0 : &values_[g * columns_.size()];
+    for (std::size_t c = 0; c < columns_.size(); ++c) {
+        const field_type &f = value_scratch_[c];
+        double v;
+        if (!f.empty() && convert<double>::parse(f.begin(), f.end(), v))
+            acc[c].add(v);
+    }
+}
+
+template <typename Char, typename Traits>
+void basic_aggregator<Char, Traits>::consume(const batch_type &batch) {
+    key_scratch_.resize(keys_.size());
+    value_scratch_.resize(columns_.size());
+    for (std::size_t r = 0, n = batch.size(); r < n; ++r) {
+        const std::size_t fields = batch.field_count(r);
+        for (std::size_t k = 0; k < keys_.size(); ++k) {
+            key_scratch_[k] =
+                keys_[k] < fields ? batch.field(r, keys_[k]) : field_type();
+        }
+        for (std::size_t c = 0; c < columns_.size(); ++c) {
+            value_scratch_[c] = columns_[c] < fields
+                                    ? batch.field(r, columns_[c])
+                                    : field_type();
+        }
+        add_record();
+    }
+    rows_ += batch.size();
+}
+
+template <typename Char, typename Traits>
+void basic_aggregator<Char, Traits>::consume(const row_type &row) {
+    key_scratch_.resize(keys_.size());
+    value_scratch_.resize(columns_.size());
+    for (std::size_t k = 0; k < keys_.size(); ++k) {
+        key_scratch_[k] =
+            keys_[k] < row.size() ? field_type(row[keys_[k]]) : field_type();
+    }
+    for (std::size_t c = 0; c < columns_.size(); ++c) {
+        value_scratch_[c] = columns_[c] < row.size()
+                                ? field_type(row[columns_[c]])
+                                : field_type();
+    }
+    add_record();
+    ++rows_;
+}
+
+template <typename Char, typename Traits>
+void basic_aggregator<Char, Traits>::consume(reader_type &reader) {
+    batch_type batch;
+    while (reader.next(batch)) {
+        consume(batch);
+    }
+}
+
+#if __cplusplus >= 201103
+
+template <typename Char, typename Traits>
+void basic_aggregator<Char, Traits>::consume(reader_type &reader,
+                                             unsigned threads) {
+    if (threads < 2) {
+        consume(reader);
+        return;
+    }
+
+    basic_aggregator empty;
+    empty.keys_ = keys_;
+    empty.columns_ = columns_;
+    empty.specs_ = specs_;
+    std::vector<basic_aggregator> partial(threads, empty);
+
+    parallel_for_each_batch(reader, threads,
+                            [&partial](unsigned id, const batch_type &b) {
+                                partial[id].consume(b);
+                            });
+
+    for (const basic_aggregator &p : partial) {
+        merge(p);
+    }
+}
+
+#endif
+
+template <typename Char, typename Traits>
+void basic_aggregator<Char, Traits>::merge(const basic_aggregator &other) {
+    if (other.keys_ != keys_ || other.columns_ != columns_) {
+        throw std::invalid_argument("Aggregators have different layouts");
+    }
+
+    std::vector<field_type> keys(keys_.size());
+    for (std::size_t g = 0; g < other.size(); ++g) {
+        for (std::size_t k = 0; k < keys_.size(); ++k) {
+            keys[k] = other.key(g, k);
+        }
+        // other's keys do not live in our buffer, so growing it is safe.
+        const std::size_t mine =
+            find_or_add(keys.empty() ? 0 : &keys[0], other.hashes_[g]);
+        counts_[mine] += other.counts_[g];
+        for (std::size_t c = 0; c < columns_.size(); ++c) {
+            values_[mine * columns_.size() + c].merge(
+                other.values_[g * columns_.size() + c]);
+        }
+    }
+    rows_ += other.rows_;
+}
+
+template <typename Char, typename Traits>
+double basic_aggregator<Char, Traits>::value(std::size_t group,
+                                             std::size_t agg) const {
+    const spec &s = specs_[agg];
+    const accumulator &a = values_[group * columns_.size() + s.slot];
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    switch (s.function) {
+    case count_aggregate:
+        return double(a.count);
+    case sum_aggregate:
+        return a.sum;
+    case min_aggregate:
+        return a.count ? a.min : nan;
+    case max_aggregate:
+        return a.count ? a.max : nan;
+    case mean_aggregate:
+        return a.count ? a.sum / double(a.count) : nan;
+    }
+    return nan;
+}
+
+template <typename Char, typename Traits>
+void basic_aggregator<Char, Traits>::clear() {
+    key_chars_.clear();
+    key_ends_.clear();
+    hashes_.clear();
+    counts_.clear();
+    values_.clear();
+    slots_.assign(16, npos());
+    rows_ = 0;
+}
+} // namespace csv
+} // namespace text
+
+#endif
@@ -0,0 +1,328 @@
+#ifndef TEXT_CSV_ASYNC_BUF_HPP
+#define TEXT_CSV_ASYNC_BUF_HPP
+
+//          Copyright Roman Kashitsyn 2014 - 2015.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// Asynchronous output. Requires C++11.
+
+#if __cplusplus >= 201103
+
+#include "sink.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <streambuf>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#if defined(TEXT_CSV_HAS_POSIX_IO)
+#include <sys/uio.h>
+#endif
+
+namespace text {
+namespace csv {
+
+/// @brief Stream buffer that writes filled buffers from a background
+/// thread.
+///
+/// @details The put area is one of buffers() buffers of buffer_size()
+/// characters each. When it fills up, it is queued for the background
+/// thread and the next free buffer takes its place, so the formatting
+/// thread only waits when every buffer is queued: memory is bounded by
+/// buffers() * buffer_size() characters.
+///
+/// Output goes either to another stream buffer (e.g. a std::filebuf)
+/// or, on POSIX systems, directly to a file descriptor with writev(),
+/// gathering all queued buffers in one call. The descriptor is not
+/// closed.
+///
+/// I/O errors are remembered and reported by the next pubsync() (and so
+/// by std::ostream::flush(), which sets badbit) and by close(), which
+/// throws std::system_error. After an error further output fails.
+template <typename Char, typename Traits = std::char_traits<Char> >
+class basic_async_buf : public std::basic_streambuf<Char, Traits> {
+public:
+    typedef Char char_type;
+    typedef Traits traits_type;
+    typedef typename Traits::int_type int_type;
+    typedef std::basic_streambuf<Char, Traits> target_type;
+
+    explicit basic_async_buf(target_type *target,
+                             std::size_t buffer_size = std::size_t(1) << 20,
+                             std::size_t buffers = 2);
+
+#if defined(TEXT_CSV_HAS_POSIX_IO)
+    explicit basic_async_buf(int fd,
+                             std::size_t buffer_size = std::size_t(1) << 20,
+                             std::size_t buffers = 2);
+#endif
+
+    basic_async_buf(const basic_async_buf &) = delete;
+    basic_async_buf &operator=(const basic_async_buf &) = delete;
+
+    /// @brief Writes pending output and stops the background thread,
+    /// ignoring errors.
+    ~basic_async_buf();
+
+    /// @brief Writes pending output and stops the background thread;
+    /// throws std::system_error if any write failed.
+    void close();
+
+    /// @brief Returns the first I/O error, if any.
+    std::error_code error() const;
+
+    std::size_t buffer_size() const { return buffer_size_; }
+
+    std::size_t buffers() const { return storage_.size(); }
+
+protected:
+    int_type overflow(int_type c) override;
+
+    int sync() override;
+
+private:
+    void start(std::size_t buffers);
+
+    /// Queues the put area and installs the next free buffer.
+    bool submit();
+
+    /// Waits until the background thread has written everything queued.
+    void drain(std::unique_lock<std::mutex> &lock);
+
+    void run();
+
+    void write_out(const std::vector<std::size_t> &batch);
+
+private:
+    target_type *target_;
+    int fd_;
+    std::size_t buffer_size_;
+
+    std::vector<std::vector<Char> > storage_;
+    std::vector<std::size_t> sizes_;
+    std::size_t current_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::size_t> full_;
+    std::vector<std::size_t> free_;
+    bool busy_;
+    bool stop_;
+    std::error_code error_;
+    std::thread thread_;
+};
+
+typedef basic_async_buf<char> async_buf;
+typedef basic_async_buf<wchar_t> wasync_buf;
+
+// Implementation
+
+template <typename Char, typename Traits>
+basic_async_buf<Char, Traits>::basic_async_buf(target_type *target,
+                                               std::size_t buffer_size,
+                                               std::size_t buffers)
+    : target_(target)
+    , fd_(-1)
+    , buffer_size_(buffer_size ? buffer_size : 1) {
+    start(buffers);
+}
+
+#if defined(TEXT_CSV_HAS_POSIX_IO)
+
+template <typename Char, typename Traits>
+basic_async_buf<Char, Traits>::basic_async_buf(int fd, std::size_t buffer_size,
+                                               std::size_t buffers)
+    : target_(0)
+    , fd_(fd)
+    , buffer_size_(buffer_size ? buffer_size : 1) {
+    start(buffers);
+}
+
+#endif
+
+template <typename Char, typename Traits>
+void basic_async_buf<Char, Traits>::start(std::size_t buffers) {
+    if (buffers < 2)
+        buffers = 2;
+    storage_.resize(buffers);
+    sizes_.resize(buffers, 0);
+    for (std::size_t i = 0; i < buffers; ++i) {
+        storage_[i].resize(buffer_size_);
+        if (i > 0)
+            free_.push_back(i);
+    }
+    current_ = 0;
+    busy_ = false;
+    stop_ = false;
+    this->setp(&storage_[0][0], &storage_[0][0] + buffer_size_);
+    thread_ = std::thread(&basic_async_buf::run, this);
+}
+
+template <typename Char, typename Traits>
+basic_async_buf<Char, Traits>::~basic_async_buf() {
+    try {
+        close();
+    } catch (...) {
+    }
+}
+
+template <typename Char, typename Traits>
+bool basic_async_buf<Char, Traits>::submit() {
+    const std::size_t n = std::size_t(this->pptr() - this->pbase());
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (n > 0) {
+        sizes_[current_] = n;
+        full_.push_back(current_);
+        cv_.notify_all();
+        cv_.wait(lock, [this] { return !free_.empty(); });
+        current_ = free_.back();
+        free_.pop_back();
+    }
+    Char *const p = &storage_[current_][0];
+    this->setp(p, p + buffer_size_);
+    return !error_;
+}
+
+template <typename Char, typename Traits>
+typename basic_async_buf<Char, Traits>::int_type
+basic_async_buf<Char, Traits>::overflow(int_type c) {
+    if (!thread_.joinable() || !submit())
+        return traits_type::eof();
+    if (!traits_type::eq_int_type(c, traits_type::eof())) {
+        *this->pptr() = traits_type::to_char_type(c);
+        this->pbump(1);
+    }
+    return traits_type::not_eof(c);
+}
+
+template <typename Char, typename Traits>
+void basic_async_buf<Char, Traits>::drain(std::unique_lock<std::mutex> &lock) {
+    cv_.wait(lock, [this] { return full_.empty() && !busy_; });
+}
+
+template <typename Char, typename Traits>
+int basic_async_buf<Char, Traits>::sync() {
+    if (!thread_.joinable())
+        return error_ ? -1 : 0;
+    submit();
+    std::unique_lock<std::mutex> lock(mutex_);
+    drain(lock);
+    // The background thread is idle, so the target can be used here.
+    if (target_ && !error_ && target_->pubsync() != 0) {
+        error_ = std::make_error_code(std::io_errc::stream);
+    }
+    return error_ ? -1 : 0;
+}
+
+template <typename Char, typename Traits>
+void basic_async_buf<Char, Traits>::close() {
+    if (thread_.joinable()) {
+        sync();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        thread_.join();
+        this->setp(0, 0);
+    }
+    if (error_) {
+        throw std::system_error(error_, "Cannot write CSV output");
+    }
+}
+
+template <typename Char, typename Traits>
+std::error_code basic_async_buf<Char, Traits>::error() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return error_;
+}
+
+template <typename Char, typename Traits>
+void basic_async_buf<Char, Traits>::run() {
+    std::vector<std::size_t> batch;
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        cv_.wait(lock, [this] { return !full_.empty() || stop_; });
+        if (full_.empty())
+            return;
+        batch.assign(full_.begin(), full_.end());
+        full_.clear();
+        busy_ = true;
+
+        lock.unlock();
+        write_out(batch);
+        lock.lock();
+
+        busy_ = false;
+        free_.insert(free_.end(), batch.begin(), batch.end());
+        cv_.notify_all();
+    }
+}
+
+template <typename Char, typename Traits>
+void basic_async_buf<Char, Traits>::write_out(
+    const std::vector<std::size_t> &batch) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (error_)
+            return;
+    }
+    std::error_code ec;
+
+    if (target_) {
+        for (std::size_t i = 0; i < batch.size() && !ec; ++i) {
+            const std::streamsize n = std::streamsize(sizes_[batch[i]]);
+            if (target_->sputn(&storage_[batch[i]][0], n) != n)
+                ec = std::make_error_code(std::io_errc::stream);
+        }
+    }
+#if defined(TEXT_CSV_HAS_POSIX_IO)
+    else {
+        std::vector<iovec> iov(batch.size());
+        for (std::size_t i = 0; i < batch.size(); ++i) {
+            iov[i].iov_base = &storage_[batch[i]][0];
+            iov[i].iov_len = sizes_[batch[i]] * sizeof(Char);
+        }
+        std::size_t first = 0;
+        while (first < iov.size()) {
+            const int count = int(std::min<std::size_t>(iov.size() - first,
+                                                        IOV_MAX));
+            const ssize_t n = ::writev(fd_, &iov[first], count);
+            if (n < 0) {
+                if (errno == EINTR)
+                    continue;
+                ec = std::error_code(errno, std::system_category());
+                break;
+            }
+            // Skip what was written, possibly ending mid-buffer.
+            std::size_t done = std::size_t(n);
+            while (first < iov.size() && done >= iov[first].iov_len) {
+                done -= iov[first].iov_len;
+                ++first;
+            }
+            if (done > 0) {
+                char *const base = static_cast<char *>(iov[first].iov_base);
+                iov[first].iov_base = base + done;
+                iov[first].iov_len -= done;
+            }
+        }
+    }
+#endif
+
+    if (ec) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        error_ = ec;
+    }
+}
+} // namespace csv
+} // namespace text
+
+#endif
+
+#endif
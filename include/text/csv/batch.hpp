@@ -0,0 +1,338 @@
+#ifndef TEXT_CSV_BATCH_HPP
+#define TEXT_CSV_BATCH_HPP
+
+//          Copyright Roman Kashitsyn 2014 - 2015.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "dictionary.hpp"
+#include "field.hpp"
+#include "rows.hpp"
+
+#include <istream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace text {
+namespace csv {
+
+template <typename Char, typename Traits = std::char_traits<Char> >
+class basic_batch_reader;
+
+/// @brief A block of consecutive records stored in a single buffer.
+///
+/// @details All fields of the batch live back to back in one character
+/// array, so reading a batch performs no per-field allocations once the
+/// buffers have grown to their working size. Columns the reader was
+/// asked to dictionary-encode are not copied into the batch at all;
+/// only their codes are stored.
+///
+/// Views returned by field() are valid until the batch is refilled.
+template <typename Char, typename Traits = std::char_traits<Char> >
+class basic_row_batch {
+public:
+    typedef Char char_type;
+    typedef Traits traits_type;
+    typedef basic_field_view<Char, Traits> field_type;
+    typedef basic_dictionary<Char, Traits> dictionary_type;
+    typedef typename dictionary_type::code_type code_type;
+    typedef basic_row<Char, Traits> row_type;
+
+    basic_row_batch()
+        : first_row_(0)
+        , encoded_count_(0) {
+        fields_.push_back(0);
+    }
+
+    /// @brief Returns number of records in the batch.
+    std::size_t size() const { return rows_.size(); }
+
+    bool empty() const { return rows_.empty(); }
+
+    /// @brief Returns zero-based number of the first record of the batch
+    /// in the input.
+    std::size_t first_row() const { return first_row_; }
+
+    /// @brief Returns number of fields of record <tt>row</tt>.
+    std::size_t field_count(std::size_t row) const {
+        return row_end(row) - rows_[row];
+    }
+
+    /// @brief Returns field <tt>col</tt> of record <tt>row</tt>.
+    /// @pre col < field_count(row)
+    field_type field(std::size_t row, std::size_t col) const;
+
+    /// @brief Checks whether column <tt>col</tt> is dictionary-encoded.
+    bool is_encoded(std::size_t col) const {
+        return col < slots_.size() && slots_[col] != npos_slot();
+    }
+
+    /// @brief Returns dictionary code of field <tt>col</tt> of record
+    /// <tt>row</tt>, or dictionary_type::npos if the record is too short.
+    /// @pre is_encoded(col)
+    code_type code(std::size_t row, std::size_t col) const {
+        return codes_[row * encoded_count_ + slots_[col]];
+    }
+
+    /// @brief Converts field <tt>col</tt> of record <tt>row</tt>.
+    template <typename T>
+    T as(std::size_t row, std::size_t col) const {
+        return field(row, col).template as<T>();
+    }
+
+    /// @brief Returns approximate number of bytes held by the batch.
+    std::size_t memory_size() const {
+        return chars_.size() * sizeof(char_type) +
+               (fields_.size() + rows_.size()) * sizeof(std::size_t) +
+               codes_.size() * sizeof(code_type);
+    }
+
+    /// @brief Copies record <tt>row</tt> into <tt>dest</tt>.
+    void copy_row(std::size_t row, row_type &dest) const;
+
+    void clear();
+
+private:
+    friend class basic_batch_reader<Char, Traits>;
+
+    static std::size_t npos_slot() { return static_cast<std::size_t>(-1); }
+
+    std::size_t row_end(std::size_t row) const {
+        return row + 1 < rows_.size() ? rows_[row + 1] : fields_.size() - 1;
+    }
+
+    void begin_row() {
+        rows_.push_back(fields_.size() - 1);
+        codes_.resize(codes_.size() + encoded_count_, dictionary_type::npos);
+    }
+
+    std::size_t current_column() const {
+        return fields_.size() - 1 - rows_.back();
+    }
+
+    void push_field(const char_type *begin, const char_type *end) {
+        chars_.insert(chars_.end(), begin, end);
+        fields_.push_back(chars_.size());
+    }
+
+    void push_code(std::size_t col, code_type c) {
+        codes_[(rows_.size() - 1) * encoded_count_ + slots_[col]] = c;
+        fields_.push_back(chars_.size());
+    }
+
+private:
+    std::vector<char_type> chars_;
+    std::vector<std::size_t> fields_;
+    std::vector<std::size_t> rows_;
+    std::vector<code_type> codes_;
+    std::vector<std::size_t> slots_;
+    std::vector<const dictionary_type *> dictionaries_;
+    std::size_t first_row_;
+    std::size_t encoded_count_;
+};
+
+/// @brief Reads CSV records in batches of a fixed number of rows.
+///
+/// @details Columns selected with encode_column() are dictionary
+/// encoded while parsing: each field is hashed, interned once into a
+/// per-column dictionary owned by the reader, and only its 32-bit code
+/// is stored in the batch. Batches decode these codes through the
+/// reader's dictionaries, so they must not outlive the reader.
+template <typename Char, typename Traits>
+class basic_batch_reader {
+public:
+    typedef Char char_type;
+    typedef Traits traits_type;
+    typedef std::basic_istream<Char, Traits> stream_type;
+    typedef basic_csv_istream<Char, Traits> csv_stream_type;
+    typedef std::basic_string<Char, Traits> string_type;
+    typedef basic_row_batch<Char, Traits> batch_type;
+    typedef basic_header<Char, Traits> header_type;
+    typedef basic_dictionary<Char, Traits> dictionary_type;
+
+    static const std::size_t default_batch_size = 4096;
+
+    basic_batch_reader(stream_type &in)
+        : is_(in)
+        , batch_size_(default_batch_size)
+        , rows_read_(0)
+        , started_(false) {}
+
+    basic_batch_reader(stream_type &in, char_type delimiter)
+        : is_(in, delimiter)
+        , batch_size_(default_batch_size)
+        , rows_read_(0)
+        , started_(false) {}
+
+    basic_batch_reader(stream_type &in, char_type delimiter, char_type quote)
+        : is_(in, delimiter, quote)
+        , batch_size_(default_batch_size)
+        , rows_read_(0)
+        , started_(false) {}
+
+    /// @brief Consumes the next record as the header.
+    const header_type &read_header();
+
+    const header_type &header() const { return header_; }
+
+    std::size_t batch_size() const { return batch_size_; }
+
+    void batch_size(std::size_t n) { batch_size_ = n ? n : 1; }
+
+    /// @brief Dictionary-encodes column <tt>col</tt>.
+    ///
+    /// @details Throws std::logic_error once next() has been called,
+    /// since batches already read refer to the current dictionaries.
+    void encode_column(std::size_t col);
+
+    /// @brief Dictionary-encodes the column named <tt>name</tt>.
+    /// @pre read_header() has been called.
+    void encode_column(const string_type &name);
+
+    bool is_encoded(std::size_t col) const {
+        return col < slots_.size() && slots_[col] != batch_type::npos_slot();
+    }
+
+    /// @brief Returns the dictionary of encoded column <tt>col</tt>.
+    const dictionary_type &dictionary(std::size_t col) const {
+        return dictionaries_[slots_[col]];
+    }
+
+    /// @brief Moves the dictionary of encoded column <tt>col</tt> into
+    /// <tt>dest</tt>. Codes read afterwards start again from zero.
+    /// Batches read earlier can no longer decode that column.
+    void release_dictionary(std::size_t col, dictionary_type &dest) {
+        dest.swap(dictionaries_[slots_[col]]);
+        dictionaries_[slots_[col]].clear();
+    }
+
+    /// @brief Returns number of records read so far.
+    std::size_t rows_read() const { return rows_read_; }
+
+    /// @brief Fills <tt>batch</tt> with up to batch_size() records.
+    /// @return false if there were no more records.
+    bool next(batch_type &batch);
+
+    csv_stream_type &stream() { return is_; }
+
+private:
+    basic_batch_reader(basic_batch_reader const &);
+    basic_batch_reader &operator=(basic_batch_reader const &);
+
+private:
+    csv_stream_type is_;
+    header_type header_;
+    string_type field_;
+    std::size_t batch_size_;
+    std::size_t rows_read_;
+    bool started_;
+    std::vector<std::size_t> slots_;
+    std::vector<dictionary_type> dictionaries_;
+};
+
+typedef basic_row_batch<char> row_batch;
+typedef basic_row_batch<wchar_t> wrow_batch;
+typedef basic_batch_reader<char> batch_reader;
+typedef basic_batch_reader<wchar_t> wbatch_reader;
+
+// Implementation
+
+template <typename Char, typename Traits>
+typename basic_row_batch<Char, Traits>::field_type
+basic_row_batch<Char, Traits>::field(std::size_t row, std::size_t col) const {
+    if (is_encoded(col)) {
+        const code_type c = code(row, col);
+        return c == dictionary_type::npos ? field_type()
+                                          : dictionaries_[col]->value(c);
+    }
+    const std::size_t i = rows_[row] + col;
+    const char_type *const base = chars_.empty() ? 0 : &chars_[0];
+    return field_type(base + fields_[i], base + fields_[i + 1]);
+}
+
+template <typename Char, typename Traits>
+void basic_row_batch<Char, Traits>::copy_row(std::size_t row,
+                                             row_type &dest) const {
+    const std::size_t n = field_count(row);
+    dest.resize(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        const field_type f = field(row, i);
+        dest[i].assign(f.begin(), f.end());
+    }
+}
+
+template <typename Char, typename Traits>
+void basic_row_batch<Char, Traits>::clear() {
+    chars_.clear();
+    fields_.resize(1);
+    rows_.clear();
+    codes_.clear();
+}
+
+template <typename Char, typename Traits>
+const typename basic_batch_reader<Char, Traits>::header_type &
+basic_batch_reader<Char, Traits>::read_header() {
+    header_ = header_type(is_);
+    return header_;
+}
+
+template <typename Char, typename Traits>
+void basic_batch_reader<Char, Traits>::encode_column(std::size_t col) {
+    if (is_encoded(col))
+        return;
+    if (started_) {
+        throw std::logic_error("Cannot encode a column after reading");
+    }
+    if (slots_.size() <= col) {
+        slots_.resize(col + 1, batch_type::npos_slot());
+    }
+    slots_[col] = dictionaries_.size();
+    dictionaries_.push_back(dictionary_type());
+}
+
+template <typename Char, typename Traits>
+void basic_batch_reader<Char, Traits>::encode_column(const string_type &name) {
+    const std::size_t col = header_.index_of(name);
+    if (col == header_type::npos) {
+        throw std::out_of_range("Unknown column");
+    }
+    encode_column(col);
+}
+
+template <typename Char, typename Traits>
+bool basic_batch_reader<Char, Traits>::next(batch_type &batch) {
+    started_ = true;
+    batch.clear();
+    batch.first_row_ = rows_read_;
+    batch.slots_ = slots_;
+    batch.encoded_count_ = dictionaries_.size();
+    batch.dictionaries_.assign(slots_.size(), 0);
+    for (std::size_t i = 0; i < slots_.size(); ++i) {
+        if (is_encoded(i))
+            batch.dictionaries_[i] = &dictionaries_[slots_[i]];
+    }
+
+    while (batch.size() < batch_size_ && is_) {
+        batch.begin_row();
+        while (is_.good() && is_.has_more_fields()) {
+            is_ >> field_;
+            const char_type *const b = field_.data();
+            const char_type *const e = b + field_.size();
+            const std::size_t col = batch.current_column();
+            if (is_encoded(col)) {
+                batch.push_code(col, dictionaries_[slots_[col]].intern(b, e));
+            } else {
+                batch.push_field(b, e);
+            }
+        }
+        is_.has_more_fields(true);
+        ++rows_read_;
+    }
+    return !batch.empty();
+}
+} // namespace csv
+} // namespace text
+
+#endif
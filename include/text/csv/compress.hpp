@@ -0,0 +1,412 @@
+#ifndef TEXT_CSV_COMPRESS_HPP
+#define TEXT_CSV_COMPRESS_HPP
+
+//          Copyright Roman Kashitsyn 2014 - 2015.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// Compressed output. Requires C++11 and zlib; zstd support is enabled by
+// defining TEXT_CSV_WITH_ZSTD and linking libzstd.
+
+#if __cplusplus >= 201103
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <zlib.h>
+
+#if defined(TEXT_CSV_WITH_ZSTD)
+#include <zstd.h>
+#endif
+
+namespace text {
+namespace csv {
+
+enum compression {
+    gzip_compression, ///< Concatenated gzip members (RFC 1952).
+    zstd_compression  ///< Concatenated zstd frames.
+};
+
+namespace detail {
+
+/// Compresses blocks into independent gzip members or zstd frames,
+/// reusing its compression state between blocks.
+class block_compressor {
+public:
+    block_compressor(compression method, int level);
+    ~block_compressor();
+
+    /// Replaces <tt>out</tt> with the compressed <tt>n</tt> bytes at
+    /// <tt>data</tt>; returns false on failure.
+    bool compress(const void *data, std::size_t n, std::vector<char> &out);
+
+    block_compressor(const block_compressor &) = delete;
+    block_compressor &operator=(const block_compressor &) = delete;
+
+private:
+    compression method_;
+    int level_;
+    z_stream z_;
+    bool z_ready_;
+#if defined(TEXT_CSV_WITH_ZSTD)
+    ZSTD_CCtx *cctx_;
+#endif
+};
+
+inline block_compressor::block_compressor(compression method, int level)
+    : method_(method)
+    , level_(level)
+    , z_ready_(false) {
+    if (method == gzip_compression) {
+        z_ = z_stream();
+        // Window bits above 15 select the gzip wrapper.
+        const int z_level = level < 0 ? Z_DEFAULT_COMPRESSION : level;
+        z_ready_ = deflateInit2(&z_, z_level, Z_DEFLATED, 15 + 16, 8,
+                                Z_DEFAULT_STRATEGY) == Z_OK;
+    }
+#if defined(TEXT_CSV_WITH_ZSTD)
+    cctx_ = method == zstd_compression ? ZSTD_createCCtx() : 0;
+#endif
+}
+
+inline block_compressor::~block_compressor() {
+    if (z_ready_)
+        deflateEnd(&z_);
+#if defined(TEXT_CSV_WITH_ZSTD)
+    if (cctx_)
+        ZSTD_freeCCtx(cctx_);
+#endif
+}
+
+inline bool block_compressor::compress(const void *data, std::size_t n,
+                                       std::vector<char> &out) {
+    if (method_ == gzip_compression) {
+        if (!z_ready_ || deflateReset(&z_) != Z_OK)
+            return false;
+        out.resize(deflateBound(&z_, uLong(n)));
+        z_.next_in = static_cast<Bytef *>(const_cast<void *>(data));
+        z_.avail_in = uInt(n);
+        z_.next_out = reinterpret_cast<Bytef *>(&out[0]);
+        z_.avail_out = uInt(out.size());
+        if (deflate(&z_, Z_FINISH) != Z_STREAM_END)
+            return false;
+        out.resize(z_.total_out);
+        return true;
+    }
+#if defined(TEXT_CSV_WITH_ZSTD)
+    if (method_ == zstd_compression && cctx_) {
+        out.resize(ZSTD_compressBound(n));
+        const std::size_t size =
+            ZSTD_compressCCtx(cctx_, &out[0], out.size(), data, n,
+                              level_ < 0 ? ZSTD_CLEVEL_DEFAULT : level_);
+        if (ZSTD_isError(size))
+            return false;
+        out.resize(size);
+        return true;
+    }
+#endif
+    (void)level_;
+    return false;
+}
+} // namespace detail
+
+/// @brief Stream buffer compressing its output in independent blocks on
+/// a pool of worker threads.
+///
+/// @details Output is cut into blocks of about block_size() characters,
+/// each compressed into a separate gzip member or zstd frame and written
+/// to the target in order. Standard decompressors read the concatenation
+/// as one stream, and every block can also be decompressed on its own.
+///
+/// A block is closed before a write that would not fit in it, so when
+/// the buffer is fed by a basic_csv_ostream whose buffer_size() is
+/// non-zero, blocks hold whole records. At most twice threads() blocks
+/// are in memory; the formatting thread waits when all of them are busy.
+///
+/// The compression level is passed to the library; a negative level
+/// selects its default. Errors are reported by pubsync() and by close(),
+/// which throws std::runtime_error.
+template <typename Char, typename Traits = std::char_traits<Char> >
+class basic_compress_buf : public std::basic_streambuf<Char, Traits> {
+public:
+    typedef Char char_type;
+    typedef Traits traits_type;
+    typedef typename Traits::int_type int_type;
+
+    explicit basic_compress_buf(std::streambuf *target,
+                                compression method = gzip_compression,
+                                int level = -1, unsigned threads = 0,
+                                std::size_t block_size = 1 << 17);
+
+    basic_compress_buf(const basic_compress_buf &) = delete;
+    basic_compress_buf &operator=(const basic_compress_buf &) = delete;
+
+    /// @brief Writes pending output and stops the workers, ignoring
+    /// errors.
+    ~basic_compress_buf();
+
+    /// @brief Compresses and writes pending output and stops the workers;
+    /// throws std::runtime_error if compression or a write failed.
+    void close();
+
+    compression method() const { return method_; }
+
+    unsigned threads() const { return unsigned(workers_.size()); }
+
+    std::size_t block_size() const { return block_size_; }
+
+protected:
+    int_type overflow(int_type c) override;
+
+    std::streamsize xsputn(const Char *s, std::streamsize n) override;
+
+    int sync() override;
+
+private:
+    struct job {
+        std::vector<Char> input;
+        std::size_t size;
+        std::vector<char> output;
+        bool done;
+    };
+
+    /// Queues the put area for compression and installs a free block;
+    /// empty blocks are only queued when <tt>force</tt> is set.
+    bool submit(bool force);
+
+    void run();
+
+    void set_error(const char *what);
+
+private:
+    std::streambuf *target_;
+    const compression method_;
+    const int level_;
+    const std::size_t block_size_;
+
+    std::vector<job> jobs_;
+    job *current_;
+    bool written_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<job *> queue_;
+    std::deque<job *> order_;
+    std::vector<job *> free_;
+    bool writing_;
+    bool stop_;
+    std::string error_;
+    std::vector<std::thread> workers_;
+};
+
+typedef basic_compress_buf<char> compress_buf;
+typedef basic_compress_buf<wchar_t> wcompress_buf;
+
+// Implementation
+
+template <typename Char, typename Traits>
+basic_compress_buf<Char, Traits>::basic_compress_buf(std::streambuf *target,
+                                                     compression method,
+                                                     int level,
+                                                     unsigned threads,
+                                                     std::size_t block_size)
+    : target_(target)
+    , method_(method)
+    , level_(level)
+    , block_size_(block_size ? block_size : 1)
+    , written_(false)
+    , writing_(false)
+    , stop_(false) {
+#if !defined(TEXT_CSV_WITH_ZSTD)
+    if (method == zstd_compression) {
+        throw std::runtime_error("zstd compression is not enabled");
+    }
+#endif
+    if (threads == 0)
+        threads = std::thread::hardware_concurrency();
+    if (threads == 0)
+        threads = 1;
+
+    jobs_.resize(2 * threads);
+    for (job &j : jobs_) {
+        j.input.resize(block_size_);
+        j.size = 0;
+        j.done = false;
+        free_.push_back(&j);
+    }
+    current_ = free_.back();
+    free_.pop_back();
+    this->setp(&current_->input[0], &current_->input[0] + block_size_);
+
+    for (unsigned i = 0; i < threads; ++i)
+        workers_.emplace_back(&basic_compress_buf::run, this);
+}
+
+template <typename Char, typename Traits>
+basic_compress_buf<Char, Traits>::~basic_compress_buf() {
+    try {
+        close();
+    } catch (...) {
+    }
+}
+
+template <typename Char, typename Traits>
+bool basic_compress_buf<Char, Traits>::submit(bool force) {
+    const std::size_t n = std::size_t(this->pptr() - this->pbase());
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (n > 0 || force) {
+        current_->size = n;
+        current_->done = false;
+        queue_.push_back(current_);
+        order_.push_back(current_);
+        written_ = true;
+        cv_.notify_all();
+        cv_.wait(lock, [this] { return !free_.empty(); });
+        current_ = free_.back();
+        free_.pop_back();
+    }
+    Char *const p = &current_->input[0];
+    this->setp(p, p + block_size_);
+    return error_.empty();
+}
+
+template <typename Char, typename Traits>
+typename basic_compress_buf<Char, Traits>::int_type
+basic_compress_buf<Char, Traits>::overflow(int_type c) {
+    if (workers_.empty() || !submit(false))
+        return traits_type::eof();
+    if (!traits_type::eq_int_type(c, traits_type::eof())) {
+        *this->pptr() = traits_type::to_char_type(c);
+        this->pbump(1);
+    }
+    return traits_type::not_eof(c);
+}
+
+template <typename Char, typename Traits>
+std::streamsize basic_compress_buf<Char, Traits>::xsputn(const Char *s,
+                                                         std::streamsize n) {
+    if (workers_.empty())
+        return 0;
+    std::streamsize done = 0;
+    // Start a new block rather than split a write that would fit in one.
+    if (n > this->epptr() - this->pptr() && this->pptr() != this->pbase() &&
+        std::size_t(n) <= block_size_ && !submit(false)) {
+        return 0;
+    }
+    while (done < n) {
+        std::streamsize room = this->epptr() - this->pptr();
+        if (room == 0) {
+            if (!submit(false))
+                break;
+            room = this->epptr() - this->pptr();
+        }
+        const std::streamsize chunk = std::min(room, n - done);
+        traits_type::copy(this->pptr(), s + done, std::size_t(chunk));
+        this->pbump(int(chunk));
+        done += chunk;
+    }
+    return done;
+}
+
+template <typename Char, typename Traits>
+int basic_compress_buf<Char, Traits>::sync() {
+    if (!workers_.empty()) {
+        submit(false);
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return order_.empty() && !writing_; });
+        lock.unlock();
+        if (target_->pubsync() != 0)
+            set_error("Cannot write CSV output");
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    return error_.empty() ? 0 : -1;
+}
+
+template <typename Char, typename Traits>
+void basic_compress_buf<Char, Traits>::close() {
+    if (!workers_.empty()) {
+        // An empty stream still needs one member to be valid.
+        if (!written_)
+            submit(true);
+        sync();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        for (std::thread &t : workers_)
+            t.join();
+        workers_.clear();
+        this->setp(0, 0);
+    }
+    if (!error_.empty()) {
+        throw std::runtime_error(error_);
+    }
+}
+
+template <typename Char, typename Traits>
+void basic_compress_buf<Char, Traits>::set_error(const char *what) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (error_.empty())
+        error_ = what;
+}
+
+template <typename Char, typename Traits>
+void basic_compress_buf<Char, Traits>::run() {
+    detail::block_compressor compressor(method_, level_);
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        cv_.wait(lock, [this] { return !queue_.empty() || stop_; });
+        if (queue_.empty())
+            return;
+        job *const j = queue_.front();
+        queue_.pop_front();
+
+        lock.unlock();
+        const bool ok = compressor.compress(
+            j->input.data(), j->size * sizeof(Char), j->output);
+        lock.lock();
+
+        if (!ok && error_.empty())
+            error_ = "Cannot compress CSV output";
+        j->done = true;
+        if (writing_)
+            continue;
+
+        // Blocks are written in order by whichever worker completes the
+        // next one in line.
+        writing_ = true;
+        while (!order_.empty() && order_.front()->done) {
+            job *const ready = order_.front();
+            order_.pop_front();
+            const bool failed = !error_.empty();
+
+            lock.unlock();
+            const std::streamsize n = std::streamsize(ready->output.size());
+            const bool written =
+                failed || target_->sputn(ready->output.data(), n) == n;
+            lock.lock();
+
+            if (!written && error_.empty())
+                error_ = "Cannot write CSV output";
+            free_.push_back(ready);
+            cv_.notify_all();
+        }
+        writing_ = false;
+        cv_.notify_all();
+    }
+}
+} // namespace csv
+} // namespace text
+
+#endif
+
+#endif
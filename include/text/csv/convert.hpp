@@ -0,0 +1,339 @@
+#ifndef TEXT_CSV_CONVERT_HPP
+#define TEXT_CSV_CONVERT_HPP
+
+//          Copyright Roman Kashitsyn 2014 - 2015.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <limits>
+#include <locale>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#if __cplusplus >= 201703L && defined(__has_include)
+#if __has_include(<charconv>)
+#include <charconv>
+#endif
+#endif
+
+// Field conversion layer
+// ======================
+//
+// Every typed read in the library (basic_row::as, basic_map_row::as,
+// basic_csv_istream::operator>>, input_column_iterator) goes through
+// the convert<T> trait. The built-in specializations work directly on
+// the field characters and assume that digits, signs, decimal points
+// and letters of "true"/"false" are encoded as in ASCII, which holds
+// for char and wchar_t. No locale is consulted.
+//
+// Users can plug in their own types:
+//
+//     template <>
+//     struct convert<money> {
+//         template <typename Char>
+//         static bool parse(const Char *begin, const Char *end, money &dest);
+//     };
+//
+// parse() must return false if [begin, end) is not a valid value.
+
+namespace text {
+namespace csv {
+
+/// @brief Converts raw field characters into values of type <tt>T</tt>.
+///
+/// @details The primary template falls back to stream extraction and
+/// requires the whole field to be consumed.
+template <typename T>
+struct convert {
+    template <typename Char>
+    static bool parse(const Char *begin, const Char *end, T &dest) {
+        std::basic_istringstream<Char> is(std::basic_string<Char>(begin, end));
+        is >> dest;
+        return !is.fail() && is.peek() == std::char_traits<Char>::eof();
+    }
+};
+
+namespace detail {
+
+template <typename Char>
+bool is_blank(Char c) {
+    return c == Char(' ') || c == Char('\t');
+}
+
+template <typename Char>
+void trim_blanks(const Char *&begin, const Char *&end) {
+    while (begin != end && is_blank(*begin))
+        ++begin;
+    while (begin != end && is_blank(*(end - 1)))
+        --end;
+}
+
+template <typename Char>
+bool to_digit(Char c, unsigned &digit) {
+    if (c < Char('0') || c > Char('9'))
+        return false;
+    digit = static_cast<unsigned>(c - Char('0'));
+    return true;
+}
+
+template <typename T>
+struct unsigned_convert {
+    template <typename Char>
+    static bool parse(const Char *begin, const Char *end, T &dest) {
+        trim_blanks(begin, end);
+        if (begin != end && *begin == Char('+'))
+            ++begin;
+        if (begin == end)
+            return false;
+
+        const T max = std::numeric_limits<T>::max();
+        T value = 0;
+        for (; begin != end; ++begin) {
+            unsigned d;
+            if (!to_digit(*begin, d))
+                return false;
+            if (value > (max - d) / 10)
+                return false;
+            value = static_cast<T>(value * 10 + d);
+        }
+        dest = value;
+        return true;
+    }
+};
+
+template <typename T>
+struct signed_convert {
+    template <typename Char>
+    static bool parse(const Char *begin, const Char *end, T &dest) {
+        trim_blanks(begin, end);
+        bool negative = false;
+        if (begin != end && (*begin == Char('-') || *begin == Char('+'))) {
+            negative = *begin == Char('-');
+            ++begin;
+        }
+        if (begin == end)
+            return false;
+
+        // Accumulate negatively: |min| is representable, |max| + 1 is not.
+        const T min = std::numeric_limits<T>::min();
+        T value = 0;
+        for (; begin != end; ++begin) {
+            unsigned d;
+            if (!to_digit(*begin, d))
+                return false;
+            if (value < (min + static_cast<T>(d)) / 10)
+                return false;
+            value = static_cast<T>(value * 10 - static_cast<T>(d));
+        }
+        if (!negative) {
+            if (value == min)
+                return false;
+            value = static_cast<T>(-value);
+        }
+        dest = value;
+        return true;
+    }
+};
+
+template <typename Char>
+bool equals_ignore_case(const Char *begin, const Char *end, const char *word) {
+    for (; begin != end; ++begin, ++word) {
+        if (*word == '\0')
+            return false;
+        Char c = *begin;
+        if (c >= Char('A') && c <= Char('Z'))
+            c = static_cast<Char>(c - Char('A') + Char('a'));
+        if (c != Char(*word))
+            return false;
+    }
+    return *word == '\0';
+}
+
+/// Checks that [begin, end) has the syntax from_chars accepts for a
+/// finite number: an optional minus, digits with an optional point and
+/// an optional exponent. Hexadecimal input is rejected.
+inline bool is_decimal_number(const char *begin, const char *end) {
+    if (begin != end && *begin == '-')
+        ++begin;
+    std::size_t digits = 0;
+    unsigned d;
+    for (; begin != end && to_digit(*begin, d); ++begin)
+        ++digits;
+    if (begin != end && *begin == '.') {
+        for (++begin; begin != end && to_digit(*begin, d); ++begin)
+            ++digits;
+    }
+    if (digits == 0)
+        return false;
+    if (begin != end && (*begin == 'e' || *begin == 'E')) {
+        ++begin;
+        if (begin != end && (*begin == '-' || *begin == '+'))
+            ++begin;
+        if (begin == end || !to_digit(*begin, d))
+            return false;
+        while (begin != end && to_digit(*begin, d))
+            ++begin;
+    }
+    return begin == end;
+}
+
+template <typename T>
+bool parse_special_floating(const char *begin, const char *end, T &dest) {
+    const bool negative = begin != end && *begin == '-';
+    if (negative)
+        ++begin;
+    T value;
+    if (equals_ignore_case(begin, end, "inf") ||
+        equals_ignore_case(begin, end, "infinity"))
+        value = std::numeric_limits<T>::infinity();
+    else if (equals_ignore_case(begin, end, "nan"))
+        value = std::numeric_limits<T>::quiet_NaN();
+    else
+        return false;
+    dest = negative ? -value : value;
+    return true;
+}
+
+/// Parses [begin, end) as from_chars would, for standard libraries
+/// without it.
+template <typename T>
+bool parse_classic_floating(const char *begin, const char *end, T &dest) {
+    if (parse_special_floating(begin, end, dest))
+        return true;
+    if (!is_decimal_number(begin, end))
+        return false;
+    // The classic locale fixes the decimal point to '.'; extraction
+    // fails on overflow instead of returning HUGE_VAL.
+    std::istringstream is(std::string(begin, end));
+    is.imbue(std::locale::classic());
+    T value;
+    is >> value;
+    if (is.fail())
+        return false;
+    dest = value;
+    return true;
+}
+
+template <typename T>
+bool parse_narrow_floating(const char *begin, const char *end, T &dest) {
+#if defined(__cpp_lib_to_chars)
+    const std::from_chars_result r = std::from_chars(begin, end, dest);
+    return r.ec == std::errc() && r.ptr == end;
+#else
+    return parse_classic_floating(begin, end, dest);
+#endif
+}
+
+template <typename T>
+struct floating_convert {
+    template <typename Char>
+    static bool parse(const Char *begin, const Char *end, T &dest) {
+        trim_blanks(begin, end);
+        // from_chars accepts a minus only; a plus is allowed in front of
+        // an unsigned number.
+        if (begin != end && *begin == Char('+')) {
+            ++begin;
+            if (begin != end && (*begin == Char('+') || *begin == Char('-')))
+                return false;
+        }
+        if (begin == end)
+            return false;
+
+        // Numbers are ASCII, so narrowing each character is exact.
+        const std::size_t inline_size = 64;
+        char inline_buf[inline_size];
+        std::string heap_buf;
+        const std::size_t n = static_cast<std::size_t>(end - begin);
+        char *buf = inline_buf;
+        if (n >= inline_size) {
+            heap_buf.resize(n + 1);
+            buf = &heap_buf[0];
+        }
+        for (std::size_t i = 0; i < n; ++i) {
+            const Char c = begin[i];
+            if (c <= Char(0) || c > Char(127))
+                return false;
+            buf[i] = static_cast<char>(c);
+        }
+        buf[n] = '\0';
+        return parse_narrow_floating(buf, buf + n, dest);
+    }
+};
+
+} // namespace detail
+
+#define TEXT_CSV_DEFINE_CONVERT(type, impl)                                   \
+    template <>                                                               \
+    struct convert<type> : detail::impl<type> {}
+
+TEXT_CSV_DEFINE_CONVERT(short, signed_convert);
+TEXT_CSV_DEFINE_CONVERT(int, signed_convert);
+TEXT_CSV_DEFINE_CONVERT(long, signed_convert);
+TEXT_CSV_DEFINE_CONVERT(unsigned short, unsigned_convert);
+TEXT_CSV_DEFINE_CONVERT(unsigned, unsigned_convert);
+TEXT_CSV_DEFINE_CONVERT(unsigned long, unsigned_convert);
+#if __cplusplus >= 201103
+TEXT_CSV_DEFINE_CONVERT(long long, signed_convert);
+TEXT_CSV_DEFINE_CONVERT(unsigned long long, unsigned_convert);
+#endif
+TEXT_CSV_DEFINE_CONVERT(float, floating_convert);
+TEXT_CSV_DEFINE_CONVERT(double, floating_convert);
+TEXT_CSV_DEFINE_CONVERT(long double, floating_convert);
+
+#undef TEXT_CSV_DEFINE_CONVERT
+
+/// @brief Accepts <tt>1</tt>, <tt>0</tt>, <tt>true</tt> and <tt>false</tt>
+/// (case-insensitive).
+template <>
+struct convert<bool> {
+    template <typename Char>
+    static bool parse(const Char *begin, const Char *end, bool &dest) {
+        detail::trim_blanks(begin, end);
+        if (end - begin == 1 && (*begin == Char('0') || *begin == Char('1'))) {
+            dest = *begin == Char('1');
+            return true;
+        }
+        if (detail::equals_ignore_case(begin, end, "true")) {
+            dest = true;
+            return true;
+        }
+        if (detail::equals_ignore_case(begin, end, "false")) {
+            dest = false;
+            return true;
+        }
+        return false;
+    }
+};
+
+/// @brief Copies the field verbatim, whitespace included.
+template <typename Char, typename Traits, typename Alloc>
+struct convert<std::basic_string<Char, Traits, Alloc> > {
+    static bool parse(const Char *begin, const Char *end,
+                      std::basic_string<Char, Traits, Alloc> &dest) {
+        dest.assign(begin, end);
+        return true;
+    }
+};
+
+/// @brief Converts [begin, end) to <tt>T</tt>, throws std::runtime_error
+/// if the field is not a valid value.
+template <typename T, typename Char>
+T field_cast(const Char *begin, const Char *end) {
+    T value;
+    if (!convert<T>::parse(begin, end, value)) {
+        throw std::runtime_error("Invalid field value");
+    }
+    return value;
+}
+
+template <typename T, typename Char, typename Traits, typename Alloc>
+T field_cast(const std::basic_string<Char, Traits, Alloc> &field) {
+    const Char *const data = field.data();
+    return field_cast<T>(data, data + field.size());
+}
+} // namespace csv
+} // namespace text
+
+#endif
@@ -0,0 +1,343 @@
+#ifndef TEXT_CSV_DEDUP_HPP
+#define TEXT_CSV_DEDUP_HPP
+
+//          Copyright Roman Kashitsyn 2014 - 2015.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "batch.hpp"
+#include "hash.hpp"
+#include "ostream.hpp"
+#include "sink.hpp"
+#include "temp_files.hpp"
+
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// De-duplication
+// ==============
+//
+// basic_deduplicator drops records whose key was seen before. A record
+// is identified by a 128-bit fingerprint of the raw characters of its
+// key fields, or of all its fields if no key columns are given; only
+// fingerprints are kept, 16 bytes per distinct record.
+//
+// When the fingerprints outgrow the memory budget, the set seen so far
+// is frozen: records it contains are dropped, and the others are
+// spilled to temporary files partitioned by fingerprint. Each partition
+// is then de-duplicated on its own, recursively if it is still too
+// large. Records written before the spill keep their input order;
+// records from the partitions follow, in input order within each
+// partition.
+
+namespace text {
+namespace csv {
+namespace detail {
+
+/// Open-addressing set of record fingerprints.
+class fingerprint_set {
+public:
+    fingerprint_set()
+        : size_(0) {
+        slots_.resize(16, empty());
+    }
+
+    /// Returns false if <tt>h</tt> is already in the set.
+    bool insert(const hash128 &h) {
+        std::size_t i = locate(h);
+        if (slots_[i] == h)
+            return false;
+        slots_[i] = h;
+        if (2 * ++size_ > slots_.size())
+            grow();
+        return true;
+    }
+
+    bool contains(const hash128 &h) const { return slots_[locate(h)] == h; }
+
+    std::size_t size() const { return size_; }
+
+    std::size_t memory_size() const { return slots_.size() * sizeof(hash128); }
+
+    void clear() {
+        std::vector<hash128>(16, empty()).swap(slots_);
+        size_ = 0;
+    }
+
+private:
+    // Fingerprints are never zero, see basic_deduplicator::fingerprint().
+    static hash128 empty() {
+        const hash128 h = { 0, 0 };
+        return h;
+    }
+
+    std::size_t locate(const hash128 &h) const {
+        const std::size_t mask = slots_.size() - 1;
+        std::size_t i = std::size_t(h.low) & mask;
+        while (slots_[i] != empty() && slots_[i] != h)
+            i = (i + 1) & mask;
+        return i;
+    }
+
+    void grow() {
+        std::vector<hash128> old(slots_.size() * 2, empty());
+        old.swap(slots_);
+        for (std::size_t s = 0; s < old.size(); ++s) {
+            if (old[s] != empty())
+                slots_[locate(old[s])] = old[s];
+        }
+    }
+
+private:
+    std::vector<hash128> slots_;
+    std::size_t size_;
+};
+
+/// Output files of a spill, deleted on destruction.
+template <typename Char, typename Traits>
+struct partition_files {
+    typedef std::basic_ofstream<Char, Traits> file_type;
+    typedef basic_csv_ostream<Char, Traits> writer_type;
+
+    partition_files() {}
+
+    ~partition_files() {
+        for (std::size_t i = 0; i < writers.size(); ++i)
+            delete writers[i];
+        for (std::size_t i = 0; i < files.size(); ++i)
+            delete files[i];
+    }
+
+    void open(detail::temp_files &tmp, std::size_t n) {
+        for (std::size_t i = 0; i < n; ++i) {
+            names.push_back(tmp.create());
+            files.push_back(
+                new file_type(names.back().c_str(), std::ios_base::binary));
+            writers.push_back(new writer_type(*files.back()));
+            writers.back()->buffer_size(output_block_size());
+        }
+    }
+
+    std::vector<std::string> names;
+    std::vector<file_type *> files;
+    std::vector<writer_type *> writers;
+
+private:
+    partition_files(partition_files const &);
+    partition_files &operator=(partition_files const &);
+};
+} // namespace detail
+
+/// @brief Streaming de-duplication of records by key columns or by the
+/// whole record.
+template <typename Char, typename Traits = std::char_traits<Char> >
+class basic_deduplicator {
+public:
+    typedef std::basic_istream<Char, Traits> istream_type;
+    typedef std::basic_ostream<Char, Traits> ostream_type;
+    typedef basic_field_view<Char, Traits> field_type;
+    typedef basic_row_batch<Char, Traits> batch_type;
+    typedef basic_batch_reader<Char, Traits> reader_type;
+
+    basic_deduplicator()
+        : memory_budget_(std::size_t(64) << 20)
+        , partitions_(16)
+        , has_header_(false)
+        , temp_directory_(detail::default_temp_directory())
+        , rows_read_(0)
+        , rows_written_(0) {}
+
+    /// @brief Adds a key column. Without key columns whole records are
+    /// compared.
+    void key(std::size_t col) { keys_.push_back(col); }
+
+    const std::vector<std::size_t> &keys() const { return keys_; }
+
+    /// @brief Bytes of fingerprints kept in memory before spilling.
+    std::size_t memory_budget() const { return memory_budget_; }
+
+    void memory_budget(std::size_t bytes) { memory_budget_ = bytes; }
+
+    /// @brief Number of files a spill is split into.
+    std::size_t partitions() const { return partitions_; }
+
+    void partitions(std::size_t n) { partitions_ = n < 2 ? 2 : n; }
+
+    bool has_header() const { return has_header_; }
+
+    void has_header(bool h) { has_header_ = h; }
+
+    const std::string &temp_directory() const { return temp_directory_; }
+
+    void temp_directory(const std::string &dir) { temp_directory_ = dir; }
+
+    /// @brief Returns the fingerprint of row <tt>row</tt> of
+    /// <tt>batch</tt>.
+    hash128 fingerprint(const batch_type &batch, std::size_t row) const;
+
+    /// @brief Returns true if row <tt>row</tt> of <tt>batch</tt> was not
+    /// seen by previous calls and remembers it. The memory budget does not
+    /// apply.
+    bool insert(const batch_type &batch, std::size_t row) {
+        return seen_.insert(fingerprint(batch, row));
+    }
+
+    /// @brief Returns number of distinct records remembered by insert().
+    std::size_t size() const { return seen_.size(); }
+
+    /// @brief Forgets records remembered by insert().
+    void clear() { seen_.clear(); }
+
+    /// @brief Copies the first occurrence of every record of <tt>in</tt>
+    /// to <tt>out</tt>.
+    void dedup(istream_type &in, ostream_type &out);
+
+    /// @brief Returns number of records read by the last dedup().
+    uint64_t rows_read() const { return rows_read_; }
+
+    /// @brief Returns number of records written by the last dedup().
+    uint64_t rows_written() const { return rows_written_; }
+
+private:
+    // Partitions nested deeper than this are processed in memory.
+    static std::size_t max_depth() { return 8; }
+
+    void run(reader_type &reader, basic_csv_ostream<Char, Traits> &out,
+             detail::temp_files &tmp, std::size_t depth);
+
+    static void write(const batch_type &batch, std::size_t row,
+                      basic_csv_ostream<Char, Traits> &out) {
+        for (std::size_t c = 0, n = batch.field_count(row); c < n; ++c) {
+            out << batch.field(row, c);
+        }
+        out.end_line();
+    }
+
+private:
+    std::vector<std::size_t> keys_;
+    std::size_t memory_budget_;
+    std::size_t partitions_;
+    bool has_header_;
+    std::string temp_directory_;
+    detail::fingerprint_set seen_;
+    uint64_t rows_read_;
+    uint64_t rows_written_;
+};
+
+typedef basic_deduplicator<char> deduplicator;
+typedef basic_deduplicator<wchar_t> wdeduplicator;
+
+// Implementation
+
+template <typename Char, typename Traits>
+hash128 basic_deduplicator<Char, Traits>::fingerprint(const batch_type &batch,
+                                                      std::size_t row) const {
+    const std::size_t fields = batch.field_count(row);
+    hash128 h = { 0, 0 };
+    if (keys_.empty()) {
+        for (std::size_t c = 0; c < fields; ++c) {
+            const field_type f = batch.field(row, c);
+            h = hash_combine(h, hash_field128(f.begin(), f.end()));
+        }
+    } else {
+        for (std::size_t k = 0; k < keys_.size(); ++k) {
+            const field_type f =
+                keys_[k] < fields ? batch.field(row, keys_[k]) : field_type();
+            h = hash_combine(h, hash_field128(f.begin(), f.end()));
+        }
+    }
+    // Zero marks empty slots of the fingerprint set.
+    if (h.low == 0 && h.high == 0)
+        h.low = 1;
+    return h;
+}
+
+template <typename Char, typename Traits>
+void basic_deduplicator<Char, Traits>::dedup(istream_type &in,
+                                             ostream_type &out) {
+    rows_read_ = 0;
+    rows_written_ = 0;
+
+    reader_type reader(in);
+    basic_csv_ostream<Char, Traits> csv(out);
+    csv.buffer_size(detail::output_block_size());
+    if (has_header_) {
+        const basic_header<Char, Traits> &h = reader.read_header();
+        for (std::size_t i = 0; i < h.size(); ++i) {
+            csv << h.name_of(i);
+        }
+        csv.end_line();
+    }
+
+    detail::temp_files tmp(temp_directory_);
+    run(reader, csv, tmp, 0);
+    csv.flush();
+}
+
+template <typename Char, typename Traits>
+void basic_deduplicator<Char, Traits>::run(reader_type &reader,
+                                           basic_csv_ostream<Char, Traits> &out,
+                                           detail::temp_files &tmp,
+                                           std::size_t depth) {
+    typedef detail::partition_files<Char, Traits> files_type;
+
+    detail::fingerprint_set seen;
+    files_type spill;
+
+    batch_type batch;
+    while (reader.next(batch)) {
+        if (depth == 0)
+            rows_read_ += batch.size();
+
+        for (std::size_t r = 0, n = batch.size(); r < n; ++r) {
+            const hash128 h = fingerprint(batch, r);
+            if (spill.files.empty()) {
+                if (!seen.insert(h))
+                    continue;
+                write(batch, r, out);
+                ++rows_written_;
+
+                if (seen.memory_size() > memory_budget_ &&
+                    depth < max_depth()) {
+                    spill.open(tmp, partitions_);
+                }
+            } else if (!seen.contains(h)) {
+                // Mix in the depth so nested spills split differently.
+                const std::size_t p =
+                    std::size_t(hash_combine(h.high, depth) % partitions_);
+                write(batch, r, *spill.writers[p]);
+            }
+        }
+    }
+
+    if (spill.files.empty())
+        return;
+
+    seen.clear();
+    for (std::size_t p = 0; p < spill.files.size(); ++p) {
+        spill.writers[p]->flush();
+        if (!*spill.files[p]) {
+            throw std::runtime_error("Cannot write temporary file");
+        }
+        spill.files[p]->close();
+    }
+
+    for (std::size_t p = 0; p < spill.names.size(); ++p) {
+        std::basic_ifstream<Char, Traits> in(spill.names[p].c_str(),
+                                             std::ios_base::binary);
+        if (!in) {
+            throw std::runtime_error("Cannot read temporary file");
+        }
+        reader_type part(in);
+        run(part, out, tmp, depth + 1);
+        in.close();
+        std::remove(spill.names[p].c_str());
+    }
+}
+} // namespace csv
+} // namespace text
+
+#endif
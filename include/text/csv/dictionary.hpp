@@ -0,0 +1,181 @@
+#ifndef TEXT_CSV_DICTIONARY_HPP
+#define TEXT_CSV_DICTIONARY_HPP
+
+//          Copyright Roman Kashitsyn 2014 - 2015.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "field.hpp"
+#include "hash.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace text {
+namespace csv {
+
+/// @brief Interns field values and assigns them dense 32-bit codes.
+///
+/// @details Values are stored once, back to back, in a single
+/// character buffer. Lookup is an open-addressing hash table over the
+/// raw field characters. Codes are assigned in order of first
+/// appearance, starting from zero, so they can index plain arrays.
+///
+/// Views returned by value() are invalidated by the next intern().
+template <typename Char, typename Traits = std::char_traits<Char> >
+class basic_dictionary {
+public:
+    typedef Char char_type;
+    typedef Traits traits_type;
+    typedef uint32_t code_type;
+    typedef basic_field_view<Char, Traits> view_type;
+    typedef std::basic_string<Char, Traits> string_type;
+
+    static const code_type npos;
+
+    basic_dictionary();
+
+    /// @brief Returns the code of [begin, end), adding it if necessary.
+    code_type intern(const char_type *begin, const char_type *end);
+
+    code_type intern(const view_type &v) { return intern(v.begin(), v.end()); }
+
+    /// @brief Returns the code of [begin, end) or npos if it is unknown.
+    code_type find(const char_type *begin, const char_type *end) const;
+
+    code_type find(const view_type &v) const { return find(v.begin(), v.end()); }
+
+    /// @brief Returns the value with code <tt>c</tt>.
+    view_type value(code_type c) const;
+
+    view_type operator[](code_type c) const { return value(c); }
+
+    /// @brief Returns number of distinct values.
+    std::size_t size() const { return offsets_.size() - 1; }
+
+    bool empty() const { return size() == 0; }
+
+    /// @brief Returns number of characters used by the values.
+    std::size_t chars_size() const { return chars_.size(); }
+
+    void clear();
+
+    void swap(basic_dictionary &other);
+
+private:
+    std::size_t slot_of(const char_type *begin, const char_type *end) const;
+    void grow();
+
+private:
+    std::vector<char_type> chars_;
+    std::vector<std::size_t> offsets_;
+    std::vector<code_type> slots_;
+};
+
+typedef basic_dictionary<char> dictionary;
+typedef basic_dictionary<wchar_t> wdictionary;
+
+// Implementation
+
+template <typename Char, typename Traits>
+const typename basic_dictionary<Char, Traits>::code_type
+    basic_dictionary<Char, Traits>::npos = static_cast<code_type>(-1);
+
+template <typename Char, typename Traits>
+basic_dictionary<Char, Traits>::basic_dictionary()
+    : offsets_(1, 0)
+    , slots_(16, npos) {}
+
+template <typename Char, typename Traits>
+std::size_t basic_dictionary<Char, Traits>::slot_of(const char_type *begin,
+                                                   const char_type *end) const {
+    const std::size_t mask = slots_.size() - 1;
+    const std::size_t n = std::size_t(end - begin);
+    std::size_t i = std::size_t(hash_field(begin, end)) & mask;
+
+    for (;; i = (i + 1) & mask) {
+        const code_type c = slots_[i];
+        if (c == npos)
+            return i;
+        const std::size_t b = offsets_[c], e = offsets_[c + 1];
+        if (e - b == n &&
+            (n == 0 || traits_type::compare(&chars_[b], begin, n) == 0))
+            return i;
+    }
+}
+
+template <typename Char, typename Traits>
+typename basic_dictionary<Char, Traits>::code_type
+basic_dictionary<Char, Traits>::intern(const char_type *begin,
+                                       const char_type *end) {
+    std::size_t i = slot_of(begin, end);
+    if (slots_[i] != npos)
+        return slots_[i];
+
+    if (size() >= npos - 1) {
+        throw std::length_error("Dictionary is full");
+    }
+
+    const code_type c = static_cast<code_type>(size());
+    chars_.insert(chars_.end(), begin, end);
+    offsets_.push_back(chars_.size());
+
+    // Keep the load factor at or below 1/2.
+    if (2 * size() > slots_.size()) {
+        grow();
+    } else {
+        slots_[i] = c;
+    }
+    return c;
+}
+
+template <typename Char, typename Traits>
+typename basic_dictionary<Char, Traits>::code_type
+basic_dictionary<Char, Traits>::find(const char_type *begin,
+                                     const char_type *end) const {
+    return slots_[slot_of(begin, end)];
+}
+
+template <typename Char, typename Traits>
+typename basic_dictionary<Char, Traits>::view_type
+basic_dictionary<Char, Traits>::value(code_type c) const {
+    const char_type *const base = chars_.empty() ? 0 : &chars_[0];
+    return view_type(base + offsets_[c], base + offsets_[c + 1]);
+}
+
+template <typename Char, typename Traits>
+void basic_dictionary<Char, Traits>::grow() {
+    std::vector<code_type>(slots_.size() * 2, npos).swap(slots_);
+    const std::size_t mask = slots_.size() - 1;
+    const char_type *const base = chars_.empty() ? 0 : &chars_[0];
+
+    for (code_type c = 0, n = code_type(size()); c < n; ++c) {
+        const char_type *const b = base + offsets_[c];
+        const char_type *const e = base + offsets_[c + 1];
+        std::size_t i = std::size_t(hash_field(b, e)) & mask;
+        while (slots_[i] != npos)
+            i = (i + 1) & mask;
+        slots_[i] = c;
+    }
+}
+
+template <typename Char, typename Traits>
+void basic_dictionary<Char, Traits>::clear() {
+    chars_.clear();
+    offsets_.assign(1, 0);
+    slots_.assign(16, npos);
+}
+
+template <typename Char, typename Traits>
+void basic_dictionary<Char, Traits>::swap(basic_dictionary &other) {
+    chars_.swap(other.chars_);
+    offsets_.swap(other.offsets_);
+    slots_.swap(other.slots_);
+}
+} // namespace csv
+} // namespace text
+
+#endif
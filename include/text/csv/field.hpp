@@ -0,0 +1,113 @@
+#ifndef TEXT_CSV_FIELD_HPP
+#define TEXT_CSV_FIELD_HPP
+
+//          Copyright Roman Kashitsyn 2014 - 2015.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "convert.hpp"
+#include "ostream.hpp"
+#include <cstddef>
+#include <ostream>
+#include <string>
+
+namespace text {
+namespace csv {
+
+/// @brief Non-owning reference to the characters of a single field.
+///
+/// @details Views are produced by the batch-oriented readers and
+/// remain valid as long as the storage they point into is unchanged.
+template <typename Char, typename Traits = std::char_traits<Char> >
+class basic_field_view {
+public:
+    typedef Char char_type;
+    typedef Traits traits_type;
+    typedef std::basic_string<Char, Traits> string_type;
+    typedef const Char *iterator;
+    typedef const Char *const_iterator;
+
+    basic_field_view()
+        : begin_(0)
+        , end_(0) {}
+
+    basic_field_view(const char_type *begin, const char_type *end)
+        : begin_(begin)
+        , end_(end) {}
+
+    basic_field_view(const string_type &s)
+        : begin_(s.data())
+        , end_(s.data() + s.size()) {}
+
+    const_iterator begin() const { return begin_; }
+
+    const_iterator end() const { return end_; }
+
+    const char_type *data() const { return begin_; }
+
+    std::size_t size() const { return std::size_t(end_ - begin_); }
+
+    bool empty() const { return begin_ == end_; }
+
+    char_type operator[](std::size_t i) const { return begin_[i]; }
+
+    string_type str() const { return string_type(begin_, end_); }
+
+    /// @brief Converts the field with convert<T>.
+    template <typename T>
+    T as() const {
+        return field_cast<T>(begin_, end_);
+    }
+
+    int compare(const basic_field_view &rhs) const;
+
+    bool operator==(const basic_field_view &rhs) const {
+        return size() == rhs.size() &&
+               traits_type::compare(begin_, rhs.begin_, size()) == 0;
+    }
+
+    bool operator!=(const basic_field_view &rhs) const {
+        return !(*this == rhs);
+    }
+
+    bool operator<(const basic_field_view &rhs) const {
+        return compare(rhs) < 0;
+    }
+
+private:
+    const char_type *begin_;
+    const char_type *end_;
+};
+
+typedef basic_field_view<char> field_view;
+typedef basic_field_view<wchar_t> wfield_view;
+
+template <typename Char, typename Traits>
+int basic_field_view<Char, Traits>::compare(
+    const basic_field_view<Char, Traits> &rhs) const {
+    const std::size_t n = size() < rhs.size() ? size() : rhs.size();
+    const int c = traits_type::compare(begin_, rhs.begin_, n);
+    if (c != 0)
+        return c;
+    return size() < rhs.size() ? -1 : (size() > rhs.size() ? 1 : 0);
+}
+
+template <typename Char, typename Traits>
+std::basic_ostream<Char, Traits> &
+operator<<(std::basic_ostream<Char, Traits> &os,
+           const basic_field_view<Char, Traits> &f) {
+    os.write(f.data(), std::streamsize(f.size()));
+    return os;
+}
+
+template <typename Char, typename Traits>
+basic_csv_ostream<Char, Traits> &
+operator<<(basic_csv_ostream<Char, Traits> &os,
+           const basic_field_view<Char, Traits> &f) {
+    return os.write(f.begin(), f.end());
+}
+} // namespace csv
+} // namespace text
+
+#endif
@@ -0,0 +1,174 @@
+#ifndef TEXT_CSV_FORMAT_HPP
+#define TEXT_CSV_FORMAT_HPP
+
+//          Copyright Roman Kashitsyn 2014 - 2015.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <clocale>
+
+#if __cplusplus >= 201703L && defined(__has_include)
+#if __has_include(<charconv>)
+#include <charconv>
+#endif
+#endif
+
+// Number formatting
+// =================
+//
+// The counterpart of convert.hpp for the write path: numbers are
+// formatted into a caller-provided character array without streams,
+// locales or allocations. Integers are written in decimal; floating
+// point values get the shortest representation that reads back to the
+// same value, via std::to_chars where the library provides it.
+
+namespace text {
+namespace csv {
+namespace detail {
+
+/// Size of a buffer large enough for any formatted number.
+const std::size_t max_number_chars = 64;
+
+inline const char *digit_pairs() {
+    return "00010203040506070809"
+           "10111213141516171819"
+           "20212223242526272829"
+           "30313233343536373839"
+           "40414243444546474849"
+           "50515253545556575859"
+           "60616263646566676869"
+           "70717273747576777879"
+           "80818283848586878889"
+           "90919293949596979899";
+}
+
+/// Writes the decimal digits of <tt>v</tt> at <tt>first</tt> and
+/// returns the end.
+template <typename U>
+char *format_unsigned(U v, char *first) {
+    char digits[max_number_chars];
+    char *p = digits + max_number_chars;
+    while (v >= 100) {
+        const char *const pair = digit_pairs() + 2 * std::size_t(v % 100);
+        v /= 100;
+        *--p = pair[1];
+        *--p = pair[0];
+    }
+    if (v >= 10) {
+        const char *const pair = digit_pairs() + 2 * std::size_t(v);
+        *--p = pair[1];
+        *--p = pair[0];
+    } else {
+        *--p = char('0' + v);
+    }
+    const std::size_t n = std::size_t(digits + max_number_chars - p);
+    std::memcpy(first, p, n);
+    return first + n;
+}
+
+template <typename U, typename T>
+char *format_signed(T v, char *first) {
+    if (v < 0) {
+        *first++ = '-';
+        return format_unsigned(U(0) - U(v), first);
+    }
+    return format_unsigned(U(v), first);
+}
+
+inline char *format_number(bool v, char *first) {
+    *first = v ? '1' : '0';
+    return first + 1;
+}
+
+inline char *format_number(int v, char *first) {
+    return format_signed<unsigned>(v, first);
+}
+
+inline char *format_number(long v, char *first) {
+    return format_signed<unsigned long>(v, first);
+}
+
+inline char *format_number(unsigned v, char *first) {
+    return format_unsigned(v, first);
+}
+
+inline char *format_number(unsigned long v, char *first) {
+    return format_unsigned(v, first);
+}
+
+#if __cplusplus >= 201103
+
+inline char *format_number(long long v, char *first) {
+    return format_signed<unsigned long long>(v, first);
+}
+
+inline char *format_number(unsigned long long v, char *first) {
+    return format_unsigned(v, first);
+}
+
+#endif
+
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+
+template <typename T>
+char *format_floating(T v, char *first) {
+    return std::to_chars(first, first + max_number_chars, v).ptr;
+}
+
+#else
+
+/// Prints with increasing precision until the value reads back.
+inline char *format_printf(double v, char *first, int min_digits,
+                           int max_digits, bool is_float) {
+    int n = 0;
+    for (int digits = min_digits; digits <= max_digits; ++digits) {
+        n = std::snprintf(first, max_number_chars, "%.*g", digits, v);
+        const double back = std::strtod(first, 0);
+        if (is_float ? float(back) == float(v) : back == v)
+            break;
+    }
+    // printf honours LC_NUMERIC; CSV numbers always use a point.
+    const char point = *std::localeconv()->decimal_point;
+    if (point != '.') {
+        char *const p = static_cast<char *>(std::memchr(first, point, n));
+        if (p)
+            *p = '.';
+    }
+    return first + n;
+}
+
+inline char *format_floating(float v, char *first) {
+    return format_printf(v, first, 6, 9, true);
+}
+
+inline char *format_floating(double v, char *first) {
+    return format_printf(v, first, 15, 17, false);
+}
+
+inline char *format_floating(long double v, char *first) {
+    const int n = std::snprintf(first, max_number_chars, "%.21Lg", v);
+    return first + n;
+}
+
+#endif
+
+inline char *format_number(float v, char *first) {
+    return format_floating(v, first);
+}
+
+inline char *format_number(double v, char *first) {
+    return format_floating(v, first);
+}
+
+inline char *format_number(long double v, char *first) {
+    return format_floating(v, first);
+}
+} // namespace detail
+} // namespace csv
+} // namespace text
+
+#endif
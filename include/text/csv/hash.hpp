@@ -0,0 +1,235 @@
+#ifndef TEXT_CSV_HASH_HPP
+#define TEXT_CSV_HASH_HPP
+
+//          Copyright Roman Kashitsyn 2014 - 2015.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <cstddef>
+#include <cstring>
+#include <stdint.h>
+
+// Hashing of raw field bytes. The functions below are not
+// cryptographic; they are meant for hash tables that key on fields
+// without materializing strings.
+
+namespace text {
+namespace csv {
+namespace detail {
+
+inline uint64_t load64(const unsigned char *p) {
+    uint64_t v;
+    std::memcpy(&v, p, sizeof v);
+    return v;
+}
+
+inline uint64_t fmix64(uint64_t k) {
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdULL;
+    k ^= k >> 33;
+    k *= 0xc4ceb9fe1a85ec53ULL;
+    k ^= k >> 33;
+    return k;
+}
+
+inline uint64_t rotl64(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+} // namespace detail
+
+/// @brief 64-bit hash of <tt>len</tt> bytes (MurmurHash64A).
+inline uint64_t hash_bytes(const void *data, std::size_t len,
+                           uint64_t seed = 0) {
+    const uint64_t m = 0xc6a4a7935bd1e995ULL;
+    const int r = 47;
+
+    const unsigned char *p = static_cast<const unsigned char *>(data);
+    const unsigned char *const end = p + (len & ~std::size_t(7));
+    uint64_t h = seed ^ (len * m);
+
+    for (; p != end; p += 8) {
+        uint64_t k = detail::load64(p);
+        k *= m;
+        k ^= k >> r;
+        k *= m;
+        h ^= k;
+        h *= m;
+    }
+
+    switch (len & 7) {
+    case 7:
+        h ^= uint64_t(p[6]) << 48;
+    // fall through
+    case 6:
+        h ^= uint64_t(p[5]) << 40;
+    // fall through
+    case 5:
+        h ^= uint64_t(p[4]) << 32;
+    // fall through
+    case 4:
+        h ^= uint64_t(p[3]) << 24;
+    // fall through
+    case 3:
+        h ^= uint64_t(p[2]) << 16;
+    // fall through
+    case 2:
+        h ^= uint64_t(p[1]) << 8;
+    // fall through
+    case 1:
+        h ^= uint64_t(p[0]);
+        h *= m;
+    }
+
+    h ^= h >> r;
+    h *= m;
+    h ^= h >> r;
+    return h;
+}
+
+/// @brief Hashes the characters of the field [begin, end).
+template <typename Char>
+uint64_t hash_field(const Char *begin, const Char *end, uint64_t seed = 0) {
+    return hash_bytes(begin, std::size_t(end - begin) * sizeof(Char), seed);
+}
+
+/// @brief Mixes <tt>h</tt> into <tt>seed</tt>, for hashing field tuples.
+inline uint64_t hash_combine(uint64_t seed, uint64_t h) {
+    return detail::fmix64(seed ^ (h + 0x9e3779b97f4a7c15ULL + (seed << 6) +
+                                  (seed >> 2)));
+}
+
+/// @brief 128-bit hash value, wide enough to identify records by
+/// fingerprint alone.
+struct hash128 {
+    uint64_t low;
+    uint64_t high;
+};
+
+inline bool operator==(const hash128 &a, const hash128 &b) {
+    return a.low == b.low && a.high == b.high;
+}
+
+inline bool operator!=(const hash128 &a, const hash128 &b) {
+    return !(a == b);
+}
+
+/// @brief 128-bit hash of <tt>len</tt> bytes (MurmurHash3_x64_128).
+inline hash128 hash_bytes128(const void *data, std::size_t len,
+                             uint64_t seed = 0) {
+    const uint64_t c1 = 0x87c37b91114253d5ULL;
+    const uint64_t c2 = 0x4cf5ad432745937fULL;
+
+    const unsigned char *p = static_cast<const unsigned char *>(data);
+    const unsigned char *const end = p + (len & ~std::size_t(15));
+    uint64_t h1 = seed;
+    uint64_t h2 = seed;
+
+    for (; p != end; p += 16) {
+        uint64_t k1 = detail::load64(p);
+        uint64_t k2 = detail::load64(p + 8);
+
+        k1 *= c1;
+        k1 = detail::rotl64(k1, 31);
+        k1 *= c2;
+        h1 ^= k1;
+        h1 = detail::rotl64(h1, 27);
+        h1 += h2;
+        h1 = h1 * 5 + 0x52dce729;
+
+        k2 *= c2;
+        k2 = detail::rotl64(k2, 33);
+        k2 *= c1;
+        h2 ^= k2;
+        h2 = detail::rotl64(h2, 31);
+        h2 += h1;
+        h2 = h2 * 5 + 0x38495ab5;
+    }
+
+    uint64_t k1 = 0;
+    uint64_t k2 = 0;
+    switch (len & 15) {
+    case 15:
+        k2 ^= uint64_t(p[14]) << 48;
+    // fall through
+    case 14:
+        k2 ^= uint64_t(p[13]) << 40;
+    // fall through
+    case 13:
+        k2 ^= uint64_t(p[12]) << 32;
+    // fall through
+    case 12:
+        k2 ^= uint64_t(p[11]) << 24;
+    // fall through
+    case 11:
+        k2 ^= uint64_t(p[10]) << 16;
+    // fall through
+    case 10:
+        k2 ^= uint64_t(p[9]) << 8;
+    // fall through
+    case 9:
+        k2 ^= uint64_t(p[8]);
+        k2 *= c2;
+        k2 = detail::rotl64(k2, 33);
+        k2 *= c1;
+        h2 ^= k2;
+    // fall through
+    case 8:
+        k1 ^= uint64_t(p[7]) << 56;
+    // fall through
+    case 7:
+        k1 ^= uint64_t(p[6]) << 48;
+    // fall through
+    case 6:
+        k1 ^= uint64_t(p[5]) << 40;
+    // fall through
+    case 5:
+        k1 ^= uint64_t(p[4]) << 32;
+    // fall through
+    case 4:
+        k1 ^= uint64_t(p[3]) << 24;
+    // fall through
+    case 3:
+        k1 ^= uint64_t(p[2]) << 16;
+    // fall through
+    case 2:
+        k1 ^= uint64_t(p[1]) << 8;
+    // fall through
+    case 1:
+        k1 ^= uint64_t(p[0]);
+        k1 *= c1;
+        k1 = detail::rotl64(k1, 31);
+        k1 *= c2;
+        h1 ^= k1;
+    }
+
+    h1 ^= uint64_t(len);
+    h2 ^= uint64_t(len);
+    h1 += h2;
+    h2 += h1;
+    h1 = detail::fmix64(h1);
+    h2 = detail::fmix64(h2);
+    h1 += h2;
+    h2 += h1;
+
+    const hash128 h = { h1, h2 };
+    return h;
+}
+
+/// @brief 128-bit hash of the characters of the field [begin, end).
+template <typename Char>
+hash128 hash_field128(const Char *begin, const Char *end, uint64_t seed = 0) {
+    return hash_bytes128(begin, std::size_t(end - begin) * sizeof(Char), seed);
+}
+
+/// @brief Mixes <tt>h</tt> into <tt>seed</tt>, for fingerprinting field
+/// tuples.
+inline hash128 hash_combine(const hash128 &seed, const hash128 &h) {
+    const hash128 r = { hash_combine(seed.low, h.low),
+                        hash_combine(seed.high, h.high) };
+    return r;
+}
+} // namespace csv
+} // namespace text
+
+#endif
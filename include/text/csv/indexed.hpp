@@ -0,0 +1,653 @@
+#ifndef TEXT_CSV_INDEXED_HPP
+#define TEXT_CSV_INDEXED_HPP
+
+//          Copyright Roman Kashitsyn 2014 - 2015.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "convert.hpp"
+#include "rows.hpp"
+#include "scan.hpp"
+#include "sink.hpp"
+
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Indexed files
+// =============
+//
+// A CSV text held in memory, usually a memory mapped file, together with
+// the offsets of all of its records. The index is built with one
+// sequential scan; afterwards any record can be parsed on its own, so
+// the rows form a random-access range and a sorted file can be searched
+// with O(log N) record probes.
+
+namespace text {
+namespace csv {
+namespace detail {
+
+/// Splits records held in memory with the grammar basic_csv_istream
+/// reads.
+template <typename Char, typename Traits>
+struct record_scanner {
+    Char delim;
+    Char quote;
+    Char cr;
+    Char lf;
+
+    record_scanner(Char delimiter, Char quote_char)
+        : delim(delimiter)
+        , quote(quote_char)
+        , cr(CR)
+        , lf(LF) {}
+
+    /// Finds the field starting at <tt>p</tt> and returns the position
+    /// after its terminator. [begin, end) receives the field without
+    /// its enclosing quotes; <tt>doubled</tt> tells whether it contains
+    /// doubled quotes, <tt>more</tt> whether a delimiter ended it.
+    const Char *field(const Char *p, const Char *last, const Char *&begin,
+                      const Char *&end, bool &doubled, bool &more) const;
+
+    /// Returns the position after the record starting at <tt>p</tt>.
+    const Char *skip_record(const Char *p, const Char *last) const;
+
+    /// Parses the record starting at <tt>p</tt> into <tt>dest</tt>,
+    /// reusing its strings, and returns the position after it.
+    const Char *read(const Char *p, const Char *last,
+                     basic_row<Char, Traits> &dest) const;
+
+    /// Appends [begin, end) to <tt>dest</tt>, collapsing doubled quotes.
+    void unescape(const Char *begin, const Char *end,
+                  std::basic_string<Char, Traits> &dest) const;
+};
+
+#if defined(TEXT_CSV_HAS_POSIX_IO)
+
+/// Read-only memory mapping of a whole file.
+template <typename Char>
+class mapped_file {
+public:
+    mapped_file()
+        : data_(0)
+        , size_(0)
+        , bytes_(0) {}
+
+    ~mapped_file() {
+        if (bytes_ > 0)
+            ::munmap(const_cast<Char *>(data_), bytes_);
+    }
+
+    /// Maps the file at <tt>path</tt>; throws std::runtime_error on
+    /// failure.
+    void map(const std::string &path);
+
+    /// Tells the kernel that reads will be scattered, so read-ahead
+    /// would only evict other pages.
+    void random_access() {
+        if (bytes_ > 0)
+            ::madvise(const_cast<Char *>(data_), bytes_, MADV_RANDOM);
+    }
+
+    const Char *data() const { return data_; }
+
+    std::size_t size() const { return size_; }
+
+private:
+    mapped_file(const mapped_file &);
+    mapped_file &operator=(const mapped_file &);
+
+    const Char *data_;
+    std::size_t size_;
+    std::size_t bytes_;
+};
+
+#endif
+} // namespace detail
+
+/// @brief Random-access view of the records of a CSV text.
+///
+/// @details The constructor scans the text once and stores the offset
+/// of every record. Rows are parsed only when they are accessed:
+/// <tt>rows[k]</tt> parses record k alone, and lower_bound() on a key
+/// column of a sorted file converts only the key fields of the
+/// records it probes.
+///
+/// The text is either a memory mapped file or memory owned by the
+/// caller, which must outlive the view.
+template <typename Char, typename Traits = std::char_traits<Char> >
+class basic_indexed_file {
+public:
+    typedef Char char_type;
+    typedef Traits traits_type;
+    typedef std::basic_string<Char, Traits> string_type;
+    typedef basic_row<Char, Traits> row_type;
+    typedef basic_header<Char, Traits> header_type;
+
+    class const_iterator;
+    typedef const_iterator iterator;
+
+#if defined(TEXT_CSV_HAS_POSIX_IO)
+    /// @brief Maps the file at <tt>path</tt> read-only and indexes it;
+    /// throws std::runtime_error on failure.
+    /// @param header whether the first record is a header.
+    explicit basic_indexed_file(const std::string &path, bool header = true);
+    basic_indexed_file(const std::string &path, bool header,
+                       char_type delimiter);
+    basic_indexed_file(const std::string &path, bool header,
+                       char_type delimiter, char_type quote);
+#endif
+
+    /// @brief Indexes the text [begin, end) owned by the caller.
+    basic_indexed_file(const char_type *begin, const char_type *end,
+                       bool header = true);
+    basic_indexed_file(const char_type *begin, const char_type *end,
+                       bool header, char_type delimiter);
+    basic_indexed_file(const char_type *begin, const char_type *end,
+                       bool header, char_type delimiter, char_type quote);
+
+    /// @brief Returns number of records, not counting the header.
+    std::size_t size() const { return offsets_.size() - first_ - 1; }
+
+    bool empty() const { return size() == 0; }
+
+    /// @brief Returns the header; empty if the file has none.
+    const header_type &header() const { return header_; }
+
+    const_iterator begin() const { return const_iterator(this, 0); }
+
+    const_iterator end() const { return const_iterator(this, size()); }
+
+    /// @brief Parses record <tt>k</tt>.
+    row_type operator[](std::size_t k) const;
+
+    /// @brief Parses record <tt>k</tt>; throws std::out_of_range if
+    /// there is no such record.
+    row_type at(std::size_t k) const;
+
+    /// @brief Parses record <tt>k</tt> into <tt>dest</tt>, reusing its
+    /// strings.
+    void read(std::size_t k, row_type &dest) const;
+
+    /// @brief Returns field <tt>col</tt> of record <tt>k</tt>; throws
+    /// std::runtime_error if the record is too short.
+    string_type field(std::size_t k, std::size_t col) const;
+
+    /// @brief Converts field <tt>col</tt> of record <tt>k</tt> with
+    /// convert<T>.
+    template <typename T>
+    T as(std::size_t k, std::size_t col) const;
+
+    /// @brief Returns the first record whose column <tt>col</tt> is not
+    /// less than <tt>key</tt>.
+    /// @pre The records are sorted by column <tt>col</tt> as T.
+    template <typename T>
+    const_iterator lower_bound(std::size_t col, const T &key) const;
+
+    /// @brief Returns the first record whose column <tt>col</tt> is
+    /// greater than <tt>key</tt>.
+    /// @pre The records are sorted by column <tt>col</tt> as T.
+    template <typename T>
+    const_iterator upper_bound(std::size_t col, const T &key) const;
+
+private:
+    typedef detail::record_scanner<Char, Traits> scanner_type;
+
+    basic_indexed_file(const basic_indexed_file &);
+    basic_indexed_file &operator=(const basic_indexed_file &);
+
+    void build_index(bool header);
+    const char_type *find_field(std::size_t k, std::size_t col,
+                                const char_type *&end, bool &doubled) const;
+
+#if defined(TEXT_CSV_HAS_POSIX_IO)
+    detail::mapped_file<Char> mapping_;
+#endif
+    const char_type *data_;
+    std::size_t size_;
+    scanner_type scanner_;
+    std::vector<std::size_t> offsets_;
+    std::size_t first_;
+    header_type header_;
+};
+
+/// @brief Random-access iterator over the rows of a basic_indexed_file.
+/// Dereferencing parses the record and returns it by value.
+template <typename Char, typename Traits>
+class basic_indexed_file<Char, Traits>::const_iterator {
+public:
+    typedef std::random_access_iterator_tag iterator_category;
+    typedef row_type value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const row_type *pointer;
+    typedef row_type reference;
+
+    const_iterator()
+        : file_(0)
+        , k_(0) {}
+
+    const_iterator(const basic_indexed_file *file, std::size_t k)
+        : file_(file)
+        , k_(k) {}
+
+    /// @brief Returns the zero-based record number.
+    std::size_t index() const { return k_; }
+
+    row_type operator*() const { return (*file_)[k_]; }
+
+    row_type operator[](difference_type n) const {
+        return (*file_)[std::size_t(difference_type(k_) + n)];
+    }
+
+    const_iterator &operator++() {
+        ++k_;
+        return *this;
+    }
+
+    const_iterator operator++(int) {
+        const_iterator tmp(*this);
+        ++k_;
+        return tmp;
+    }
+
+    const_iterator &operator--() {
+        --k_;
+        return *this;
+    }
+
+    const_iterator operator--(int) {
+        const_iterator tmp(*this);
+        --k_;
+        return tmp;
+    }
+
+    const_iterator &operator+=(difference_type n) {
+        k_ = std::size_t(difference_type(k_) + n);
+        return *this;
+    }
+
+    const_iterator &operator-=(difference_type n) { return *this += -n; }
+
+    const_iterator operator+(difference_type n) const {
+        const_iterator tmp(*this);
+        return tmp += n;
+    }
+
+    const_iterator operator-(difference_type n) const {
+        const_iterator tmp(*this);
+        return tmp -= n;
+    }
+
+    difference_type operator-(const const_iterator &rhs) const {
+        return difference_type(k_) - difference_type(rhs.k_);
+    }
+
+    bool operator==(const const_iterator &rhs) const { return k_ == rhs.k_; }
+
+    bool operator!=(const const_iterator &rhs) const { return k_ != rhs.k_; }
+
+    bool operator<(const const_iterator &rhs) const { return k_ < rhs.k_; }
+
+    bool operator>(const const_iterator &rhs) const { return k_ > rhs.k_; }
+
+    bool operator<=(const const_iterator &rhs) const { return k_ <= rhs.k_; }
+
+    bool operator>=(const const_iterator &rhs) const { return k_ >= rhs.k_; }
+
+private:
+    const basic_indexed_file *file_;
+    std::size_t k_;
+};
+
+typedef basic_indexed_file<char> indexed_file;
+typedef basic_indexed_file<wchar_t> windexed_file;
+
+// Implementation
+
+namespace detail {
+
+template <typename Char, typename Traits>
+const Char *record_scanner<Char, Traits>::field(const Char *p,
+                                                const Char *last,
+                                                const Char *&begin,
+                                                const Char *&end,
+                                                bool &doubled,
+                                                bool &more) const {
+    doubled = false;
+    if (p != last && Traits::eq(*p, quote)) {
+        begin = ++p;
+        for (;;) {
+            p = Traits::find(p, std::size_t(last - p), quote);
+            if (!p) {
+                throw std::runtime_error("Unexpected end of input");
+            }
+            if (p + 1 == last || !Traits::eq(p[1], quote))
+                break;
+            doubled = true;
+            p += 2;
+        }
+        end = p++;
+    } else {
+        begin = p;
+        p = find_special(p, last, delim, cr, lf, lf);
+        end = p;
+    }
+
+    more = false;
+    if (p == last)
+        return p;
+    if (Traits::eq(*p, delim)) {
+        more = true;
+        return p + 1;
+    }
+    if (Traits::eq(*p, cr)) {
+        ++p;
+        if (p != last && Traits::eq(*p, lf))
+            ++p;
+        return p;
+    }
+    if (Traits::eq(*p, lf))
+        return p + 1;
+    throw std::runtime_error("Unexpected character");
+}
+
+template <typename Char, typename Traits>
+const Char *record_scanner<Char, Traits>::skip_record(const Char *p,
+                                                      const Char *last) const {
+    const Char *begin;
+    const Char *end;
+    bool doubled;
+    bool more = true;
+    while (more)
+        p = field(p, last, begin, end, doubled, more);
+    return p;
+}
+
+template <typename Char, typename Traits>
+const Char *record_scanner<Char, Traits>::read(
+    const Char *p, const Char *last, basic_row<Char, Traits> &dest) const {
+    const Char *begin;
+    const Char *end;
+    bool doubled;
+    bool more = true;
+    std::size_t n = 0;
+    while (more) {
+        p = field(p, last, begin, end, doubled, more);
+        if (n == dest.size())
+            dest.resize(n + 1);
+        std::basic_string<Char, Traits> &s = dest[n++];
+        s.clear();
+        if (doubled)
+            unescape(begin, end, s);
+        else
+            s.assign(begin, end);
+    }
+    dest.resize(n);
+    return p;
+}
+
+template <typename Char, typename Traits>
+void record_scanner<Char, Traits>::unescape(
+    const Char *begin, const Char *end,
+    std::basic_string<Char, Traits> &dest) const {
+    while (begin != end) {
+        const Char *q = Traits::find(begin, std::size_t(end - begin), quote);
+        if (!q) {
+            dest.append(begin, end);
+            return;
+        }
+        // Keep the first quote of the pair and skip the second one.
+        dest.append(begin, q + 1);
+        begin = q + 2;
+    }
+}
+} // namespace detail
+
+#if defined(TEXT_CSV_HAS_POSIX_IO)
+
+template <typename Char, typename Traits>
+basic_indexed_file<Char, Traits>::basic_indexed_file(const std::string &path,
+                                                     bool header)
+    : data_(0)
+    , size_(0)
+    , scanner_(COMMA, QUOTE)
+    , first_(0) {
+    mapping_.map(path);
+    data_ = mapping_.data();
+    size_ = mapping_.size();
+    build_index(header);
+    // Lookups touch a few pages each.
+    mapping_.random_access();
+}
+
+template <typename Char, typename Traits>
+basic_indexed_file<Char, Traits>::basic_indexed_file(const std::string &path,
+                                                     bool header,
+                                                     char_type delimiter)
+    : data_(0)
+    , size_(0)
+    , scanner_(delimiter, QUOTE)
+    , first_(0) {
+    mapping_.map(path);
+    data_ = mapping_.data();
+    size_ = mapping_.size();
+    build_index(header);
+    // Lookups touch a few pages each.
+    mapping_.random_access();
+}
+
+template <typename Char, typename Traits>
+basic_indexed_file<Char, Traits>::basic_indexed_file(const std::string &path,
+                                                     bool header,
+                                                     char_type delimiter,
+                                                     char_type quote)
+    : data_(0)
+    , size_(0)
+    , scanner_(delimiter, quote)
+    , first_(0) {
+    mapping_.map(path);
+    data_ = mapping_.data();
+    size_ = mapping_.size();
+    build_index(header);
+    // Lookups touch a few pages each.
+    mapping_.random_access();
+}
+
+#endif
+
+template <typename Char, typename Traits>
+basic_indexed_file<Char, Traits>::basic_indexed_file(const char_type *begin,
+                                                     const char_type *end,
+                                                     bool header)
+    : data_(begin)
+    , size_(std::size_t(end - begin))
+    , scanner_(COMMA, QUOTE)
+    , first_(0) {
+    build_index(header);
+}
+
+template <typename Char, typename Traits>
+basic_indexed_file<Char, Traits>::basic_indexed_file(const char_type *begin,
+                                                     const char_type *end,
+                                                     bool header,
+                                                     char_type delimiter)
+    : data_(begin)
+    , size_(std::size_t(end - begin))
+    , scanner_(delimiter, QUOTE)
+    , first_(0) {
+    build_index(header);
+}
+
+template <typename Char, typename Traits>
+basic_indexed_file<Char, Traits>::basic_indexed_file(const char_type *begin,
+                                                     const char_type *end,
+                                                     bool header,
+                                                     char_type delimiter,
+                                                     char_type quote)
+    : data_(begin)
+    , size_(std::size_t(end - begin))
+    , scanner_(delimiter, quote)
+    , first_(0) {
+    build_index(header);
+}
+
+#if defined(TEXT_CSV_HAS_POSIX_IO)
+
+template <typename Char>
+void detail::mapped_file<Char>::map(const std::string &path) {
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open input file");
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Cannot open input file");
+    }
+    const std::size_t bytes = std::size_t(st.st_size);
+    if (bytes >= sizeof(Char)) {
+        void *p = ::mmap(0, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error("Cannot map input file");
+        }
+        data_ = static_cast<const Char *>(p);
+        size_ = bytes / sizeof(Char);
+        bytes_ = bytes;
+    }
+    ::close(fd);
+}
+
+#endif
+
+template <typename Char, typename Traits>
+void basic_indexed_file<Char, Traits>::build_index(bool header) {
+    const char_type *p = data_;
+    const char_type *const last = data_ + size_;
+    while (p != last) {
+        offsets_.push_back(std::size_t(p - data_));
+        p = scanner_.skip_record(p, last);
+    }
+    offsets_.push_back(size_);
+
+    if (header && offsets_.size() > 1) {
+        row_type names;
+        read(0, names);
+        header_.assign(names);
+        first_ = 1;
+    }
+}
+
+template <typename Char, typename Traits>
+typename basic_indexed_file<Char, Traits>::row_type
+    basic_indexed_file<Char, Traits>::operator[](std::size_t k) const {
+    row_type row;
+    read(k, row);
+    return row;
+}
+
+template <typename Char, typename Traits>
+typename basic_indexed_file<Char, Traits>::row_type
+basic_indexed_file<Char, Traits>::at(std::size_t k) const {
+    if (k >= size()) {
+        throw std::out_of_range("Record index out of range");
+    }
+    return (*this)[k];
+}
+
+template <typename Char, typename Traits>
+void basic_indexed_file<Char, Traits>::read(std::size_t k,
+                                            row_type &dest) const {
+    scanner_.read(data_ + offsets_[first_ + k],
+                  data_ + offsets_[first_ + k + 1], dest);
+}
+
+template <typename Char, typename Traits>
+const Char *basic_indexed_file<Char, Traits>::find_field(std::size_t k,
+                                                         std::size_t col,
+                                                         const char_type *&end,
+                                                         bool &doubled) const {
+    const char_type *p = data_ + offsets_[first_ + k];
+    const char_type *const last = data_ + offsets_[first_ + k + 1];
+    const char_type *begin;
+    bool more = true;
+    for (std::size_t i = 0; i <= col; ++i) {
+        if (!more) {
+            throw std::runtime_error("Missing value in column");
+        }
+        p = scanner_.field(p, last, begin, end, doubled, more);
+    }
+    return begin;
+}
+
+template <typename Char, typename Traits>
+typename basic_indexed_file<Char, Traits>::string_type
+basic_indexed_file<Char, Traits>::field(std::size_t k, std::size_t col) const {
+    const char_type *end;
+    bool doubled;
+    const char_type *const begin = find_field(k, col, end, doubled);
+    string_type s;
+    if (doubled)
+        scanner_.unescape(begin, end, s);
+    else
+        s.assign(begin, end);
+    return s;
+}
+
+template <typename Char, typename Traits>
+template <typename T>
+T basic_indexed_file<Char, Traits>::as(std::size_t k, std::size_t col) const {
+    const char_type *end;
+    bool doubled;
+    const char_type *const begin = find_field(k, col, end, doubled);
+    if (!doubled)
+        return field_cast<T>(begin, end);
+    string_type s;
+    scanner_.unescape(begin, end, s);
+    return field_cast<T>(s);
+}
+
+template <typename Char, typename Traits>
+template <typename T>
+typename basic_indexed_file<Char, Traits>::const_iterator
+basic_indexed_file<Char, Traits>::lower_bound(std::size_t col,
+                                              const T &key) const {
+    std::size_t lo = 0;
+    std::size_t n = size();
+    while (n > 0) {
+        const std::size_t half = n / 2;
+        if (as<T>(lo + half, col) < key) {
+            lo += half + 1;
+            n -= half + 1;
+        } else {
+            n = half;
+        }
+    }
+    return const_iterator(this, lo);
+}
+
+template <typename Char, typename Traits>
+template <typename T>
+typename basic_indexed_file<Char, Traits>::const_iterator
+basic_indexed_file<Char, Traits>::upper_bound(std::size_t col,
+                                              const T &key) const {
+    std::size_t lo = 0;
+    std::size_t n = size();
+    while (n > 0) {
+        const std::size_t half = n / 2;
+        if (!(key < as<T>(lo + half, col))) {
+            lo += half + 1;
+            n -= half + 1;
+        } else {
+            n = half;
+        }
+    }
+    return const_iterator(this, lo);
+}
+} // namespace csv
+} // namespace text
+
+#endif
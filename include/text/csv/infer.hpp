@@ -0,0 +1,210 @@
+#ifndef TEXT_CSV_INFER_HPP
+#define TEXT_CSV_INFER_HPP
+
+//          Copyright Roman Kashitsyn 2014 - 2015.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "batch.hpp"
+#include "schema.hpp"
+#include "timestamp.hpp"
+
+#include <istream>
+#include <limits>
+#include <vector>
+
+namespace text {
+namespace csv {
+
+/// @brief Infers column types from a sample of records.
+///
+/// @details Each column starts with every candidate type and loses a
+/// candidate the first time a non-empty field does not convert to it,
+/// so every field is converted at most once per remaining candidate.
+/// The narrowest surviving type wins, in the order int64, double, bool,
+/// timestamp, string. Double additionally needs at least one finite
+/// value, so a column holding only "nan" or "inf" markers stays a
+/// string column. Columns with an empty or missing field in the sample
+/// are nullable.
+template <typename Char, typename Traits = std::char_traits<Char> >
+class basic_type_inference {
+public:
+    typedef basic_field_view<Char, Traits> field_type;
+    typedef basic_row_batch<Char, Traits> batch_type;
+    typedef basic_header<Char, Traits> header_type;
+    typedef basic_schema<Char, Traits> schema_type;
+
+    basic_type_inference()
+        : rows_(0) {}
+
+    /// @brief Accounts for field <tt>col</tt> of one record.
+    void observe(std::size_t col, const field_type &f);
+
+    /// @brief Accounts for every record of <tt>batch</tt>.
+    void observe(const batch_type &batch);
+
+    /// @brief Returns number of records observed.
+    std::size_t rows() const { return rows_; }
+
+    /// @brief Returns the schema inferred so far; columns are named after
+    /// <tt>header</tt>.
+    schema_type schema(const header_type &header) const;
+
+private:
+    enum candidate {
+        int64_candidate = 1,
+        double_candidate = 2,
+        bool_candidate = 4,
+        timestamp_candidate = 8,
+        all_candidates = 15
+    };
+
+    struct column_state {
+        column_state()
+            : candidates(all_candidates)
+            , values(0)
+            , nulls(0)
+            , finite(0) {}
+
+        unsigned candidates;
+        std::size_t values;
+        std::size_t nulls;
+        /// Number of fields converting to a finite double.
+        std::size_t finite;
+    };
+
+    column_state &state(std::size_t col) {
+        if (columns_.size() <= col)
+            columns_.resize(col + 1);
+        return columns_[col];
+    }
+
+private:
+    std::vector<column_state> columns_;
+    std::size_t rows_;
+};
+
+typedef basic_type_inference<char> type_inference;
+typedef basic_type_inference<wchar_t> wtype_inference;
+
+/// @brief Reads the header and up to <tt>sample_rows</tt> records from
+/// <tt>reader</tt> and infers their schema.
+///
+/// @details The sampled records are consumed; rewind the input before
+/// loading it with the returned schema.
+template <typename Char, typename Traits>
+basic_schema<Char, Traits> infer_schema(basic_batch_reader<Char, Traits> &reader,
+                                        std::size_t sample_rows = 1000);
+
+/// @brief Infers the schema of a CSV file with a header from its first
+/// <tt>sample_rows</tt> records.
+template <typename Char, typename Traits>
+basic_schema<Char, Traits> infer_schema(std::basic_istream<Char, Traits> &in,
+                                        std::size_t sample_rows = 1000) {
+    basic_batch_reader<Char, Traits> reader(in);
+    return infer_schema(reader, sample_rows);
+}
+
+// Implementation
+
+template <typename Char, typename Traits>
+void basic_type_inference<Char, Traits>::observe(std::size_t col,
+                                                 const field_type &f) {
+    column_state &s = state(col);
+    if (f.empty()) {
+        ++s.nulls;
+        return;
+    }
+    ++s.values;
+
+    const Char *const b = f.begin();
+    const Char *const e = f.end();
+    if (s.candidates & int64_candidate) {
+        int64_t v;
+        if (!convert<int64_t>::parse(b, e, v))
+            s.candidates &= ~unsigned(int64_candidate);
+    }
+    if (s.candidates & double_candidate) {
+        double v;
+        if (!convert<double>::parse(b, e, v))
+            s.candidates &= ~unsigned(double_candidate);
+        else if (v >= -std::numeric_limits<double>::max() &&
+                 v <= std::numeric_limits<double>::max())
+            ++s.finite;
+    }
+    if (s.candidates & bool_candidate) {
+        bool v;
+        if (!convert<bool>::parse(b, e, v))
+            s.candidates &= ~unsigned(bool_candidate);
+    }
+    if (s.candidates & timestamp_candidate) {
+        timestamp v;
+        if (!convert<timestamp>::parse(b, e, v))
+            s.candidates &= ~unsigned(timestamp_candidate);
+    }
+}
+
+template <typename Char, typename Traits>
+void basic_type_inference<Char, Traits>::observe(const batch_type &batch) {
+    for (std::size_t r = 0, n = batch.size(); r < n; ++r) {
+        const std::size_t fields = batch.field_count(r);
+        for (std::size_t c = 0; c < fields; ++c) {
+            observe(c, batch.field(r, c));
+        }
+        // Fields missing from short records count as nulls.
+        for (std::size_t c = fields; c < columns_.size(); ++c) {
+            ++columns_[c].nulls;
+        }
+    }
+    rows_ += batch.size();
+}
+
+template <typename Char, typename Traits>
+typename basic_type_inference<Char, Traits>::schema_type
+basic_type_inference<Char, Traits>::schema(const header_type &header) const {
+    schema_type result;
+    for (std::size_t i = 0, n = header.size(); i < n; ++i) {
+        const column_state s = i < columns_.size() ? columns_[i]
+                                                   : column_state();
+        column_type type = string_column;
+        if (s.values != 0) {
+            if (s.candidates & int64_candidate)
+                type = int64_column;
+            else if ((s.candidates & double_candidate) && s.finite != 0)
+                type = double_column;
+            else if (s.candidates & bool_candidate)
+                type = bool_column;
+            else if (s.candidates & timestamp_candidate)
+                type = timestamp_column;
+        }
+        // Records shorter than the header leave trailing columns unseen.
+        const bool nullable = s.nulls != 0 || s.values + s.nulls < rows_;
+        result.add(header.name_of(i), type, nullable);
+    }
+    return result;
+}
+
+template <typename Char, typename Traits>
+basic_schema<Char, Traits> infer_schema(basic_batch_reader<Char, Traits> &reader,
+                                        std::size_t sample_rows) {
+    const std::size_t saved_batch_size = reader.batch_size();
+    reader.read_header();
+
+    basic_type_inference<Char, Traits> inference;
+    basic_row_batch<Char, Traits> batch;
+    while (inference.rows() < sample_rows) {
+        const std::size_t left = sample_rows - inference.rows();
+        reader.batch_size(left < saved_batch_size ? left : saved_batch_size);
+        if (!reader.next(batch))
+            break;
+        inference.observe(batch);
+    }
+
+    reader.batch_size(saved_batch_size);
+    return inference.schema(reader.header());
+}
+} // namespace csv
+} // namespace text
+
+#endif
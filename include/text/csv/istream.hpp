@@ -7,6 +7,7 @@
 //          http://www.boost.org/LICENSE_1_0.txt)
 
 #include "stream_fwd.hpp"
+#include "convert.hpp"
 #include <istream>
 #include <string>
 #include <stdexcept>
@@ -79,6 +80,16 @@ public:
 
     basic_csv_istream &operator>>(double &d) { return read_raw(d); }
 
+    /// @brief Reads the next field and converts it with convert<T>.
+    template <typename T>
+    basic_csv_istream &read(T &dest) { return read_raw(dest); }
+
+    basic_csv_istream &read(string_type &dest) { return *this >> dest; }
+
+    /// @brief Skips the next field without storing it. The characters are
+    /// scanned straight from the stream buffer.
+    basic_csv_istream &skip_field();
+
     bool eof() { return is_eof(peek_char()); }
 
     bool good() const { return is_.good(); }
@@ -100,6 +111,7 @@ private:
     std::size_t line_;
     unsigned pos_;
     bool more_fields_;
+    string_type field_;
 
 private:
     basic_csv_istream(basic_csv_istream const &);
@@ -139,18 +151,74 @@ template <typename Char, typename Traits>
 template <typename T>
 basic_csv_istream<Char, Traits> &
 basic_csv_istream<Char, Traits>::read_raw(T &dest) {
-    const char_type c = peek_char();
-    if (c == quote_) {
-        skip_char();
-        is_ >> dest;
-        const char_type rest = get_char();
-        if (rest != quote_) {
-            unexpected(rest);
+    *this >> field_;
+    const char_type *const data = field_.data();
+    if (!convert<T>::parse(data, data + field_.size(), dest)) {
+        throw std::runtime_error("Invalid field value");
+    }
+    return *this;
+}
+
+template <typename Char, typename Traits>
+basic_csv_istream<Char, Traits> &basic_csv_istream<Char, Traits>::skip_field() {
+    typedef typename Traits::int_type int_type;
+    std::basic_streambuf<Char, Traits> *const sb = is_.rdbuf();
+    if (!is_ || !sb)
+        return *this;
+
+    const int_type eof = Traits::eof();
+    const char_type wcr = is_.widen(CR);
+    const char_type wlf = is_.widen(LF);
+
+    int_type c = sb->sbumpc();
+    ++pos_;
+    if (!Traits::eq_int_type(c, eof) && Traits::to_char_type(c) == quote_) {
+        // Stop after the closing quote, stepping over doubled quotes.
+        for (;;) {
+            c = sb->sbumpc();
+            ++pos_;
+            if (Traits::eq_int_type(c, eof)) {
+                is_.setstate(std::ios_base::eofbit | std::ios_base::failbit);
+                unexpected_eof();
+            }
+            if (Traits::to_char_type(c) != quote_)
+                continue;
+            c = sb->sbumpc();
+            ++pos_;
+            if (Traits::eq_int_type(c, eof) ||
+                Traits::to_char_type(c) != quote_)
+                break;
         }
     } else {
-        is_ >> dest;
+        while (!Traits::eq_int_type(c, eof)) {
+            const char_type ch = Traits::to_char_type(c);
+            if (ch == delim_ || ch == wcr || ch == wlf)
+                break;
+            c = sb->sbumpc();
+            ++pos_;
+        }
+    }
+
+    // Same endings as read_ending(), which get() would have seen.
+    if (Traits::eq_int_type(c, eof)) {
+        is_.setstate(std::ios_base::eofbit | std::ios_base::failbit);
+        more_fields_ = false;
+        return *this;
+    }
+    const char_type ch = Traits::to_char_type(c);
+    if (ch == delim_) {
+        more_fields_ = true;
+    } else if (ch == wcr) {
+        if (Traits::eq_int_type(sb->sgetc(), Traits::to_int_type(wlf))) {
+            sb->sbumpc();
+            ++pos_;
+        }
+        next_line();
+    } else if (ch == wlf) {
+        next_line();
+    } else {
+        unexpected(ch);
     }
-    read_ending(get_char());
     return *this;
 }
 
@@ -9,6 +9,7 @@
 #include "rows.hpp"
 #include <utility>
 #include <iterator>
+#include <stdexcept>
 
 namespace text {
 namespace csv {
@@ -89,6 +90,102 @@ private:
     ostream_type &is_;
 };
 
+/// @brief Input iterator over the values of one column in all remaining
+/// records of a stream.
+///
+/// @details The field in column <tt>col</tt> of each record is converted
+/// to <tt>ValueType</tt>; all other fields are skipped with
+/// basic_csv_istream::skip_field(), without being stored. A record without
+/// the column throws std::runtime_error.
+template <typename ValueType, typename Char = char,
+          typename Traits = std::char_traits<Char> >
+class column_scan_iterator {
+public:
+    typedef basic_csv_istream<Char, Traits> istream_type;
+    typedef ValueType value_type;
+    typedef std::input_iterator_tag iterator_category;
+    typedef const value_type &reference;
+    typedef const value_type *pointer;
+    typedef std::ptrdiff_t difference_type;
+
+    column_scan_iterator()
+        : is_(0)
+        , col_(0)
+        , value_() {}
+
+    column_scan_iterator(istream_type &is, std::size_t col)
+        : is_(&is)
+        , col_(col)
+        , value_() {
+        advance();
+    }
+
+    column_scan_iterator &operator++() {
+        advance();
+        return *this;
+    }
+
+    column_scan_iterator operator++(int) {
+        column_scan_iterator tmp = *this;
+        advance();
+        return tmp;
+    }
+
+    bool operator==(const column_scan_iterator &rhs) const {
+        return is_ == rhs.is_;
+    }
+
+    bool operator!=(const column_scan_iterator &rhs) const {
+        return is_ != rhs.is_;
+    }
+
+    reference operator*() const { return value_; }
+
+    pointer operator->() const { return &value_; }
+
+    std::size_t column() const { return col_; }
+
+private:
+    void advance();
+
+private:
+    istream_type *is_;
+    std::size_t col_;
+    ValueType value_;
+};
+
+/// @brief Reads the header from <tt>is</tt> and returns an iterator over
+/// the column named <tt>name</tt>; throws std::out_of_range if there is
+/// no such column.
+template <typename ValueType, typename Char, typename Traits>
+column_scan_iterator<ValueType, Char, Traits>
+column_begin(basic_csv_istream<Char, Traits> &is, const Char *name) {
+    const basic_header<Char, Traits> header(is);
+    const std::size_t col = header.index_of(name);
+    if (col == basic_header<Char, Traits>::npos) {
+        throw std::out_of_range("Unknown column");
+    }
+    return column_scan_iterator<ValueType, Char, Traits>(is, col);
+}
+
+/// @brief Returns an iterator over column <tt>col</tt> of the records of
+/// <tt>is</tt>.
+template <typename ValueType, typename Char, typename Traits>
+column_scan_iterator<ValueType, Char, Traits>
+column_begin(basic_csv_istream<Char, Traits> &is, std::size_t col) {
+    return column_scan_iterator<ValueType, Char, Traits>(is, col);
+}
+
+template <typename ValueType, typename Char>
+column_scan_iterator<ValueType, Char> column_end() {
+    return column_scan_iterator<ValueType, Char>();
+}
+
+template <typename ValueType>
+column_scan_iterator<ValueType> column_end() {
+    return column_scan_iterator<ValueType>();
+}
+
 template <typename RangeType, typename RowType>
 class input_row_iterator {
 public:
@@ -300,7 +397,7 @@ void input_column_iterator<ValueType, Char, Traits>::advance() {
     }
 
     if (is_) {
-        *is_ >> value_;
+        is_->read(value_);
         if (!is_->has_more_fields()) {
             pending_end_ = true;
         }
@@ -315,6 +412,25 @@ bool input_column_iterator<ValueType, Char, Traits>::equals(
     return is_ == rhs.is_ && value_ == rhs.value_;
 }
 
+template <typename ValueType, typename Char, typename Traits>
+void column_scan_iterator<ValueType, Char, Traits>::advance() {
+    if (!is_)
+        return;
+    if (!*is_) {
+        is_ = 0;
+        return;
+    }
+    for (std::size_t i = 0; i < col_; ++i) {
+        is_->skip_field();
+        if (!is_->has_more_fields()) {
+            throw std::runtime_error("Missing value in column");
+        }
+    }
+    is_->read(value_);
+    while (is_->has_more_fields())
+        is_->skip_field();
+}
+
 template <typename MapRow>
 zipping_iterator<MapRow>::zipping_iterator(const MapRow &row, std::size_t pos)
     : row_(&row)
@@ -0,0 +1,353 @@
+#ifndef TEXT_CSV_JOIN_HPP
+#define TEXT_CSV_JOIN_HPP
+
+//          Copyright Roman Kashitsyn 2014 - 2015.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "batch.hpp"
+#include "hash.hpp"
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace text {
+namespace csv {
+
+enum join_kind {
+    /// Emits probe records that have at least one match
+    inner_join,
+    /// Emits every probe record; unmatched ones get empty payload fields
+    left_join
+};
+
+/// @brief Hash join of two CSV sources on key columns.
+///
+/// @details The build side (usually the smaller input) is read once
+/// with build(): its key and payload fields are copied back to back
+/// into a single character buffer and indexed by an open-addressing
+/// hash table over the raw key characters. The probe side is then
+/// streamed batch by batch with probe(); nothing of it is retained.
+///
+/// Joined records consist of all fields of the probe record followed
+/// by the payload fields of the matching build record. Records whose
+/// keys match several build records are emitted once per match, in
+/// build order.
+template <typename Char, typename Traits = std::char_traits<Char> >
+class basic_hash_join {
+public:
+    typedef Char char_type;
+    typedef std::basic_string<Char, Traits> string_type;
+    typedef basic_field_view<Char, Traits> field_type;
+    typedef basic_row_batch<Char, Traits> batch_type;
+    typedef basic_batch_reader<Char, Traits> reader_type;
+    typedef basic_csv_ostream<Char, Traits> ostream_type;
+
+    static const std::size_t npos;
+
+    explicit basic_hash_join(join_kind kind = inner_join)
+        : kind_(kind)
+        , records_(0) {
+        slots_.assign(16, npos);
+    }
+
+    /// @brief Joins build column <tt>build_col</tt> with probe column
+    /// <tt>probe_col</tt>. Call once per key column.
+    void on(std::size_t build_col, std::size_t probe_col) {
+        build_keys_.push_back(build_col);
+        probe_keys_.push_back(probe_col);
+    }
+
+    /// @brief Adds a build column to the joined records. By default all
+    /// build columns that are not keys are added.
+    void payload(std::size_t build_col) { payload_.push_back(build_col); }
+
+    /// @brief Reads all remaining records of <tt>reader</tt> into the
+    /// hash table.
+    void build(reader_type &reader);
+
+    /// @brief Returns number of build records.
+    std::size_t size() const { return records_; }
+
+    /// @brief Returns number of payload fields per build record.
+    std::size_t payload_size() const { return payload_.size(); }
+
+    /// @brief Returns payload field <tt>i</tt> of build record
+    /// <tt>record</tt>.
+    field_type payload_field(std::size_t record, std::size_t i) const {
+        return field(record * width() + build_keys_.size() + i);
+    }
+
+    /// @brief Returns the first build record matching row <tt>row</tt>
+    /// of the probe batch, or npos.
+    std::size_t find(const batch_type &batch, std::size_t row) const;
+
+    /// @brief Returns the next build record with the same key as
+    /// <tt>record</tt>, or npos.
+    std::size_t next(std::size_t record) const { return next_[record]; }
+
+    /// @brief Streams <tt>reader</tt> through the table and calls
+    /// <tt>fn(batch, row, record)</tt> for each joined record. For left
+    /// joins unmatched probe records are reported with record == npos.
+    template <typename F>
+    void probe(reader_type &reader, F fn) const;
+
+    /// @brief Streams <tt>reader</tt> through the table and writes the
+    /// joined records to <tt>out</tt>. If the probe reader has read a
+    /// header, a joined header is written first; payload columns get
+    /// empty names unless the build reader has read a header too.
+    /// Records shorter than the probe header are padded with empty
+    /// fields so that the payload stays under its names.
+    void probe(reader_type &reader, ostream_type &out) const;
+
+private:
+    std::size_t width() const { return build_keys_.size() + payload_.size(); }
+
+    field_type field(std::size_t i) const {
+        const char_type *const base = chars_.empty() ? 0 : &chars_[0];
+        return field_type(base + (i == 0 ? 0 : ends_[i - 1]),
+                          base + ends_[i]);
+    }
+
+    uint64_t probe_hash(const batch_type &batch, std::size_t row) const;
+    bool key_equals(std::size_t record, const batch_type &batch,
+                    std::size_t row) const;
+    void grow();
+
+    struct writer {
+        writer(const basic_hash_join &j, ostream_type &o, std::size_t w)
+            : join(&j)
+            , out(&o)
+            , width(w) {}
+
+        void operator()(const batch_type &batch, std::size_t row,
+                        std::size_t record) const;
+
+        const basic_hash_join *join;
+        ostream_type *out;
+        std::size_t width;
+    };
+
+private:
+    join_kind kind_;
+    std::vector<std::size_t> build_keys_;
+    std::vector<std::size_t> probe_keys_;
+    std::vector<std::size_t> payload_;
+    std::vector<string_type> payload_names_;
+
+    std::vector<char_type> chars_;
+    std::vector<std::size_t> ends_;
+    std::vector<uint64_t> hashes_;
+    std::vector<std::size_t> next_;
+    std::vector<std::size_t> tails_;
+    std::vector<std::size_t> slots_;
+    std::size_t records_;
+};
+
+typedef basic_hash_join<char> hash_join;
+typedef basic_hash_join<wchar_t> whash_join;
+
+// Implementation
+
+template <typename Char, typename Traits>
+const std::size_t basic_hash_join<Char, Traits>::npos =
+    static_cast<std::size_t>(-1);
+
+template <typename Char, typename Traits>
+void basic_hash_join<Char, Traits>::build(reader_type &reader) {
+    if (build_keys_.empty()) {
+        throw std::logic_error("No join keys");
+    }
+
+    batch_type batch;
+    bool first = true;
+    while (reader.next(batch)) {
+        if (first && payload_.empty()) {
+            const std::size_t n = reader.header().size()
+                                      ? reader.header().size()
+                                      : batch.field_count(0);
+            for (std::size_t c = 0; c < n; ++c) {
+                bool is_key = false;
+                for (std::size_t k = 0; k < build_keys_.size(); ++k)
+                    is_key = is_key || build_keys_[k] == c;
+                if (!is_key)
+                    payload_.push_back(c);
+            }
+        }
+        if (first && reader.header().size()) {
+            for (std::size_t i = 0; i < payload_.size(); ++i) {
+                payload_names_.push_back(
+                    payload_[i] < reader.header().size()
+                        ? reader.header().name_of(payload_[i])
+                        : string_type());
+            }
+        }
+        first = false;
+
+        for (std::size_t r = 0, n = batch.size(); r < n; ++r) {
+            const std::size_t fields = batch.field_count(r);
+            uint64_t h = 0;
+            for (std::size_t k = 0; k < build_keys_.size(); ++k) {
+                const field_type f = build_keys_[k] < fields
+                                         ? batch.field(r, build_keys_[k])
+                                         : field_type();
+                h = hash_combine(h, hash_field(f.begin(), f.end()));
+                chars_.insert(chars_.end(), f.begin(), f.end());
+                ends_.push_back(chars_.size());
+            }
+            for (std::size_t p = 0; p < payload_.size(); ++p) {
+                const field_type f = payload_[p] < fields
+                                         ? batch.field(r, payload_[p])
+                                         : field_type();
+                chars_.insert(chars_.end(), f.begin(), f.end());
+                ends_.push_back(chars_.size());
+            }
+
+            const std::size_t rec = records_++;
+            hashes_.push_back(h);
+            next_.push_back(npos);
+            tails_.push_back(rec);
+
+            // Look for an earlier record with the same key.
+            const std::size_t mask = slots_.size() - 1;
+            std::size_t i = std::size_t(h) & mask;
+            bool found = false;
+            for (; slots_[i] != npos; i = (i + 1) & mask) {
+                const std::size_t head = slots_[i];
+                if (hashes_[head] != h)
+                    continue;
+                bool same = true;
+                for (std::size_t k = 0; same && k < build_keys_.size(); ++k)
+                    same = field(head * width() + k) ==
+                           field(rec * width() + k);
+                if (same) {
+                    next_[tails_[head]] = rec;
+                    tails_[head] = rec;
+                    found = true;
+                    break;
+                }
+            }
+            if (!found) {
+                slots_[i] = rec;
+                if (2 * records_ > slots_.size())
+                    grow();
+            }
+        }
+    }
+}
+
+template <typename Char, typename Traits>
+void basic_hash_join<Char, Traits>::grow() {
+    std::vector<std::size_t> old(slots_.size() * 2, npos);
+    old.swap(slots_);
+    const std::size_t mask = slots_.size() - 1;
+    for (std::size_t s = 0; s < old.size(); ++s) {
+        if (old[s] == npos)
+            continue;
+        std::size_t i = std::size_t(hashes_[old[s]]) & mask;
+        while (slots_[i] != npos)
+            i = (i + 1) & mask;
+        slots_[i] = old[s];
+    }
+}
+
+template <typename Char, typename Traits>
+uint64_t basic_hash_join<Char, Traits>::probe_hash(const batch_type &batch,
+                                                   std::size_t row) const {
+    const std::size_t fields = batch.field_count(row);
+    uint64_t h = 0;
+    for (std::size_t k = 0; k < probe_keys_.size(); ++k) {
+        const field_type f = probe_keys_[k] < fields
+                                 ? batch.field(row, probe_keys_[k])
+                                 : field_type();
+        h = hash_combine(h, hash_field(f.begin(), f.end()));
+    }
+    return h;
+}
+
+template <typename Char, typename Traits>
+bool basic_hash_join<Char, Traits>::key_equals(std::size_t record,
+                                               const batch_type &batch,
+                                               std::size_t row) const {
+    const std::size_t fields = batch.field_count(row);
+    for (std::size_t k = 0; k < probe_keys_.size(); ++k) {
+        const field_type f = probe_keys_[k] < fields
+                                 ? batch.field(row, probe_keys_[k])
+                                 : field_type();
+        if (field(record * width() + k) != f)
+            return false;
+    }
+    return true;
+}
+
+template <typename Char, typename Traits>
+std::size_t basic_hash_join<Char, Traits>::find(const batch_type &batch,
+                                                std::size_t row) const {
+    const uint64_t h = probe_hash(batch, row);
+    const std::size_t mask = slots_.size() - 1;
+    for (std::size_t i = std::size_t(h) & mask; slots_[i] != npos;
+         i = (i + 1) & mask) {
+        const std::size_t head = slots_[i];
+        if (hashes_[head] == h && key_equals(head, batch, row))
+            return head;
+    }
+    return npos;
+}
+
+template <typename Char, typename Traits>
+template <typename F>
+void basic_hash_join<Char, Traits>::probe(reader_type &reader, F fn) const {
+    batch_type batch;
+    while (reader.next(batch)) {
+        for (std::size_t r = 0, n = batch.size(); r < n; ++r) {
+            std::size_t rec = find(batch, r);
+            if (rec == npos && kind_ == left_join) {
+                fn(batch, r, npos);
+            }
+            for (; rec != npos; rec = next_[rec]) {
+                fn(batch, r, rec);
+            }
+        }
+    }
+}
+
+template <typename Char, typename Traits>
+void basic_hash_join<Char, Traits>::writer::
+operator()(const batch_type &batch, std::size_t row,
+           std::size_t record) const {
+    const std::size_t n = batch.field_count(row);
+    for (std::size_t c = 0; c < n; ++c) {
+        *out << batch.field(row, c);
+    }
+    for (std::size_t c = n; c < width; ++c) {
+        *out << field_type();
+    }
+    for (std::size_t p = 0; p < join->payload_size(); ++p) {
+        *out << (record == npos ? field_type()
+                                : join->payload_field(record, p));
+    }
+    out->end_line();
+}
+
+template <typename Char, typename Traits>
+void basic_hash_join<Char, Traits>::probe(reader_type &reader,
+                                          ostream_type &out) const {
+    const basic_header<Char, Traits> &h = reader.header();
+    if (h.size()) {
+        for (std::size_t i = 0; i < h.size(); ++i) {
+            out << h.name_of(i);
+        }
+        for (std::size_t i = 0; i < payload_.size(); ++i) {
+            out << (i < payload_names_.size() ? payload_names_[i]
+                                              : string_type());
+        }
+        out.end_line();
+    }
+    probe(reader, writer(*this, out, h.size()));
+}
+} // namespace csv
+} // namespace text
+
+#endif
@@ -6,15 +6,63 @@
 //    (See accompanying file LICENSE_1_0.txt or copy at
 //          http://www.boost.org/LICENSE_1_0.txt)
 
+#include "format.hpp"
+#include "scan.hpp"
 #include "stream_fwd.hpp"
 #include <algorithm>
+#include <locale>
 #include <ostream>
 #include <string>
 #include <sstream>
 
 namespace text {
 namespace csv {
+namespace detail {
 
+template <typename Char, typename Traits>
+struct record_writer;
+} // namespace detail
+
+/// @brief How basic_csv_ostream writes numbers.
+enum number_format {
+    /// Decimal integers and shortest round-trip floating point values,
+    /// independent of the stream's locale and precision
+    shortest_format,
+    /// Whatever the stream's operator<< produces
+    stream_format
+};
+
+/// @brief Which fields basic_csv_ostream encloses in quotes.
+enum quote_style {
+    /// Only fields containing the delimiter, the quote or a line break
+    quote_minimal,
+    /// Every field, including numbers
+    quote_all,
+    /// Every field except numbers
+    quote_non_numeric,
+    /// No field; the caller guarantees that fields contain no special
+    /// symbols, and they are written unchecked
+    quote_none
+};
+
+/// @brief CSV writer on top of a std::basic_ostream.
+///
+/// @details Fields are formatted into an internal buffer that is handed
+/// to the stream buffer with a single sputn() call, bypassing per-
+/// character stream operations. By default the buffer is committed after
+/// every field, so the underlying stream is always up to date. With a
+/// non-zero buffer_size() whole records are collected and committed in
+/// blocks of at least that many characters; call flush() (or destroy the
+/// writer) to commit the rest.
+///
+/// Numbers are written in shortest_format unless the stream's locale
+/// groups digits or uses a decimal comma, or the stream has base, sign,
+/// notation or width flags set; stream precision is only honoured in
+/// stream_format, which can be selected with format().
+///
+/// Fields are quoted as selected with quoting(). Only quote_minimal
+/// scans every field for special symbols; in the other modes text is
+/// at most searched for quotes to double.
 template <typename Char, typename Traits>
 class basic_csv_ostream {
 public:
@@ -30,12 +78,27 @@ public:
 
     basic_csv_ostream(stream_type &os, char_type delimiter, char_type quote);
 
+    /// @brief Commits buffered records, ignoring errors.
+    ~basic_csv_ostream();
+
     basic_csv_ostream &operator<<(bool b) { return insert(b); }
 
     basic_csv_ostream &operator<<(int i) { return insert(i); }
 
     basic_csv_ostream &operator<<(long l) { return insert(l); }
 
+    basic_csv_ostream &operator<<(unsigned u) { return insert(u); }
+
+    basic_csv_ostream &operator<<(unsigned long ul) { return insert(ul); }
+
+#if __cplusplus >= 201103
+    basic_csv_ostream &operator<<(long long ll) { return insert(ll); }
+
+    basic_csv_ostream &operator<<(unsigned long long ull) {
+        return insert(ull);
+    }
+#endif
+
     basic_csv_ostream &operator<<(float f) { return insert(f); }
 
     basic_csv_ostream &operator<<(double d) { return insert(d); }
@@ -48,15 +111,43 @@ public:
 
     basic_csv_ostream &operator<<(manip m) { return m(*this); }
 
+    /// @brief Writes the characters [begin, end) as a single field.
+    basic_csv_ostream &write(char_type const *begin, char_type const *end) {
+        return insert(begin, end);
+    }
+
     basic_csv_ostream &end_line();
 
+    /// @brief Commits buffered characters and flushes the stream.
+    basic_csv_ostream &flush();
+
+    number_format format() const { return format_; }
+
+    void format(number_format f) { format_ = f; }
+
+    quote_style quoting() const { return quoting_; }
+
+    void quoting(quote_style q) { quoting_ = q; }
+
+    std::size_t buffer_size() const { return buffer_size_; }
+
+    /// @brief Sets the number of characters collected before they are
+    /// committed to the stream; zero commits every field.
+    void buffer_size(std::size_t n) {
+        buffer_size_ = n;
+        buf_.reserve(n);
+        commit_if_full();
+    }
+
 private:
+    friend struct detail::record_writer<Char, Traits>;
+
     basic_csv_ostream(basic_csv_ostream const &);
     basic_csv_ostream &operator=(basic_csv_ostream const &);
 
     void insert_delimiter() {
         if (!first_) {
-            os_.put(delim_);
+            buf_.push_back(delim_);
         } else {
             first_ = false;
         }
@@ -66,19 +157,118 @@ private:
 
     template <typename T>
     basic_csv_ostream &insert(T const &t) {
+        insert_delimiter();
+        append_number(t);
+        if (buffer_size_ == 0)
+            commit();
+        return *this;
+    }
+
+    /// Appends the text field [begin, end), quoted as selected.
+    void append_field(char_type const *begin, char_type const *end) {
+        if (quoting_ == quote_minimal) {
+            append_minimal(begin, end);
+        } else if (quoting_ == quote_none) {
+            buf_.append(begin, end);
+        } else {
+            append_quoted(begin, end);
+        }
+    }
+
+    /// Appends the formatted number [begin, end), quoted as selected.
+    void append_numeric(char_type const *begin, char_type const *end) {
+        if (quoting_ == quote_all) {
+            append_quoted(begin, end);
+        } else if (quoting_ == quote_none) {
+            buf_.append(begin, end);
+        } else {
+            append_minimal(begin, end);
+        }
+    }
+
+    /// Appends [begin, end), quoted if it contains special symbols.
+    void append_minimal(char_type const *begin, char_type const *end);
+
+    /// Appends [begin, end) in quotes, doubling the quotes within.
+    void append_quoted(char_type const *begin, char_type const *end);
+
+    template <typename T>
+    void append_number(T const &t) {
+        if (format_ == stream_format || !plain_flags())
+            return append_formatted(t);
+
+        char digits[detail::max_number_chars];
+        char const *const begin = digits;
+        char const *const end = detail::format_number(t, digits);
+        if (!plain_numbers_) {
+            const string_type s(begin, end);
+            return append_numeric(s.data(), s.data() + s.size());
+        }
+        if (quoting_ == quote_all) {
+            buf_.push_back(quote_);
+            buf_.append(begin, end);
+            buf_.push_back(quote_);
+        } else {
+            buf_.append(begin, end);
+        }
+    }
+
+    template <typename T>
+    void append_formatted(T const &t) {
         std::basic_ostringstream<Char, Traits> buf;
         buf.copyfmt(os_);
         buf << t;
-        return (*this) << buf.str();
+        const string_type s = buf.str();
+        append_numeric(s.data(), s.data() + s.size());
+    }
+
+    bool plain_flags() const {
+        const std::ios_base::fmtflags special =
+            std::ios_base::oct | std::ios_base::hex |
+            std::ios_base::floatfield | std::ios_base::showbase |
+            std::ios_base::showpoint | std::ios_base::showpos |
+            std::ios_base::uppercase | std::ios_base::boolalpha;
+        return !(os_.flags() & special) && os_.width() == 0;
+    }
+
+    static number_format default_format(stream_type &os);
+
+    /// True if delimiter and quote cannot occur in formatted numbers.
+    bool numbers_are_plain() const {
+        const char symbols[] = "+-.0123456789aefinAEFIN";
+        for (const char *p = symbols; *p; ++p) {
+            if (delim_ == char_type(*p) || quote_ == char_type(*p))
+                return false;
+        }
+        return true;
+    }
+
+    void commit_if_full() {
+        if (buf_.size() >= buffer_size_)
+            commit();
     }
 
+    void commit();
+
 private:
     stream_type &os_;
     char_type const delim_;
     char_type const quote_;
+    char_type const cr_;
+    char_type const lf_;
     bool first_;
+    std::size_t buffer_size_;
+    string_type buf_;
+    number_format format_;
+    quote_style quoting_;
+    bool const plain_numbers_;
 };
 
+template <typename Char, typename Traits>
+basic_csv_ostream<Char, Traits> &flush(basic_csv_ostream<Char, Traits> &cos) {
+    return cos.flush();
+}
+
 // Implementation
 // --------------
 
@@ -88,7 +278,13 @@ basic_csv_ostream<Char, Traits>::basic_csv_ostream
     : os_(os)
     , delim_(os.widen(COMMA))
     , quote_(os.widen(QUOTE))
+    , cr_(os.widen(CR))
+    , lf_(os.widen(LF))
     , first_(true)
+    , buffer_size_(0)
+    , format_(default_format(os))
+    , quoting_(quote_minimal)
+    , plain_numbers_(numbers_are_plain())
 {}
 
 template <typename Char, typename Traits>
@@ -97,7 +293,13 @@ basic_csv_ostream<Char, Traits>::basic_csv_ostream
     : os_(os)
     , delim_(delimiter)
     , quote_(os.widen(QUOTE))
+    , cr_(os.widen(CR))
+    , lf_(os.widen(LF))
     , first_(true)
+    , buffer_size_(0)
+    , format_(default_format(os))
+    , quoting_(quote_minimal)
+    , plain_numbers_(numbers_are_plain())
 {}
 
 template <typename Char, typename Traits>
@@ -108,9 +310,35 @@ basic_csv_ostream<Char, Traits>::basic_csv_ostream
     : os_(os)
     , delim_(delimiter)
     , quote_(quote)
+    , cr_(os.widen(CR))
+    , lf_(os.widen(LF))
     , first_(true)
+    , buffer_size_(0)
+    , format_(default_format(os))
+    , quoting_(quote_minimal)
+    , plain_numbers_(numbers_are_plain())
 {}
 
+template <typename Char, typename Traits>
+number_format basic_csv_ostream<Char, Traits>::default_format(stream_type &os) {
+    typedef std::numpunct<Char> numpunct_type;
+    const std::locale loc = os.getloc();
+    if (!std::has_facet<numpunct_type>(loc))
+        return stream_format;
+    const numpunct_type &np = std::use_facet<numpunct_type>(loc);
+    const bool plain =
+        np.grouping().empty() && np.decimal_point() == os.widen('.');
+    return plain ? shortest_format : stream_format;
+}
+
+template <typename Char, typename Traits>
+basic_csv_ostream<Char, Traits>::~basic_csv_ostream() {
+    try {
+        commit();
+    } catch (...) {
+    }
+}
+
 template <typename Char, typename Traits>
 basic_csv_ostream<Char, Traits> &basic_csv_ostream<Char, Traits>::operator<<(
     char_type const *c) {
@@ -128,13 +356,35 @@ basic_csv_ostream<Char, Traits> &basic_csv_ostream<Char, Traits>::operator<<(
 
 template <typename Char, typename Traits>
 basic_csv_ostream<Char, Traits> &basic_csv_ostream<Char, Traits>::end_line() {
-    os_.put(os_.widen(CR));
-    os_.put(os_.widen(LF));
+    buf_.push_back(cr_);
+    buf_.push_back(lf_);
     first_ = true;
+    commit_if_full();
 
     return *this;
 }
 
+template <typename Char, typename Traits>
+basic_csv_ostream<Char, Traits> &basic_csv_ostream<Char, Traits>::flush() {
+    commit();
+    os_.flush();
+    return *this;
+}
+
+template <typename Char, typename Traits>
+void basic_csv_ostream<Char, Traits>::commit() {
+    if (buf_.empty())
+        return;
+    const std::streamsize n = std::streamsize(buf_.size());
+    if (os_.good()) {
+        std::basic_streambuf<Char, Traits> *const sb = os_.rdbuf();
+        if (!sb || sb->sputn(buf_.data(), n) != n) {
+            os_.setstate(std::ios_base::badbit);
+        }
+    }
+    buf_.clear();
+}
+
 template <typename Char, typename Traits>
 basic_csv_ostream<Char, Traits> &endl(basic_csv_ostream<Char, Traits> &cos) {
     return cos.end_line();
@@ -145,30 +395,42 @@ basic_csv_ostream<Char, Traits> &
 basic_csv_ostream<Char, Traits>::insert(char_type const *begin,
                                         char_type const *end) {
     insert_delimiter();
+    append_field(begin, end);
+    if (buffer_size_ == 0)
+        commit();
+    return *this;
+}
 
-    const char_type special_symbols[] = {
-        delim_, quote_, os_.widen(CR), os_.widen(LF),
-    };
-    const char_type *const special_symbols_end =
-        special_symbols + sizeof(special_symbols) / sizeof(special_symbols[0]);
-
-    const bool has_special_symbols =
-        std::find_first_of(begin, end, special_symbols, special_symbols_end) !=
-        end;
+template <typename Char, typename Traits>
+void basic_csv_ostream<Char, Traits>::append_minimal(char_type const *begin,
+                                                     char_type const *end) {
+    const char_type *const special =
+        detail::find_special(begin, end, delim_, quote_, cr_, lf_);
 
-    if (!has_special_symbols) {
-        os_.write(begin, std::streamsize(end - begin));
+    if (special == end) {
+        buf_.append(begin, end);
     } else {
-        os_.put(quote_);
-        for (char_type const *pos = begin; pos != end; ++pos) {
-            if (*pos == quote_) {
-                os_.put(quote_);
-            }
-            os_.put(*pos);
+        append_quoted(begin, end);
+    }
+}
+
+template <typename Char, typename Traits>
+void basic_csv_ostream<Char, Traits>::append_quoted(char_type const *begin,
+                                                    char_type const *end) {
+    buf_.push_back(quote_);
+    // Copy runs between quotes, doubling each quote.
+    for (char_type const *pos = begin;;) {
+        char_type const *const q =
+            traits_type::find(pos, std::size_t(end - pos), quote_);
+        if (!q) {
+            buf_.append(pos, end);
+            break;
         }
-        os_.put(quote_);
+        buf_.append(pos, q + 1);
+        buf_.push_back(quote_);
+        pos = q + 1;
     }
-    return *this;
+    buf_.push_back(quote_);
 }
 } // namespace csv
 } // namespace text
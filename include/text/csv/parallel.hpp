@@ -0,0 +1,293 @@
+#ifndef TEXT_CSV_PARALLEL_HPP
+#define TEXT_CSV_PARALLEL_HPP
+
+//          Copyright Roman Kashitsyn 2014 - 2015.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// Multi-threaded processing of record batches and indexed files.
+// Requires C++11.
+
+#if __cplusplus >= 201103
+
+#include "batch.hpp"
+#include "indexed.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace text {
+namespace csv {
+
+/// @brief Reads batches from <tt>reader</tt> on the calling thread and
+/// hands them to <tt>threads</tt> workers.
+///
+/// @details <tt>fn(worker, batch)</tt> is called on worker threads with
+/// the zero-based worker index, so per-worker state can be kept in an
+/// array without locking. Batches are recycled: at most two per worker
+/// are in memory at a time. The first exception thrown by <tt>fn</tt>
+/// or by the reader stops processing and is rethrown to the caller.
+template <typename Char, typename Traits, typename F>
+void parallel_for_each_batch(basic_batch_reader<Char, Traits> &reader,
+                             unsigned threads, F fn) {
+    typedef basic_row_batch<Char, Traits> batch_type;
+
+    if (threads < 2) {
+        batch_type batch;
+        while (reader.next(batch))
+            fn(0u, const_cast<const batch_type &>(batch));
+        return;
+    }
+
+    std::vector<batch_type> storage(2 * threads);
+    std::deque<batch_type *> free_list, work;
+    for (batch_type &b : storage)
+        free_list.push_back(&b);
+
+    std::mutex m;
+    std::condition_variable cv;
+    bool done = false;
+    std::exception_ptr error;
+
+    auto worker = [&](unsigned id) {
+        for (;;) {
+            batch_type *b;
+            {
+                std::unique_lock<std::mutex> lock(m);
+                cv.wait(lock, [&] { return !work.empty() || done; });
+                if (work.empty())
+                    return;
+                b = work.front();
+                work.pop_front();
+            }
+            try {
+                fn(id, const_cast<const batch_type &>(*b));
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(m);
+                if (!error)
+                    error = std::current_exception();
+                done = true;
+                work.clear();
+                cv.notify_all();
+                return;
+            }
+            {
+                std::lock_guard<std::mutex> lock(m);
+                free_list.push_back(b);
+            }
+            cv.notify_all();
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned i = 0; i < threads; ++i)
+        pool.emplace_back(worker, i);
+
+    try {
+        for (;;) {
+            batch_type *b;
+            {
+                std::unique_lock<std::mutex> lock(m);
+                cv.wait(lock, [&] { return !free_list.empty() || done; });
+                if (done)
+                    break;
+                b = free_list.front();
+                free_list.pop_front();
+            }
+            if (!reader.next(*b))
+                break;
+            {
+                std::lock_guard<std::mutex> lock(m);
+                work.push_back(b);
+            }
+            cv.notify_all();
+        }
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(m);
+        if (!error)
+            error = std::current_exception();
+        work.clear();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m);
+        done = true;
+    }
+    cv.notify_all();
+    for (std::thread &t : pool)
+        t.join();
+
+    if (error)
+        std::rethrow_exception(error);
+}
+
+namespace detail {
+
+/// Split of n records into chunks of consecutive records.
+struct chunk_plan {
+    std::size_t records;
+    std::size_t size;
+    std::size_t count;
+
+    chunk_plan(std::size_t n, unsigned threads)
+        : records(n)
+        // Enough chunks per thread for stealing to even out slow ones.
+        , size(std::max<std::size_t>(1, n / (std::size_t(threads) * 16)))
+        , count((n + size - 1) / size) {}
+
+    std::size_t begin(std::size_t chunk) const { return chunk * size; }
+
+    std::size_t end(std::size_t chunk) const {
+        return std::min(records, (chunk + 1) * size);
+    }
+};
+
+/// Chunks assigned to one worker. The owner takes them from the front,
+/// idle workers steal from the back.
+struct chunk_queue {
+    std::mutex m;
+    std::deque<std::size_t> chunks;
+};
+
+inline bool take_chunk(chunk_queue *queues, unsigned threads, unsigned id,
+                       std::size_t &chunk) {
+    for (unsigned i = 0; i < threads; ++i) {
+        chunk_queue &q = queues[(id + i) % threads];
+        std::lock_guard<std::mutex> lock(q.m);
+        if (q.chunks.empty())
+            continue;
+        if (i == 0) {
+            chunk = q.chunks.front();
+            q.chunks.pop_front();
+        } else {
+            chunk = q.chunks.back();
+            q.chunks.pop_back();
+        }
+        return true;
+    }
+    return false;
+}
+
+/// Calls <tt>fn(worker, chunk)</tt> for every chunk of <tt>plan</tt> on
+/// <tt>threads</tt> work-stealing workers, or on the calling thread if
+/// <tt>threads</tt> is less than 2. Rethrows the first exception.
+template <typename F>
+void for_each_chunk(const chunk_plan &plan, unsigned threads, F fn) {
+    threads = std::max(threads, 1u);
+    std::unique_ptr<chunk_queue[]> queues(new chunk_queue[threads]);
+    // Contiguous runs of chunks per worker keep its reads sequential
+    // until it has to steal.
+    for (std::size_t c = 0; c < plan.count; ++c)
+        queues[c * threads / plan.count].chunks.push_back(c);
+
+    std::atomic<bool> stop(false);
+    std::mutex m;
+    std::exception_ptr error;
+
+    auto worker = [&](unsigned id) {
+        std::size_t c;
+        while (!stop.load(std::memory_order_relaxed) &&
+               take_chunk(queues.get(), threads, id, c)) {
+            try {
+                fn(id, c);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(m);
+                if (!error)
+                    error = std::current_exception();
+                stop = true;
+                return;
+            }
+        }
+    };
+
+    if (threads == 1) {
+        worker(0);
+    } else {
+        std::vector<std::thread> pool;
+        for (unsigned i = 0; i < threads; ++i)
+            pool.emplace_back(worker, i);
+        for (std::thread &t : pool)
+            t.join();
+    }
+
+    if (error)
+        std::rethrow_exception(error);
+}
+} // namespace detail
+
+/// @brief Calls <tt>fn(worker, row)</tt> for every record of
+/// <tt>file</tt> on <tt>threads</tt> worker threads.
+///
+/// @details Records are split into chunks at the boundaries found by
+/// the file's index, so every call sees exactly the row a serial
+/// basic_row_range loop would. Idle workers steal chunks from busy
+/// ones. Each worker parses into its own row, which is reused for all
+/// of its records; <tt>worker</tt> is its zero-based index. With fewer
+/// than 2 threads everything runs on the calling thread. The first
+/// exception thrown by <tt>fn</tt> stops processing and is rethrown.
+template <typename Char, typename Traits, typename F>
+void parallel_for_each(const basic_indexed_file<Char, Traits> &file,
+                       unsigned threads, F fn) {
+    typedef typename basic_indexed_file<Char, Traits>::row_type row_type;
+
+    const detail::chunk_plan plan(file.size(), std::max(threads, 1u));
+    std::vector<row_type> rows(std::max(threads, 1u));
+    detail::for_each_chunk(plan, threads, [&](unsigned id, std::size_t c) {
+        row_type &row = rows[id];
+        for (std::size_t k = plan.begin(c), e = plan.end(c); k < e; ++k) {
+            file.read(k, row);
+            fn(id, const_cast<const row_type &>(row));
+        }
+    });
+}
+
+/// @brief Reduces <tt>transform(row)</tt> over all records of
+/// <tt>file</tt> with <tt>reduce</tt>, starting from <tt>init</tt>.
+///
+/// @details Chunks are reduced in parallel as in parallel_for_each()
+/// and their results are then combined in file order, so the result
+/// equals that of a serial left fold whenever <tt>reduce</tt> is
+/// associative; it need not be commutative.
+template <typename Char, typename Traits, typename T, typename Reduce,
+          typename Transform>
+T parallel_transform_reduce(const basic_indexed_file<Char, Traits> &file,
+                            unsigned threads, T init, Reduce reduce,
+                            Transform transform) {
+    typedef typename basic_indexed_file<Char, Traits>::row_type row_type;
+
+    const detail::chunk_plan plan(file.size(), std::max(threads, 1u));
+    std::vector<row_type> rows(std::max(threads, 1u));
+    std::vector<std::unique_ptr<T> > partial(plan.count);
+    detail::for_each_chunk(plan, threads, [&](unsigned id, std::size_t c) {
+        row_type &row = rows[id];
+        std::size_t k = plan.begin(c);
+        const std::size_t e = plan.end(c);
+        file.read(k, row);
+        T acc = transform(const_cast<const row_type &>(row));
+        for (++k; k < e; ++k) {
+            file.read(k, row);
+            acc = reduce(std::move(acc),
+                         transform(const_cast<const row_type &>(row)));
+        }
+        partial[c].reset(new T(std::move(acc)));
+    });
+
+    for (std::unique_ptr<T> &p : partial)
+        init = reduce(std::move(init), std::move(*p));
+    return init;
+}
+} // namespace csv
+} // namespace text
+
+#endif
+
+#endif
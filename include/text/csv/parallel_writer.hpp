@@ -0,0 +1,236 @@
+#ifndef TEXT_CSV_PARALLEL_WRITER_HPP
+#define TEXT_CSV_PARALLEL_WRITER_HPP
+
+//          Copyright Roman Kashitsyn 2014 - 2015.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// Multi-threaded CSV output. Requires C++11.
+
+#if __cplusplus >= 201103
+
+#include "ostream.hpp"
+#include "sink.hpp"
+
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+namespace text {
+namespace csv {
+
+/// @brief Writer front-end shared by several formatting threads.
+///
+/// @details Each call to write() formats one block of records on the
+/// calling thread into a private buffer, with the same quoting and number
+/// formatting as a basic_csv_ostream on the target stream. Blocks are
+/// numbered by the caller and committed to the stream strictly in
+/// sequence order, by whichever thread completes the next block in line,
+/// so the output is byte-identical to writing the blocks one after
+/// another on a single thread.
+///
+/// At most max_pending() blocks may wait for their predecessors; threads
+/// running further ahead block in write(). The stream's locale, flags
+/// and precision are captured at construction.
+template <typename Char, typename Traits = std::char_traits<Char> >
+class basic_parallel_writer {
+public:
+    typedef Char char_type;
+    typedef std::basic_ostream<Char, Traits> stream_type;
+    typedef basic_csv_ostream<Char, Traits> csv_type;
+
+    explicit basic_parallel_writer(stream_type &os,
+                                   std::size_t max_pending = 64);
+
+    basic_parallel_writer(stream_type &os, char_type delimiter,
+                          char_type quote, std::size_t max_pending = 64);
+
+    basic_parallel_writer(const basic_parallel_writer &) = delete;
+    basic_parallel_writer &operator=(const basic_parallel_writer &) = delete;
+
+    /// @brief Calls <tt>fn(csv)</tt> to format block <tt>seq</tt> and
+    /// commits it after blocks 0 to seq - 1. Every record written by
+    /// <tt>fn</tt> must be terminated with end_line().
+    ///
+    /// If <tt>fn</tt> throws, the block is committed empty and the
+    /// exception is rethrown.
+    template <typename F>
+    void write(uint64_t seq, F fn);
+
+    /// @brief Returns number of blocks committed to the stream.
+    uint64_t committed() const;
+
+    std::size_t max_pending() const { return max_pending_; }
+
+    /// @brief Waits until the blocks being formatted or written by other
+    /// threads are committed and flushes the stream; throws
+    /// std::runtime_error if some blocks are still waiting for a missing
+    /// predecessor or the stream failed.
+    void close();
+
+private:
+    struct block {
+        block(const stream_type &target)
+            : os(&buf) {
+            // Formatting state and locale, but not the target's tie.
+            os.copyfmt(target);
+            os.tie(0);
+        }
+
+        basic_memory_buf<Char, Traits> buf;
+        stream_type os;
+    };
+
+    typedef std::unique_ptr<block> block_ptr;
+
+    block_ptr acquire();
+    void commit(uint64_t seq, block_ptr b);
+
+private:
+    stream_type &os_;
+    const char_type delim_;
+    const char_type quote_;
+    const std::size_t max_pending_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::vector<block_ptr> free_;
+    std::map<uint64_t, block_ptr> pending_;
+    uint64_t next_;
+    std::size_t formatting_;
+    bool writing_;
+};
+
+typedef basic_parallel_writer<char> parallel_writer;
+typedef basic_parallel_writer<wchar_t> wparallel_writer;
+
+// Implementation
+
+template <typename Char, typename Traits>
+basic_parallel_writer<Char, Traits>::basic_parallel_writer(
+    stream_type &os, std::size_t max_pending)
+    : os_(os)
+    , delim_(os.widen(COMMA))
+    , quote_(os.widen(QUOTE))
+    , max_pending_(max_pending ? max_pending : 1)
+    , next_(0)
+    , formatting_(0)
+    , writing_(false) {}
+
+template <typename Char, typename Traits>
+basic_parallel_writer<Char, Traits>::basic_parallel_writer(
+    stream_type &os, char_type delimiter, char_type quote,
+    std::size_t max_pending)
+    : os_(os)
+    , delim_(delimiter)
+    , quote_(quote)
+    , max_pending_(max_pending ? max_pending : 1)
+    , next_(0)
+    , formatting_(0)
+    , writing_(false) {}
+
+template <typename Char, typename Traits>
+typename basic_parallel_writer<Char, Traits>::block_ptr
+basic_parallel_writer<Char, Traits>::acquire() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!free_.empty()) {
+            block_ptr b = std::move(free_.back());
+            free_.pop_back();
+            return b;
+        }
+    }
+    return block_ptr(new block(os_));
+}
+
+template <typename Char, typename Traits>
+template <typename F>
+void basic_parallel_writer<Char, Traits>::write(uint64_t seq, F fn) {
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [&] { return seq < next_ + max_pending_; });
+        ++formatting_;
+    }
+
+    block_ptr b = acquire();
+    try {
+        csv_type csv(b->os, delim_, quote_);
+        csv.buffer_size(std::size_t(1) << 16);
+        fn(csv);
+        csv.flush();
+    } catch (...) {
+        b->buf.clear();
+        commit(seq, std::move(b));
+        throw;
+    }
+    commit(seq, std::move(b));
+}
+
+template <typename Char, typename Traits>
+void basic_parallel_writer<Char, Traits>::commit(uint64_t seq, block_ptr b) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    pending_[seq] = std::move(b);
+    --formatting_;
+    if (writing_)
+        return;
+
+    // This thread drains every block that is ready, writing without the
+    // lock so that other threads can keep queueing blocks.
+    writing_ = true;
+    for (;;) {
+        typename std::map<uint64_t, block_ptr>::iterator i =
+            pending_.find(next_);
+        if (i == pending_.end())
+            break;
+        block_ptr ready = std::move(i->second);
+        pending_.erase(i);
+
+        lock.unlock();
+        basic_memory_buf<Char, Traits> &buf = ready->buf;
+        if (buf.size() > 0 && os_.good()) {
+            const std::streamsize n = std::streamsize(buf.size());
+            if (os_.rdbuf()->sputn(buf.data(), n) != n)
+                os_.setstate(std::ios_base::badbit);
+        }
+        buf.clear();
+        lock.lock();
+
+        ++next_;
+        free_.push_back(std::move(ready));
+        cv_.notify_all();
+    }
+    writing_ = false;
+    cv_.notify_all();
+}
+
+template <typename Char, typename Traits>
+uint64_t basic_parallel_writer<Char, Traits>::committed() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return next_;
+}
+
+template <typename Char, typename Traits>
+void basic_parallel_writer<Char, Traits>::close() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [&] { return !writing_ && formatting_ == 0; });
+    if (!pending_.empty()) {
+        throw std::runtime_error("Blocks missing before parallel write end");
+    }
+    os_.flush();
+    if (!os_) {
+        throw std::runtime_error("Cannot write CSV output");
+    }
+}
+} // namespace csv
+} // namespace text
+
+#endif
+
+#endif
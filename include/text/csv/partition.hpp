@@ -0,0 +1,459 @@
+#ifndef TEXT_CSV_PARTITION_HPP
+#define TEXT_CSV_PARTITION_HPP
+
+//          Copyright Roman Kashitsyn 2014 - 2015.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "batch.hpp"
+#include "hash.hpp"
+#include "ostream.hpp"
+#include "sink.hpp"
+
+#include <fstream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Partitioned output
+// ==================
+//
+// basic_partitioned_writer routes records to several output files: by
+// the hash of a key column, by the value of a key column, or into a
+// sequence of files rolled over after a number of records or
+// characters. Every file starts with the header, if one is set.
+//
+// Each partition formats its records into its own memory buffer, which
+// is written to the file in blocks of buffer_size() characters, so the
+// number of writes does not grow with the number of records. At most
+// max_open_files() files are open at a time; when another one is needed,
+// the least recently written file is closed and later reopened for
+// appending. When the buffers of all partitions hold more than
+// memory_budget() characters together, they are all written out.
+
+namespace text {
+namespace csv {
+
+template <typename Char, typename Traits = std::char_traits<Char> >
+class basic_partitioned_writer {
+public:
+    typedef Char char_type;
+    typedef std::basic_string<Char, Traits> string_type;
+    typedef basic_field_view<Char, Traits> field_type;
+    typedef basic_row_batch<Char, Traits> batch_type;
+    typedef basic_batch_reader<Char, Traits> reader_type;
+    typedef basic_header<Char, Traits> header_type;
+
+    /// @brief Creates a writer of files named <tt>prefix</tt>, the
+    /// partition name and <tt>suffix</tt>. Nothing is created before the
+    /// first record is written.
+    explicit basic_partitioned_writer(const std::string &prefix,
+                                      const std::string &suffix = ".csv");
+
+    /// @brief Writes buffered records and closes the files, ignoring
+    /// errors.
+    ~basic_partitioned_writer();
+
+    /// @brief Routes records to <tt>n</tt> files named 0 to n - 1 by the
+    /// hash of column <tt>col</tt>.
+    void by_hash(std::size_t col, std::size_t n);
+
+    /// @brief Routes records to one file per distinct value of column
+    /// <tt>col</tt>, named after the value. Characters other than ASCII
+    /// letters, digits, '-', '_' and '.' are replaced by '_' in names;
+    /// if that makes two names equal, the later one gets a suffix
+    /// "_2", "_3", ... to keep the files apart.
+    void by_value(std::size_t col);
+
+    /// @brief Writes records to files named 0, 1, ..., starting a new
+    /// file once the current one holds <tt>max_rows</tt> records or
+    /// <tt>max_chars</tt> characters; zero means no limit.
+    void rolling(uint64_t max_rows, uint64_t max_chars);
+
+    /// @brief Sets the header written at the start of every file.
+    void header(const header_type &h);
+
+    void header(const std::vector<string_type> &names) { header_ = names; }
+
+    /// @brief If set, write(reader) takes the header from the input.
+    bool has_header() const { return has_header_; }
+
+    void has_header(bool h) { has_header_ = h; }
+
+    std::size_t max_open_files() const { return max_open_files_; }
+
+    void max_open_files(std::size_t n) { max_open_files_ = n ? n : 1; }
+
+    /// @brief Characters buffered per partition before they are written.
+    std::size_t buffer_size() const { return buffer_size_; }
+
+    void buffer_size(std::size_t n) { buffer_size_ = n; }
+
+    /// @brief Characters buffered in all partitions before they are all
+    /// written.
+    std::size_t memory_budget() const { return memory_budget_; }
+
+    void memory_budget(std::size_t n) { memory_budget_ = n; }
+
+    /// @brief Writes row <tt>row</tt> of <tt>batch</tt> to its partition.
+    void write(const batch_type &batch, std::size_t row);
+
+    /// @brief Writes every record of <tt>reader</tt>.
+    void write(reader_type &reader);
+
+    /// @brief Writes all buffered records and closes the files; throws
+    /// std::runtime_error if a file cannot be written.
+    void close();
+
+    /// @brief Returns the names of the files created so far, in order of
+    /// creation.
+    const std::vector<std::string> &paths() const { return paths_; }
+
+    uint64_t rows_written() const { return rows_written_; }
+
+private:
+    enum scheme { hash_scheme, value_scheme, rolling_scheme };
+
+    struct partition {
+        explicit partition(const std::string &p)
+            : path(p)
+            , os(&buf)
+            , csv(os)
+            , file(0)
+            , created(false)
+            , rows(0)
+            , chars(0)
+            , last_use(0) {
+            // Commit each record to buf as it ends.
+            csv.buffer_size(1);
+        }
+
+        ~partition() { delete file; }
+
+        std::string path;
+        basic_memory_buf<Char, Traits> buf;
+        std::basic_ostream<Char, Traits> os;
+        basic_csv_ostream<Char, Traits> csv;
+        std::basic_filebuf<Char, Traits> *file;
+        bool created;
+        uint64_t rows;
+        uint64_t chars;
+        uint64_t last_use;
+
+    private:
+        partition(const partition &);
+        partition &operator=(const partition &);
+    };
+
+    basic_partitioned_writer(const basic_partitioned_writer &);
+    basic_partitioned_writer &operator=(const basic_partitioned_writer &);
+
+    partition &select(const batch_type &batch, std::size_t row);
+
+    partition &create(const std::string &name);
+
+    /// Writes the buffer of <tt>p</tt> to its file, opening it if needed.
+    void flush(partition &p);
+
+    void flush_all();
+
+    /// Closes the file of <tt>p</tt>.
+    void close_file(partition &p);
+
+    field_type key(const batch_type &batch, std::size_t row) const {
+        return key_ < batch.field_count(row) ? batch.field(row, key_)
+                                             : field_type();
+    }
+
+    static std::string file_name(const field_type &value);
+
+    static std::string file_name(uint64_t index);
+
+    /// Returns <tt>name</tt>, suffixed if needed, as an unused name.
+    std::string unique_name(const std::string &name);
+
+private:
+    std::string prefix_;
+    std::string suffix_;
+    scheme scheme_;
+    std::size_t key_;
+    std::size_t count_;
+    uint64_t max_rows_;
+    uint64_t max_chars_;
+    std::vector<string_type> header_;
+    bool has_header_;
+    std::size_t max_open_files_;
+    std::size_t buffer_size_;
+    std::size_t memory_budget_;
+
+    std::vector<partition *> partitions_;
+    std::map<string_type, std::size_t> by_value_;
+    std::set<std::string> value_names_;
+    std::vector<std::string> paths_;
+    std::size_t open_files_;
+    std::size_t buffered_;
+    uint64_t clock_;
+    uint64_t rows_written_;
+};
+
+typedef basic_partitioned_writer<char> partitioned_writer;
+typedef basic_partitioned_writer<wchar_t> wpartitioned_writer;
+
+// Implementation
+
+template <typename Char, typename Traits>
+basic_partitioned_writer<Char, Traits>::basic_partitioned_writer(
+    const std::string &prefix, const std::string &suffix)
+    : prefix_(prefix)
+    , suffix_(suffix)
+    , scheme_(rolling_scheme)
+    , key_(0)
+    , count_(1)
+    , max_rows_(0)
+    , max_chars_(0)
+    , has_header_(false)
+    , max_open_files_(64)
+    , buffer_size_(detail::output_block_size())
+    , memory_budget_(std::size_t(64) << 20)
+    , open_files_(0)
+    , buffered_(0)
+    , clock_(0)
+    , rows_written_(0) {}
+
+template <typename Char, typename Traits>
+basic_partitioned_writer<Char, Traits>::~basic_partitioned_writer() {
+    try {
+        close();
+    } catch (...) {
+    }
+    for (std::size_t i = 0; i < partitions_.size(); ++i)
+        delete partitions_[i];
+}
+
+template <typename Char, typename Traits>
+void basic_partitioned_writer<Char, Traits>::by_hash(std::size_t col,
+                                                     std::size_t n) {
+    scheme_ = hash_scheme;
+    key_ = col;
+    count_ = n ? n : 1;
+}
+
+template <typename Char, typename Traits>
+void basic_partitioned_writer<Char, Traits>::by_value(std::size_t col) {
+    scheme_ = value_scheme;
+    key_ = col;
+}
+
+template <typename Char, typename Traits>
+void basic_partitioned_writer<Char, Traits>::rolling(uint64_t max_rows,
+                                                     uint64_t max_chars) {
+    scheme_ = rolling_scheme;
+    max_rows_ = max_rows;
+    max_chars_ = max_chars;
+}
+
+template <typename Char, typename Traits>
+void basic_partitioned_writer<Char, Traits>::header(const header_type &h) {
+    header_.clear();
+    for (std::size_t i = 0; i < h.size(); ++i)
+        header_.push_back(h.name_of(i));
+}
+
+template <typename Char, typename Traits>
+std::string
+basic_partitioned_writer<Char, Traits>::file_name(const field_type &value) {
+    std::string name;
+    for (const Char *p = value.begin(); p != value.end(); ++p) {
+        const long c = long(Traits::to_int_type(*p));
+        const bool plain = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+                           (c >= '0' && c <= '9') || c == '-' || c == '_' ||
+                           c == '.';
+        name.push_back(plain ? char(c) : '_');
+    }
+    // Keep names like "." and ".." from referring to directories.
+    if (name.empty() || name[0] == '.')
+        name.insert(name.begin(), '_');
+    return name;
+}
+
+template <typename Char, typename Traits>
+std::string basic_partitioned_writer<Char, Traits>::file_name(uint64_t index) {
+    std::ostringstream os;
+    os << index;
+    return os.str();
+}
+
+template <typename Char, typename Traits>
+std::string
+basic_partitioned_writer<Char, Traits>::unique_name(const std::string &name) {
+    std::string unique = name;
+    for (uint64_t n = 2; !value_names_.insert(unique).second; ++n)
+        unique = name + "_" + file_name(n);
+    return unique;
+}
+
+template <typename Char, typename Traits>
+typename basic_partitioned_writer<Char, Traits>::partition &
+basic_partitioned_writer<Char, Traits>::create(const std::string &name) {
+    partitions_.push_back(0);
+    partitions_.back() = new partition(prefix_ + name + suffix_);
+    partition &p = *partitions_.back();
+    if (!header_.empty()) {
+        for (std::size_t i = 0; i < header_.size(); ++i)
+            p.csv << header_[i];
+        p.csv.end_line();
+        p.chars = p.buf.size();
+        buffered_ += p.buf.size();
+    }
+    return p;
+}
+
+template <typename Char, typename Traits>
+typename basic_partitioned_writer<Char, Traits>::partition &
+basic_partitioned_writer<Char, Traits>::select(const batch_type &batch,
+                                               std::size_t row) {
+    if (scheme_ == hash_scheme) {
+        if (partitions_.empty()) {
+            for (std::size_t i = 0; i < count_; ++i)
+                create(file_name(uint64_t(i)));
+        }
+        const field_type f = key(batch, row);
+        return *partitions_[hash_field(f.begin(), f.end()) % count_];
+    }
+
+    if (scheme_ == value_scheme) {
+        const field_type f = key(batch, row);
+        const string_type value(f.begin(), f.end());
+        typename std::map<string_type, std::size_t>::iterator i =
+            by_value_.find(value);
+        if (i != by_value_.end())
+            return *partitions_[i->second];
+        by_value_[value] = partitions_.size();
+        return create(unique_name(file_name(f)));
+    }
+
+    if (!partitions_.empty()) {
+        partition &p = *partitions_.back();
+        const bool full = (max_rows_ && p.rows >= max_rows_) ||
+                          (max_chars_ && p.chars >= max_chars_);
+        if (!full)
+            return p;
+        // Rolled over files are complete: write them out for good and
+        // release the buffer.
+        flush(p);
+        close_file(p);
+        string_type released;
+        p.buf.swap(released);
+    }
+    return create(file_name(uint64_t(partitions_.size())));
+}
+
+template <typename Char, typename Traits>
+void basic_partitioned_writer<Char, Traits>::write(const batch_type &batch,
+                                                   std::size_t row) {
+    partition &p = select(batch, row);
+    const std::size_t before = p.buf.size();
+    for (std::size_t c = 0, n = batch.field_count(row); c < n; ++c)
+        p.csv << batch.field(row, c);
+    p.csv.end_line();
+
+    const std::size_t added = p.buf.size() - before;
+    p.chars += added;
+    ++p.rows;
+    ++rows_written_;
+    buffered_ += added;
+
+    if (p.buf.size() >= buffer_size_)
+        flush(p);
+    if (buffered_ > memory_budget_)
+        flush_all();
+}
+
+template <typename Char, typename Traits>
+void basic_partitioned_writer<Char, Traits>::write(reader_type &reader) {
+    if (has_header_)
+        header(reader.read_header());
+    batch_type batch;
+    while (reader.next(batch)) {
+        for (std::size_t r = 0, n = batch.size(); r < n; ++r)
+            write(batch, r);
+    }
+}
+
+template <typename Char, typename Traits>
+void basic_partitioned_writer<Char, Traits>::flush(partition &p) {
+    if (p.buf.size() == 0)
+        return;
+
+    if (!p.file) {
+        if (open_files_ >= max_open_files_) {
+            partition *lru = 0;
+            for (std::size_t i = 0; i < partitions_.size(); ++i) {
+                partition *const q = partitions_[i];
+                if (q->file && (!lru || q->last_use < lru->last_use))
+                    lru = q;
+            }
+            close_file(*lru);
+        }
+        p.file = new std::basic_filebuf<Char, Traits>();
+        // Blocks are large already; write them without another copy.
+        p.file->pubsetbuf(0, 0);
+        const std::ios_base::openmode mode =
+            std::ios_base::out | std::ios_base::binary |
+            (p.created ? std::ios_base::app : std::ios_base::trunc);
+        if (!p.file->open(p.path.c_str(), mode)) {
+            delete p.file;
+            p.file = 0;
+            throw std::runtime_error("Cannot create output file");
+        }
+        if (!p.created) {
+            p.created = true;
+            paths_.push_back(p.path);
+        }
+        ++open_files_;
+    }
+
+    p.last_use = ++clock_;
+    const std::streamsize n = std::streamsize(p.buf.size());
+    const bool ok = p.file->sputn(p.buf.data(), n) == n;
+    buffered_ -= p.buf.size();
+    p.buf.clear();
+    if (!ok) {
+        throw std::runtime_error("Cannot write output file");
+    }
+}
+
+template <typename Char, typename Traits>
+void basic_partitioned_writer<Char, Traits>::flush_all() {
+    for (std::size_t i = 0; i < partitions_.size(); ++i)
+        flush(*partitions_[i]);
+}
+
+template <typename Char, typename Traits>
+void basic_partitioned_writer<Char, Traits>::close_file(partition &p) {
+    if (!p.file)
+        return;
+    const bool ok = p.file->close() != 0;
+    delete p.file;
+    p.file = 0;
+    --open_files_;
+    if (!ok) {
+        throw std::runtime_error("Cannot write output file");
+    }
+}
+
+template <typename Char, typename Traits>
+void basic_partitioned_writer<Char, Traits>::close() {
+    for (std::size_t i = 0; i < partitions_.size(); ++i) {
+        flush(*partitions_[i]);
+        close_file(*partitions_[i]);
+    }
+}
+} // namespace csv
+} // namespace text
+
+#endif
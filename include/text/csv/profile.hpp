@@ -0,0 +1,320 @@
+#ifndef TEXT_CSV_PROFILE_HPP
+#define TEXT_CSV_PROFILE_HPP
+
+//          Copyright Roman Kashitsyn 2014 - 2015.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "batch.hpp"
+#include "hash.hpp"
+#include "parallel.hpp"
+#include "sketch.hpp"
+
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace text {
+namespace csv {
+
+/// @brief Summary statistics of a single column.
+///
+/// @details Fields that convert to a finite double contribute to min(),
+/// max(), mean(), variance() and quantile(); "nan", "inf" and the like
+/// are only counted by non_finite_count(). Every non-empty field
+/// contributes to distinct(), min_value() and max_value(). Distinct counts and
+/// quantiles are approximate, see hyperloglog and quantile_sketch.
+template <typename Char, typename Traits = std::char_traits<Char> >
+class basic_column_profile {
+public:
+    typedef std::basic_string<Char, Traits> string_type;
+    typedef basic_field_view<Char, Traits> field_type;
+
+    explicit basic_column_profile(unsigned precision = 12,
+                                  std::size_t quantile_k = 200)
+        : count_(0)
+        , empty_(0)
+        , numeric_(0)
+        , non_finite_(0)
+        , min_(std::numeric_limits<double>::infinity())
+        , max_(-std::numeric_limits<double>::infinity())
+        , mean_(0)
+        , m2_(0)
+        , max_length_(0)
+        , has_value_(false)
+        , distinct_(precision)
+        , quantiles_(quantile_k) {}
+
+    void add(const field_type &f);
+
+    /// @brief Adds the statistics of <tt>other</tt>.
+    void merge(const basic_column_profile &other);
+
+    /// @brief Returns number of records having this column.
+    uint64_t count() const { return count_; }
+
+    /// @brief Returns number of empty fields.
+    uint64_t empty_count() const { return empty_; }
+
+    /// @brief Returns number of fields holding a finite number.
+    uint64_t numeric_count() const { return numeric_; }
+
+    /// @brief Returns number of fields holding NaN or an infinity.
+    uint64_t non_finite_count() const { return non_finite_; }
+
+    /// @brief Returns true if some field holds a finite number and every
+    /// non-empty field holds a number.
+    bool is_numeric() const {
+        return numeric_ && numeric_ + non_finite_ + empty_ == count_;
+    }
+
+    /// @brief Returns the smallest number, or NaN.
+    double min() const { return numeric_ ? min_ : nan(); }
+
+    /// @brief Returns the largest number, or NaN.
+    double max() const { return numeric_ ? max_ : nan(); }
+
+    /// @brief Returns the mean of the numbers, or NaN.
+    double mean() const { return numeric_ ? mean_ : nan(); }
+
+    /// @brief Returns the population variance of the numbers, or NaN.
+    double variance() const {
+        return numeric_ ? m2_ / double(numeric_) : nan();
+    }
+
+    /// @brief Returns approximate quantile <tt>q</tt> of the numbers, or
+    /// NaN.
+    double quantile(double q) const { return quantiles_.quantile(q); }
+
+    /// @brief Returns the approximate number of distinct non-empty values.
+    double distinct() const { return distinct_.estimate(); }
+
+    /// @brief Returns the lexicographically smallest non-empty value.
+    const string_type &min_value() const { return min_value_; }
+
+    /// @brief Returns the lexicographically largest non-empty value.
+    const string_type &max_value() const { return max_value_; }
+
+    /// @brief Returns the length of the longest field in characters.
+    std::size_t max_length() const { return max_length_; }
+
+private:
+    static double nan() { return std::numeric_limits<double>::quiet_NaN(); }
+
+    void add_value(const field_type &f) {
+        if (!has_value_ || f < field_type(min_value_))
+            min_value_.assign(f.begin(), f.end());
+        if (!has_value_ || field_type(max_value_) < f)
+            max_value_.assign(f.begin(), f.end());
+        has_value_ = true;
+    }
+
+private:
+    uint64_t count_;
+    uint64_t empty_;
+    uint64_t numeric_;
+    uint64_t non_finite_;
+    double min_;
+    double max_;
+    double mean_;
+    double m2_;
+    std::size_t max_length_;
+    bool has_value_;
+    string_type min_value_;
+    string_type max_value_;
+    hyperloglog distinct_;
+    quantile_sketch quantiles_;
+};
+
+/// @brief Single-pass profiler of all columns of a CSV file.
+///
+/// @details Columns are numbered by position and added as records with
+/// more fields are seen; records lacking a column are reported by
+/// missing(). Memory per column is bounded by the sketch parameters
+/// and the longest min_value() and max_value().
+///
+/// Profilers built over disjoint parts of the input can be combined
+/// with merge(), which is how the multi-threaded consume() works.
+template <typename Char, typename Traits = std::char_traits<Char> >
+class basic_profiler {
+public:
+    typedef basic_column_profile<Char, Traits> profile_type;
+    typedef basic_field_view<Char, Traits> field_type;
+    typedef basic_row_batch<Char, Traits> batch_type;
+    typedef basic_batch_reader<Char, Traits> reader_type;
+
+    explicit basic_profiler(unsigned precision = 12,
+                            std::size_t quantile_k = 200)
+        : precision_(precision)
+        , quantile_k_(quantile_k)
+        , rows_(0) {}
+
+    void consume(const batch_type &batch);
+
+    /// @brief Consumes all remaining batches of <tt>reader</tt>.
+    void consume(reader_type &reader);
+
+#if __cplusplus >= 201103
+    /// @brief Consumes all remaining batches of <tt>reader</tt> on
+    /// <tt>threads</tt> threads, each filling its own partial profile.
+    void consume(reader_type &reader, unsigned threads);
+#endif
+
+    /// @brief Adds the statistics of <tt>other</tt>.
+    void merge(const basic_profiler &other);
+
+    /// @brief Returns number of records consumed.
+    uint64_t rows() const { return rows_; }
+
+    /// @brief Returns number of columns seen.
+    std::size_t size() const { return columns_.size(); }
+
+    const profile_type &operator[](std::size_t col) const {
+        return columns_[col];
+    }
+
+    /// @brief Returns number of records lacking column <tt>col</tt>.
+    uint64_t missing(std::size_t col) const {
+        return rows_ - columns_[col].count();
+    }
+
+private:
+    void reserve_columns(std::size_t n) {
+        if (n > columns_.size())
+            columns_.resize(n, profile_type(precision_, quantile_k_));
+    }
+
+private:
+    unsigned precision_;
+    std::size_t quantile_k_;
+    uint64_t rows_;
+    std::vector<profile_type> columns_;
+};
+
+typedef basic_column_profile<char> column_profile;
+typedef basic_column_profile<wchar_t> wcolumn_profile;
+typedef basic_profiler<char> profiler;
+typedef basic_profiler<wchar_t> wprofiler;
+
+// Implementation
+
+template <typename Char, typename Traits>
+void basic_column_profile<Char, Traits>::add(const field_type &f) {
+    ++count_;
+    if (f.size() > max_length_)
+        max_length_ = f.size();
+    if (f.empty()) {
+        ++empty_;
+        return;
+    }
+
+    distinct_.add(hash_field(f.begin(), f.end()));
+    add_value(f);
+
+    double v;
+    if (!convert<double>::parse(f.begin(), f.end(), v))
+        return;
+    if (!(v >= -std::numeric_limits<double>::max() &&
+          v <= std::numeric_limits<double>::max())) {
+        // NaN and infinities would poison the moments and quantiles.
+        ++non_finite_;
+        return;
+    }
+
+    ++numeric_;
+    if (v < min_)
+        min_ = v;
+    if (v > max_)
+        max_ = v;
+    const double delta = v - mean_;
+    mean_ += delta / double(numeric_);
+    m2_ += delta * (v - mean_);
+    quantiles_.add(v);
+}
+
+template <typename Char, typename Traits>
+void basic_column_profile<Char, Traits>::merge(
+    const basic_column_profile &other) {
+    if (other.numeric_) {
+        const double n = double(numeric_ + other.numeric_);
+        const double delta = other.mean_ - mean_;
+        mean_ += delta * double(other.numeric_) / n;
+        m2_ += other.m2_ +
+               delta * delta * double(numeric_) * double(other.numeric_) / n;
+        if (other.min_ < min_)
+            min_ = other.min_;
+        if (other.max_ > max_)
+            max_ = other.max_;
+        numeric_ += other.numeric_;
+    }
+    if (other.has_value_) {
+        add_value(field_type(other.min_value_));
+        add_value(field_type(other.max_value_));
+    }
+    count_ += other.count_;
+    empty_ += other.empty_;
+    non_finite_ += other.non_finite_;
+    if (other.max_length_ > max_length_)
+        max_length_ = other.max_length_;
+    distinct_.merge(other.distinct_);
+    quantiles_.merge(other.quantiles_);
+}
+
+template <typename Char, typename Traits>
+void basic_profiler<Char, Traits>::consume(const batch_type &batch) {
+    for (std::size_t r = 0, n = batch.size(); r < n; ++r) {
+        const std::size_t fields = batch.field_count(r);
+        reserve_columns(fields);
+        for (std::size_t c = 0; c < fields; ++c) {
+            columns_[c].add(batch.field(r, c));
+        }
+    }
+    rows_ += batch.size();
+}
+
+template <typename Char, typename Traits>
+void basic_profiler<Char, Traits>::consume(reader_type &reader) {
+    batch_type batch;
+    while (reader.next(batch)) {
+        consume(batch);
+    }
+}
+
+#if __cplusplus >= 201103
+
+template <typename Char, typename Traits>
+void basic_profiler<Char, Traits>::consume(reader_type &reader,
+                                           unsigned threads) {
+    if (threads < 2) {
+        consume(reader);
+        return;
+    }
+
+    std::vector<basic_profiler> partial(
+        threads, basic_profiler(precision_, quantile_k_));
+
+    parallel_for_each_batch(reader, threads,
+                            [&partial](unsigned id, const batch_type &b) {
+                                partial[id].consume(b);
+                            });
+
+    for (const basic_profiler &p : partial) {
+        merge(p);
+    }
+}
+
+#endif
+
+template <typename Char, typename Traits>
+void basic_profiler<Char, Traits>::merge(const basic_profiler &other) {
+    reserve_columns(other.columns_.size());
+    for (std::size_t c = 0; c < other.columns_.size(); ++c) {
+        columns_[c].merge(other.columns_[c]);
+    }
+    rows_ += other.rows_;
+}
+} // namespace csv
+} // namespace text
+
+#endif
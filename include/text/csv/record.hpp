@@ -0,0 +1,121 @@
+#ifndef TEXT_CSV_RECORD_HPP
+#define TEXT_CSV_RECORD_HPP
+
+//          Copyright Roman Kashitsyn 2014 - 2015.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// Writing whole records from tuples and structs. Requires C++11.
+
+#if __cplusplus >= 201103
+
+#include "ostream.hpp"
+
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+
+namespace text {
+namespace csv {
+
+/// @brief Maps a struct to the tuple of its fields for write_record().
+///
+/// @details Specialize it with a static <tt>get</tt> function returning
+/// a tuple, usually of references:
+/// @code
+/// template <> struct record_fields<trade> {
+///     static auto get(const trade &t) -> decltype(std::tie(t.id, t.price)) {
+///         return std::tie(t.id, t.price);
+///     }
+/// };
+/// @endcode
+template <typename T>
+struct record_fields;
+
+namespace detail {
+
+/// Writes tuples as records. Column types are known at compile time:
+/// arithmetic values are formatted straight into the writer's buffer
+/// without the special symbol scan whenever the writer's settings allow
+/// it for one of them, which is decided once per record.
+template <typename Char, typename Traits>
+struct record_writer {
+    typedef basic_csv_ostream<Char, Traits> csv_type;
+    typedef typename csv_type::string_type string_type;
+
+    template <typename T>
+    static typename std::enable_if<std::is_arithmetic<T>::value>::type
+    field(csv_type &out, const T &v, bool plain) {
+        if (!plain)
+            return out.append_number(v);
+        char digits[max_number_chars];
+        char const *const begin = digits;
+        char const *const end = format_number(v, digits);
+        out.buf_.append(begin, end);
+    }
+
+    static void field(csv_type &out, const string_type &s, bool) {
+        out.append_field(s.data(), s.data() + s.size());
+    }
+
+    static void field(csv_type &out, const Char *s, bool) {
+        out.append_field(s, s + Traits::length(s));
+    }
+
+    template <std::size_t I, typename Tuple>
+    static typename std::enable_if<I == std::tuple_size<Tuple>::value>::type
+    fields(csv_type &, const Tuple &, bool) {}
+
+    template <std::size_t I, typename Tuple>
+    static typename std::enable_if<(I < std::tuple_size<Tuple>::value)>::type
+    fields(csv_type &out, const Tuple &t, bool plain) {
+        if (I > 0)
+            out.buf_.push_back(out.delim_);
+        field(out, std::get<I>(t), plain);
+        fields<I + 1>(out, t, plain);
+    }
+
+    template <typename Tuple>
+    static void write(csv_type &out, const Tuple &t) {
+        const bool plain = out.format_ == shortest_format &&
+                           out.plain_flags() && out.plain_numbers_ &&
+                           out.quoting_ != quote_all;
+        // Continues a record started with operator<<, if any.
+        out.insert_delimiter();
+        fields<0>(out, t, plain);
+        out.buf_.push_back(out.cr_);
+        out.buf_.push_back(out.lf_);
+        out.first_ = true;
+        out.commit_if_full();
+    }
+};
+} // namespace detail
+
+/// @brief Writes the elements of <tt>t</tt> as one record, terminated
+/// like end_line().
+///
+/// @details Elements may be arithmetic values, strings or C strings of
+/// the writer's character type, and are formatted exactly like with
+/// operator<<. The record is committed as a whole: with a zero
+/// buffer_size() the stream is written once per record, not per field.
+template <typename Char, typename Traits, typename... Ts>
+basic_csv_ostream<Char, Traits> &
+write_record(basic_csv_ostream<Char, Traits> &out, const std::tuple<Ts...> &t) {
+    detail::record_writer<Char, Traits>::write(out, t);
+    return out;
+}
+
+/// @brief Writes the fields of <tt>record</tt>, as listed by
+/// record_fields<T>, as one record.
+template <typename Char, typename Traits, typename T>
+basic_csv_ostream<Char, Traits> &
+write_record(basic_csv_ostream<Char, Traits> &out, const T &record) {
+    return write_record(out, record_fields<T>::get(record));
+}
+} // namespace csv
+} // namespace text
+
+#endif
+
+#endif
@@ -8,6 +8,7 @@
 
 #include "ostream.hpp"
 #include "istream.hpp"
+#include "convert.hpp"
 
 #include <algorithm>
 #include <vector>
@@ -48,6 +49,7 @@ public:
 
     bool operator!=(const basic_row &rhs) const { return !(*this == rhs); }
 
+    /// @brief Converts field <tt>pos</tt> with convert<T>.
     template <typename T>
     T as(std::size_t pos) const;
 
@@ -267,10 +269,7 @@ basic_row<Char, Traits>::basic_row(basic_csv_istream<Char, Traits> &is) {
 template <typename Char, typename Traits>
 template <typename T>
 T basic_row<Char, Traits>::as(std::size_t pos) const {
-    T sink;
-    std::basic_stringstream<Char, Traits> s((*this)[pos]);
-    s >> sink;
-    return sink;
+    return field_cast<T>((*this)[pos]);
 }
 
 template <typename Char, typename Traits>
@@ -420,20 +419,14 @@ template <typename Char, typename Traits>
 template <typename T>
 T basic_map_row<Char, Traits>::as(
     const typename basic_map_row<Char, Traits>::key_type &key) const {
-    T sink;
-    std::basic_stringstream<Char, Traits> is((*this)[key]);
-    is >> sink;
-    return sink;
+    return field_cast<T>((*this)[key]);
 }
 
 template <typename Char, typename Traits>
 template <typename T>
 T basic_map_row<Char, Traits>::as(
     const typename basic_map_row<Char, Traits>::char_type *key) const {
-    T sink;
-    std::basic_stringstream<Char, Traits> is((*this)[key]);
-    is >> sink;
-    return sink;
+    return field_cast<T>((*this)[key]);
 }
 
 template <typename Char, typename Traits>
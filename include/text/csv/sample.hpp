@@ -0,0 +1,432 @@
+#ifndef TEXT_CSV_SAMPLE_HPP
+#define TEXT_CSV_SAMPLE_HPP
+
+//          Copyright Roman Kashitsyn 2014 - 2015.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// Random sampling of records. Requires C++11.
+
+#if __cplusplus >= 201103
+
+#include "indexed.hpp"
+#include "istream.hpp"
+#include "rows.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Sampling
+// ========
+//
+// Stream samplers draw the number of records to pass over from a
+// geometric distribution and step over them with
+// basic_csv_istream::skip_field(), so records that are not sampled are
+// scanned but never stored.
+//
+// With random access to the text no scan is needed at all:
+// sample_rows() picks records of a basic_indexed_file by number, and
+// basic_offset_sampler jumps to random offsets of a memory mapped file
+// and resynchronizes on the next record boundary, without an index.
+//
+// All samplers take a uniform random bit generator, such as
+// std::mt19937. Except for reservoir_sample(), they deliver records in
+// file order.
+
+namespace text {
+namespace csv {
+namespace detail {
+
+/// Steps over the next record of <tt>is</tt>; returns false at the end
+/// of the input.
+template <typename Char, typename Traits>
+bool skip_record(basic_csv_istream<Char, Traits> &is) {
+    if (!is)
+        return false;
+    do {
+        is.skip_field();
+    } while (is.good() && is.has_more_fields());
+    is.has_more_fields(true);
+    return true;
+}
+
+template <typename Char, typename Traits>
+bool skip_records(basic_csv_istream<Char, Traits> &is, unsigned long long n) {
+    for (; n > 0; --n) {
+        if (!skip_record(is))
+            return false;
+    }
+    return true;
+}
+
+/// Draws from (0, 1], so the result can be passed to std::log.
+template <typename URNG>
+double open_unit(URNG &rng) {
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    return 1.0 - unit(rng);
+}
+} // namespace detail
+
+/// @brief Calls <tt>fn(row)</tt> for each remaining record of
+/// <tt>is</tt> independently with probability <tt>p</tt>.
+template <typename Char, typename Traits, typename URNG, typename F>
+void bernoulli_sample(basic_csv_istream<Char, Traits> &is, double p,
+                      URNG &rng, F fn) {
+    typedef basic_row<Char, Traits> row_type;
+    if (!(p > 0.0))
+        return;
+
+    // The number of records passed over before the next one is kept.
+    std::geometric_distribution<unsigned long long> gap(p < 1.0 ? p : 0.5);
+    row_type row;
+    for (;;) {
+        if (p < 1.0 && !detail::skip_records(is, gap(rng)))
+            return;
+        if (!is)
+            return;
+        is >> row;
+        fn(const_cast<const row_type &>(row));
+    }
+}
+
+/// @brief Returns <tt>k</tt> records chosen uniformly from the remaining
+/// records of <tt>is</tt>, or all of them if there are fewer.
+///
+/// @details Uses Li's Algorithm L: the number of records to pass over
+/// before the next replacement is drawn directly, so only O(k log(N/k))
+/// records are parsed. The order of the result is unspecified.
+template <typename Char, typename Traits, typename URNG>
+std::vector<basic_row<Char, Traits> >
+reservoir_sample(basic_csv_istream<Char, Traits> &is, std::size_t k,
+                 URNG &rng) {
+    typedef basic_row<Char, Traits> row_type;
+    std::vector<row_type> sample;
+    if (k == 0)
+        return sample;
+
+    sample.reserve(k);
+    while (sample.size() < k && is) {
+        sample.push_back(row_type());
+        is >> sample.back();
+    }
+    if (sample.size() < k)
+        return sample;
+
+    std::uniform_int_distribution<std::size_t> slot(0, k - 1);
+    double w = std::exp(std::log(detail::open_unit(rng)) / double(k));
+    for (;;) {
+        const double skip =
+            std::floor(std::log(detail::open_unit(rng)) / std::log1p(-w));
+        if (!(skip < 1e18) || !detail::skip_records(
+                                  is, static_cast<unsigned long long>(skip)))
+            return sample;
+        if (!is)
+            return sample;
+        is >> sample[slot(rng)];
+        w *= std::exp(std::log(detail::open_unit(rng)) / double(k));
+    }
+}
+
+/// @brief Splits the remaining records of <tt>is</tt> into blocks of
+/// <tt>block_rows</tt> consecutive records and calls <tt>fn(row)</tt>
+/// for every record of each block kept with probability <tt>p</tt>.
+template <typename Char, typename Traits, typename URNG, typename F>
+void block_sample(basic_csv_istream<Char, Traits> &is,
+                  std::size_t block_rows, double p, URNG &rng, F fn) {
+    typedef basic_row<Char, Traits> row_type;
+    if (!(p > 0.0) || block_rows == 0)
+        return;
+
+    std::bernoulli_distribution keep(std::min(p, 1.0));
+    row_type row;
+    while (is) {
+        if (!keep(rng)) {
+            if (!detail::skip_records(is, block_rows))
+                return;
+            continue;
+        }
+        for (std::size_t i = 0; i < block_rows && is; ++i) {
+            is >> row;
+            fn(const_cast<const row_type &>(row));
+        }
+    }
+}
+
+/// @brief Returns <tt>k</tt> distinct records of <tt>file</tt> chosen
+/// uniformly, in file order, or all records if there are fewer. Only
+/// the chosen records are parsed.
+template <typename Char, typename Traits, typename URNG>
+std::vector<basic_row<Char, Traits> >
+sample_rows(const basic_indexed_file<Char, Traits> &file, std::size_t k,
+            URNG &rng) {
+    const std::size_t n = file.size();
+    k = std::min(k, n);
+
+    // Floyd's algorithm: k draws for k distinct numbers.
+    std::set<std::size_t> chosen;
+    for (std::size_t j = n - k; j < n; ++j) {
+        const std::size_t t =
+            std::uniform_int_distribution<std::size_t>(0, j)(rng);
+        if (!chosen.insert(t).second)
+            chosen.insert(j);
+    }
+
+    std::vector<basic_row<Char, Traits> > sample(chosen.size());
+    std::size_t i = 0;
+    for (std::set<std::size_t>::const_iterator c = chosen.begin(),
+                                               e = chosen.end();
+         c != e; ++c)
+        file.read(*c, sample[i++]);
+    return sample;
+}
+
+/// @brief Samples records of a CSV text by jumping to random offsets.
+///
+/// @details A record is found by moving from a random offset to the
+/// next line start and checking that the record there parses and has
+/// as many fields as the header, or as the first record if there is no
+/// header; otherwise the following line start is tried. Nothing but
+/// the sampled records and the first few records, used to estimate
+/// the record count, is read.
+///
+/// Records are chosen with probability proportional to the length of
+/// the record before them, which is uniform enough for data-quality
+/// checks on files with records of similar length. A line break inside
+/// a quoted field may be taken for a record start if the text after it
+/// happens to have the right number of fields. Use sample_rows() on a
+/// basic_indexed_file where exact uniformity matters.
+template <typename Char, typename Traits = std::char_traits<Char> >
+class basic_offset_sampler {
+public:
+    typedef Char char_type;
+    typedef Traits traits_type;
+    typedef basic_row<Char, Traits> row_type;
+    typedef basic_header<Char, Traits> header_type;
+
+#if defined(TEXT_CSV_HAS_POSIX_IO)
+    /// @brief Maps the file at <tt>path</tt> read-only; throws
+    /// std::runtime_error on failure.
+    /// @param header whether the first record is a header.
+    explicit basic_offset_sampler(const std::string &path, bool header = true)
+        : basic_offset_sampler(path, header, COMMA, QUOTE) {}
+
+    basic_offset_sampler(const std::string &path, bool header,
+                         char_type delimiter)
+        : basic_offset_sampler(path, header, delimiter, QUOTE) {}
+
+    basic_offset_sampler(const std::string &path, bool header,
+                         char_type delimiter, char_type quote);
+#endif
+
+    /// @brief Samples the text [begin, end) owned by the caller.
+    basic_offset_sampler(const char_type *begin, const char_type *end,
+                         bool header = true)
+        : basic_offset_sampler(begin, end, header, COMMA, QUOTE) {}
+
+    basic_offset_sampler(const char_type *begin, const char_type *end,
+                         bool header, char_type delimiter)
+        : basic_offset_sampler(begin, end, header, delimiter, QUOTE) {}
+
+    basic_offset_sampler(const char_type *begin, const char_type *end,
+                         bool header, char_type delimiter, char_type quote);
+
+    basic_offset_sampler(const basic_offset_sampler &) = delete;
+    basic_offset_sampler &operator=(const basic_offset_sampler &) = delete;
+
+    /// @brief Returns the header; empty if the text has none.
+    const header_type &header() const { return header_; }
+
+    bool empty() const { return body_ == size_; }
+
+    /// @brief Returns the number of records estimated from the mean
+    /// length of the first ones.
+    std::size_t estimated_size() const { return estimated_size_; }
+
+    /// @brief Calls <tt>fn(row)</tt> for <tt>n</tt> records drawn with
+    /// replacement.
+    template <typename URNG, typename F>
+    void sample(std::size_t n, URNG &rng, F fn) const {
+        blocks(n, 1, rng, fn);
+    }
+
+    /// @brief Samples about <tt>p</tt> times estimated_size() records.
+    template <typename URNG, typename F>
+    void bernoulli(double p, URNG &rng, F fn) const;
+
+    /// @brief Calls <tt>fn(row)</tt> for up to <tt>block_rows</tt>
+    /// consecutive records from each of <tt>n</tt> random places.
+    template <typename URNG, typename F>
+    void blocks(std::size_t n, std::size_t block_rows, URNG &rng,
+                F fn) const;
+
+private:
+    typedef detail::record_scanner<Char, Traits> scanner_type;
+
+    void init(bool header);
+    const char_type *next_line(const char_type *p) const;
+    const char_type *resync(std::size_t offset, row_type &row) const;
+
+#if defined(TEXT_CSV_HAS_POSIX_IO)
+    detail::mapped_file<Char> mapping_;
+#endif
+    const char_type *data_;
+    std::size_t size_;
+    scanner_type scanner_;
+    std::size_t body_;
+    std::size_t fields_;
+    std::size_t estimated_size_;
+    header_type header_;
+};
+
+typedef basic_offset_sampler<char> offset_sampler;
+typedef basic_offset_sampler<wchar_t> woffset_sampler;
+
+// Implementation
+
+#if defined(TEXT_CSV_HAS_POSIX_IO)
+
+template <typename Char, typename Traits>
+basic_offset_sampler<Char, Traits>::basic_offset_sampler(
+    const std::string &path, bool header, char_type delimiter,
+    char_type quote)
+    : data_(0)
+    , size_(0)
+    , scanner_(delimiter, quote)
+    , body_(0)
+    , fields_(0)
+    , estimated_size_(0) {
+    mapping_.map(path);
+    data_ = mapping_.data();
+    size_ = mapping_.size();
+    init(header);
+    mapping_.random_access();
+}
+
+#endif
+
+template <typename Char, typename Traits>
+basic_offset_sampler<Char, Traits>::basic_offset_sampler(
+    const char_type *begin, const char_type *end, bool header,
+    char_type delimiter, char_type quote)
+    : data_(begin)
+    , size_(std::size_t(end - begin))
+    , scanner_(delimiter, quote)
+    , body_(0)
+    , fields_(0)
+    , estimated_size_(0) {
+    init(header);
+}
+
+template <typename Char, typename Traits>
+void basic_offset_sampler<Char, Traits>::init(bool header) {
+    const char_type *p = data_;
+    const char_type *const last = data_ + size_;
+    if (p == last)
+        return;
+
+    row_type row;
+    p = scanner_.read(p, last, row);
+    fields_ = row.size();
+    if (header) {
+        header_.assign(row);
+        body_ = std::size_t(p - data_);
+    } else {
+        p = data_;
+    }
+
+    // The first records give the mean record length.
+    const char_type *const body = p;
+    std::size_t n = 0;
+    for (; n < 64 && p != last; ++n)
+        p = scanner_.skip_record(p, last);
+    if (n > 0) {
+        const double mean = double(p - body) / double(n);
+        estimated_size_ = std::size_t(double(last - body) / mean + 0.5);
+    }
+}
+
+template <typename Char, typename Traits>
+const Char *
+basic_offset_sampler<Char, Traits>::next_line(const char_type *p) const {
+    const char_type *const last = data_ + size_;
+    const char_type *const lf =
+        Traits::find(p, std::size_t(last - p), scanner_.lf);
+    return lf ? lf + 1 : last;
+}
+
+template <typename Char, typename Traits>
+const Char *basic_offset_sampler<Char, Traits>::resync(std::size_t offset,
+                                                       row_type &row) const {
+    const char_type *const body = data_ + body_;
+    const char_type *const last = data_ + size_;
+    const char_type *p = data_ + offset;
+    // A record starts at the body or right after a line feed.
+    if (p != body)
+        p = next_line(p - 1);
+
+    // Past the last line start the search wraps around to the body.
+    for (int pass = 0; pass < 2; ++pass) {
+        for (; p != last; p = next_line(p)) {
+            try {
+                const char_type *const next = scanner_.read(p, last, row);
+                if (row.size() == fields_)
+                    return next;
+            } catch (const std::runtime_error &) {
+                // Started inside a quoted field.
+            }
+        }
+        p = body;
+    }
+    throw std::runtime_error("No record boundary found");
+}
+
+template <typename Char, typename Traits>
+template <typename URNG, typename F>
+void basic_offset_sampler<Char, Traits>::bernoulli(double p, URNG &rng,
+                                                   F fn) const {
+    if (!(p > 0.0))
+        return;
+    std::binomial_distribution<std::size_t> count(estimated_size_,
+                                                  std::min(p, 1.0));
+    sample(count(rng), rng, fn);
+}
+
+template <typename Char, typename Traits>
+template <typename URNG, typename F>
+void basic_offset_sampler<Char, Traits>::blocks(std::size_t n,
+                                                std::size_t block_rows,
+                                                URNG &rng, F fn) const {
+    if (empty() || block_rows == 0)
+        return;
+
+    std::uniform_int_distribution<std::size_t> offset(body_, size_ - 1);
+    std::vector<std::size_t> offsets(n);
+    for (std::size_t i = 0; i < n; ++i)
+        offsets[i] = offset(rng);
+    // Visiting the offsets in order touches each page at most once.
+    std::sort(offsets.begin(), offsets.end());
+
+    const char_type *const last = data_ + size_;
+    row_type row;
+    for (std::size_t i = 0; i < n; ++i) {
+        const char_type *p = resync(offsets[i], row);
+        fn(const_cast<const row_type &>(row));
+        for (std::size_t j = 1; j < block_rows && p != last; ++j) {
+            p = scanner_.read(p, last, row);
+            fn(const_cast<const row_type &>(row));
+        }
+    }
+}
+} // namespace csv
+} // namespace text
+
+#endif
+
+#endif
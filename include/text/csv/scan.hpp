@@ -0,0 +1,77 @@
+#ifndef TEXT_CSV_SCAN_HPP
+#define TEXT_CSV_SCAN_HPP
+
+//          Copyright Roman Kashitsyn 2014 - 2015.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// Scanning of field characters for the symbols that are special in
+// CSV. Narrow characters are classified 16 at a time with SSE2 where
+// available; other character types use a plain loop.
+
+#if defined(__SSE2__) || defined(_M_X64) ||                                    \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TEXT_CSV_HAS_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace text {
+namespace csv {
+namespace detail {
+
+inline int trailing_zeros32(unsigned x) {
+#if defined(__GNUC__)
+    return __builtin_ctz(x);
+#else
+    int n = 0;
+    for (; !(x & 1u); x >>= 1)
+        ++n;
+    return n;
+#endif
+}
+
+/// Returns the first character in [p, end) equal to one of a, b, c and
+/// d, or end.
+template <typename Char>
+const Char *find_special(const Char *p, const Char *end, Char a, Char b,
+                         Char c, Char d) {
+    for (; p != end; ++p) {
+        const Char x = *p;
+        if (x == a || x == b || x == c || x == d)
+            break;
+    }
+    return p;
+}
+
+inline const char *find_special(const char *p, const char *end, char a,
+                                char b, char c, char d) {
+#if defined(TEXT_CSV_HAS_SSE2)
+    const __m128i va = _mm_set1_epi8(a);
+    const __m128i vb = _mm_set1_epi8(b);
+    const __m128i vc = _mm_set1_epi8(c);
+    const __m128i vd = _mm_set1_epi8(d);
+    for (; end - p >= 16; p += 16) {
+        const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        const __m128i ab =
+            _mm_or_si128(_mm_cmpeq_epi8(x, va), _mm_cmpeq_epi8(x, vb));
+        const __m128i cd =
+            _mm_or_si128(_mm_cmpeq_epi8(x, vc), _mm_cmpeq_epi8(x, vd));
+        const __m128i m = _mm_or_si128(ab, cd);
+        const unsigned mask = unsigned(_mm_movemask_epi8(m));
+        if (mask)
+            return p + trailing_zeros32(mask);
+    }
+#endif
+    for (; p != end; ++p) {
+        const char x = *p;
+        if (x == a || x == b || x == c || x == d)
+            break;
+    }
+    return p;
+}
+} // namespace detail
+} // namespace csv
+} // namespace text
+
+#endif
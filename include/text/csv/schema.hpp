@@ -0,0 +1,118 @@
+#ifndef TEXT_CSV_SCHEMA_HPP
+#define TEXT_CSV_SCHEMA_HPP
+
+//          Copyright Roman Kashitsyn 2014 - 2015.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "rows.hpp"
+
+#include <string>
+#include <vector>
+
+namespace text {
+namespace csv {
+
+/// @brief Type of values stored in a column.
+enum column_type {
+    string_column,
+    int64_column,
+    double_column,
+    bool_column,
+    /// Microseconds since the epoch, see timestamp.hpp
+    timestamp_column
+};
+
+/// @brief Describes the columns of a CSV file: names, value types,
+/// nullability and encoding.
+///
+/// @details Columns are described in file order; the i-th spec applies
+/// to the i-th field of every record.
+template <typename Char, typename Traits = std::char_traits<Char> >
+class basic_schema {
+public:
+    typedef Char char_type;
+    typedef std::basic_string<Char, Traits> string_type;
+    typedef basic_header<Char, Traits> header_type;
+
+    struct column_spec {
+        column_spec(const string_type &n, column_type t, bool null)
+            : name(n)
+            , type(t)
+            , nullable(null)
+            , dictionary(false) {}
+
+        string_type name;
+        column_type type;
+        /// Empty and missing fields are stored as nulls. If false,
+        /// missing fields are rejected, and so are empty fields except
+        /// in string columns, where they are empty strings.
+        bool nullable;
+        /// String values are dictionary-encoded while loading.
+        bool dictionary;
+    };
+
+    static const std::size_t npos;
+
+    basic_schema() {}
+
+    /// @brief Creates nullable string columns named after the header.
+    explicit basic_schema(const header_type &header);
+
+    /// @brief Appends a column and returns its index.
+    std::size_t add(const string_type &name, column_type type = string_column,
+                    bool nullable = true);
+
+    std::size_t size() const { return columns_.size(); }
+
+    bool empty() const { return columns_.empty(); }
+
+    column_spec &operator[](std::size_t i) { return columns_[i]; }
+
+    const column_spec &operator[](std::size_t i) const { return columns_[i]; }
+
+    /// @brief Returns index of the column named <tt>name</tt> or npos.
+    std::size_t index_of(const string_type &name) const;
+
+private:
+    std::vector<column_spec> columns_;
+};
+
+typedef basic_schema<char> schema;
+typedef basic_schema<wchar_t> wschema;
+
+// Implementation
+
+template <typename Char, typename Traits>
+const std::size_t basic_schema<Char, Traits>::npos =
+    static_cast<std::size_t>(-1);
+
+template <typename Char, typename Traits>
+basic_schema<Char, Traits>::basic_schema(const header_type &header) {
+    columns_.reserve(header.size());
+    for (std::size_t i = 0, n = header.size(); i < n; ++i) {
+        add(header.name_of(i));
+    }
+}
+
+template <typename Char, typename Traits>
+std::size_t basic_schema<Char, Traits>::add(const string_type &name,
+                                            column_type type, bool nullable) {
+    columns_.push_back(column_spec(name, type, nullable));
+    return columns_.size() - 1;
+}
+
+template <typename Char, typename Traits>
+std::size_t
+basic_schema<Char, Traits>::index_of(const string_type &name) const {
+    for (std::size_t i = 0, n = columns_.size(); i < n; ++i) {
+        if (columns_[i].name == name)
+            return i;
+    }
+    return npos;
+}
+} // namespace csv
+} // namespace text
+
+#endif
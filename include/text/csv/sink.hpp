@@ -0,0 +1,426 @@
+#ifndef TEXT_CSV_SINK_HPP
+#define TEXT_CSV_SINK_HPP
+
+//          Copyright Roman Kashitsyn 2014 - 2015.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define TEXT_CSV_HAS_POSIX_IO 1
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Output sinks
+// ============
+//
+// Stream buffers for basic_csv_ostream output that does not go through a
+// file stream: a memory buffer, a POSIX file descriptor and a memory
+// mapped file. Wrap them in a std::basic_ostream; the writer commits its
+// formatted characters to them with a single sputn() call, which copies
+// them straight into the destination.
+
+namespace text {
+namespace csv {
+namespace detail {
+
+/// Characters collected by bulk writers before they reach the stream.
+inline std::size_t output_block_size() { return std::size_t(1) << 16; }
+
+/// Stream buffer base whose put pointer can be advanced by more than
+/// pbump() accepts.
+template <typename Char, typename Traits>
+class put_buf : public std::basic_streambuf<Char, Traits> {
+protected:
+    void advance(std::size_t n) {
+        for (; n > std::size_t(INT_MAX); n -= std::size_t(INT_MAX))
+            this->pbump(INT_MAX);
+        this->pbump(int(n));
+    }
+};
+
+#if defined(TEXT_CSV_HAS_POSIX_IO)
+
+/// Writes <tt>n</tt> bytes to <tt>fd</tt>, retrying partial and
+/// interrupted writes; returns 0 or the errno value of the failure.
+inline int write_fully(int fd, const void *data, std::size_t n) {
+    const char *p = static_cast<const char *>(data);
+    while (n > 0) {
+        const ssize_t written = ::write(fd, p, n);
+        if (written < 0) {
+            if (errno == EINTR)
+                continue;
+            return errno;
+        }
+        p += written;
+        n -= std::size_t(written);
+    }
+    return 0;
+}
+
+#endif
+} // namespace detail
+
+/// @brief Stream buffer writing into memory.
+///
+/// @details A default constructed buffer grows as needed; its contents
+/// can be taken without copying with swap(). A buffer constructed over
+/// caller-provided memory never grows: writes past its capacity fail,
+/// which sets badbit on the stream.
+template <typename Char, typename Traits = std::char_traits<Char> >
+class basic_memory_buf : public detail::put_buf<Char, Traits> {
+public:
+    typedef Char char_type;
+    typedef Traits traits_type;
+    typedef typename Traits::int_type int_type;
+    typedef std::basic_string<Char, Traits> string_type;
+
+    basic_memory_buf();
+
+    basic_memory_buf(Char *buffer, std::size_t capacity);
+
+    const Char *data() const { return this->pbase(); }
+
+    std::size_t size() const {
+        return std::size_t(this->pptr() - this->pbase());
+    }
+
+    std::size_t capacity() const {
+        return std::size_t(this->epptr() - this->pbase());
+    }
+
+    bool growable() const { return growable_; }
+
+    /// @brief Discards the contents, keeping the memory.
+    void clear() { this->setp(this->pbase(), this->epptr()); }
+
+    /// @brief Exchanges the contents with <tt>s</tt> and clears the
+    /// buffer; the memory of <tt>s</tt> is reused if the buffer grows.
+    void swap(string_type &s);
+
+protected:
+    int_type overflow(int_type c);
+
+    std::streamsize xsputn(const Char *s, std::streamsize n);
+
+private:
+    basic_memory_buf(const basic_memory_buf &);
+    basic_memory_buf &operator=(const basic_memory_buf &);
+
+    /// Makes room for at least <tt>n</tt> characters.
+    bool reserve(std::size_t n);
+
+    string_type str_;
+    bool growable_;
+};
+
+typedef basic_memory_buf<char> memory_buf;
+typedef basic_memory_buf<wchar_t> wmemory_buf;
+
+#if defined(TEXT_CSV_HAS_POSIX_IO)
+
+/// @brief Stream buffer writing to a POSIX file descriptor.
+///
+/// @details Output is collected in a buffer of buffer_size() characters
+/// and written with write() when it is full, on pubsync() and on
+/// destruction; writes of at least a buffer's size go directly to the
+/// descriptor. A zero buffer size writes every sputn() call as it is.
+/// The descriptor is not closed. The errno value of a failed write is
+/// kept in error(), and output fails from then on.
+template <typename Char, typename Traits = std::char_traits<Char> >
+class basic_fd_buf : public detail::put_buf<Char, Traits> {
+public:
+    typedef Char char_type;
+    typedef Traits traits_type;
+    typedef typename Traits::int_type int_type;
+
+    explicit basic_fd_buf(int fd, std::size_t buffer_size = 1 << 16);
+
+    /// @brief Writes buffered output, ignoring errors.
+    ~basic_fd_buf();
+
+    int fd() const { return fd_; }
+
+    int error() const { return error_; }
+
+protected:
+    int_type overflow(int_type c);
+
+    std::streamsize xsputn(const Char *s, std::streamsize n);
+
+    int sync();
+
+private:
+    basic_fd_buf(const basic_fd_buf &);
+    basic_fd_buf &operator=(const basic_fd_buf &);
+
+    bool write_out(const Char *s, std::size_t n);
+
+    bool flush_buffer();
+
+    int fd_;
+    int error_;
+    std::vector<Char> buf_;
+};
+
+typedef basic_fd_buf<char> fd_buf;
+typedef basic_fd_buf<wchar_t> wfd_buf;
+
+/// @brief Stream buffer writing into a memory mapped file of fixed
+/// capacity.
+///
+/// @details The file is created (or truncated) with room for
+/// <tt>capacity</tt> characters and mapped into memory, so output is
+/// written to it without system calls; writes past the capacity fail.
+/// close() unmaps the file and truncates it to the characters written.
+template <typename Char, typename Traits = std::char_traits<Char> >
+class basic_mmap_buf : public std::basic_streambuf<Char, Traits> {
+public:
+    typedef Char char_type;
+    typedef Traits traits_type;
+    typedef typename Traits::int_type int_type;
+
+    /// @brief Creates the file; throws std::runtime_error on failure.
+    basic_mmap_buf(const std::string &path, std::size_t capacity);
+
+    /// @brief Closes the file, ignoring errors.
+    ~basic_mmap_buf();
+
+    /// @brief Unmaps and truncates the file; throws std::runtime_error
+    /// on failure.
+    void close();
+
+    /// @brief Returns the number of characters written.
+    std::size_t size() const {
+        return fd_ < 0 ? size_ : std::size_t(this->pptr() - this->pbase());
+    }
+
+    std::size_t capacity() const { return capacity_; }
+
+protected:
+    int_type overflow(int_type c);
+
+private:
+    basic_mmap_buf(const basic_mmap_buf &);
+    basic_mmap_buf &operator=(const basic_mmap_buf &);
+
+    int fd_;
+    Char *data_;
+    std::size_t capacity_;
+    std::size_t size_;
+};
+
+typedef basic_mmap_buf<char> mmap_buf;
+typedef basic_mmap_buf<wchar_t> wmmap_buf;
+
+#endif
+
+// Implementation
+
+template <typename Char, typename Traits>
+basic_memory_buf<Char, Traits>::basic_memory_buf()
+    : growable_(true) {}
+
+template <typename Char, typename Traits>
+basic_memory_buf<Char, Traits>::basic_memory_buf(Char *buffer,
+                                                 std::size_t capacity)
+    : growable_(false) {
+    this->setp(buffer, buffer + capacity);
+}
+
+template <typename Char, typename Traits>
+void basic_memory_buf<Char, Traits>::swap(string_type &s) {
+    if (!growable_) {
+        s.assign(data(), size());
+        clear();
+        return;
+    }
+    str_.resize(size());
+    str_.swap(s);
+    str_.resize(str_.capacity());
+    Char *const p = str_.empty() ? 0 : &str_[0];
+    this->setp(p, p + str_.size());
+}
+
+template <typename Char, typename Traits>
+bool basic_memory_buf<Char, Traits>::reserve(std::size_t n) {
+    if (n <= capacity())
+        return true;
+    if (!growable_)
+        return false;
+    const std::size_t used = size();
+    str_.resize(std::max(std::max(n, 2 * str_.size()), std::size_t(256)));
+    this->setp(&str_[0], &str_[0] + str_.size());
+    this->advance(used);
+    return true;
+}
+
+template <typename Char, typename Traits>
+typename basic_memory_buf<Char, Traits>::int_type
+basic_memory_buf<Char, Traits>::overflow(int_type c) {
+    if (traits_type::eq_int_type(c, traits_type::eof()))
+        return traits_type::not_eof(c);
+    if (!reserve(size() + 1))
+        return traits_type::eof();
+    *this->pptr() = traits_type::to_char_type(c);
+    this->pbump(1);
+    return c;
+}
+
+template <typename Char, typename Traits>
+std::streamsize basic_memory_buf<Char, Traits>::xsputn(const Char *s,
+                                                       std::streamsize n) {
+    std::size_t count = std::size_t(n);
+    if (!reserve(size() + count))
+        count = capacity() - size();
+    traits_type::copy(this->pptr(), s, count);
+    this->advance(count);
+    return std::streamsize(count);
+}
+
+#if defined(TEXT_CSV_HAS_POSIX_IO)
+
+template <typename Char, typename Traits>
+basic_fd_buf<Char, Traits>::basic_fd_buf(int fd, std::size_t buffer_size)
+    : fd_(fd)
+    , error_(0)
+    , buf_(buffer_size) {
+    if (!buf_.empty())
+        this->setp(&buf_[0], &buf_[0] + buf_.size());
+}
+
+template <typename Char, typename Traits>
+basic_fd_buf<Char, Traits>::~basic_fd_buf() {
+    flush_buffer();
+}
+
+template <typename Char, typename Traits>
+bool basic_fd_buf<Char, Traits>::write_out(const Char *s, std::size_t n) {
+    if (error_)
+        return false;
+    error_ = detail::write_fully(fd_, s, n * sizeof(Char));
+    return error_ == 0;
+}
+
+template <typename Char, typename Traits>
+bool basic_fd_buf<Char, Traits>::flush_buffer() {
+    const std::size_t n = std::size_t(this->pptr() - this->pbase());
+    this->setp(this->pbase(), this->epptr());
+    return n == 0 || write_out(this->pbase(), n);
+}
+
+template <typename Char, typename Traits>
+typename basic_fd_buf<Char, Traits>::int_type
+basic_fd_buf<Char, Traits>::overflow(int_type c) {
+    if (!flush_buffer())
+        return traits_type::eof();
+    if (traits_type::eq_int_type(c, traits_type::eof()))
+        return traits_type::not_eof(c);
+    const Char ch = traits_type::to_char_type(c);
+    if (this->pptr() == this->epptr())
+        return write_out(&ch, 1) ? c : traits_type::eof();
+    *this->pptr() = ch;
+    this->pbump(1);
+    return c;
+}
+
+template <typename Char, typename Traits>
+std::streamsize basic_fd_buf<Char, Traits>::xsputn(const Char *s,
+                                                   std::streamsize n) {
+    const std::size_t count = std::size_t(n);
+    if (count <= std::size_t(this->epptr() - this->pptr())) {
+        traits_type::copy(this->pptr(), s, count);
+        this->advance(count);
+        return n;
+    }
+    if (!flush_buffer())
+        return 0;
+    if (count < buf_.size()) {
+        traits_type::copy(this->pptr(), s, count);
+        this->advance(count);
+        return n;
+    }
+    return write_out(s, count) ? n : 0;
+}
+
+template <typename Char, typename Traits>
+int basic_fd_buf<Char, Traits>::sync() {
+    return flush_buffer() ? 0 : -1;
+}
+
+template <typename Char, typename Traits>
+basic_mmap_buf<Char, Traits>::basic_mmap_buf(const std::string &path,
+                                             std::size_t capacity)
+    : fd_(::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0666))
+    , data_(0)
+    , capacity_(capacity)
+    , size_(0) {
+    if (fd_ < 0) {
+        throw std::runtime_error("Cannot create output file");
+    }
+    const std::size_t bytes = capacity * sizeof(Char);
+    if (bytes > 0) {
+        void *p = MAP_FAILED;
+        if (::ftruncate(fd_, off_t(bytes)) == 0)
+            p = ::mmap(0, bytes, PROT_WRITE, MAP_SHARED, fd_, 0);
+        if (p == MAP_FAILED) {
+            ::close(fd_);
+            throw std::runtime_error("Cannot map output file");
+        }
+        data_ = static_cast<Char *>(p);
+    }
+    this->setp(data_, data_ + capacity_);
+}
+
+template <typename Char, typename Traits>
+basic_mmap_buf<Char, Traits>::~basic_mmap_buf() {
+    try {
+        close();
+    } catch (...) {
+    }
+}
+
+template <typename Char, typename Traits>
+void basic_mmap_buf<Char, Traits>::close() {
+    if (fd_ < 0)
+        return;
+    size_ = std::size_t(this->pptr() - this->pbase());
+    this->setp(0, 0);
+    bool ok = true;
+    if (data_)
+        ok = ::munmap(data_, capacity_ * sizeof(Char)) == 0;
+    data_ = 0;
+    ok = ::ftruncate(fd_, off_t(size_ * sizeof(Char))) == 0 && ok;
+    ok = ::close(fd_) == 0 && ok;
+    fd_ = -1;
+    if (!ok) {
+        throw std::runtime_error("Cannot write output file");
+    }
+}
+
+template <typename Char, typename Traits>
+typename basic_mmap_buf<Char, Traits>::int_type
+basic_mmap_buf<Char, Traits>::overflow(int_type c) {
+    // The mapping is full.
+    return traits_type::eq_int_type(c, traits_type::eof())
+               ? traits_type::not_eof(c)
+               : traits_type::eof();
+}
+
+#endif
+} // namespace csv
+} // namespace text
+
+#endif
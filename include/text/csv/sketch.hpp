@@ -0,0 +1,251 @@
+#ifndef TEXT_CSV_SKETCH_HPP
+#define TEXT_CSV_SKETCH_HPP
+
+//          Copyright Roman Kashitsyn 2014 - 2015.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include <stdint.h>
+
+// Mergeable sketches of a stream of values in bounded memory. Sketches
+// built over disjoint parts of the input can be merged into the sketch
+// of the whole input.
+
+namespace text {
+namespace csv {
+namespace detail {
+
+inline int leading_zeros64(uint64_t x) {
+#if defined(__GNUC__)
+    return x ? __builtin_clzll(x) : 64;
+#else
+    int n = 0;
+    for (uint64_t bit = uint64_t(1) << 63; bit && !(x & bit); bit >>= 1)
+        ++n;
+    return n;
+#endif
+}
+} // namespace detail
+
+/// @brief Approximate count of distinct values (HyperLogLog).
+///
+/// @details Uses 2^precision one-byte registers; the standard error of
+/// the estimate is about 1.04 / sqrt(2^precision), i.e. 1.6% for the
+/// default precision of 12. Values are added by their 64-bit hash, see
+/// hash.hpp.
+class hyperloglog {
+public:
+    explicit hyperloglog(unsigned precision = 12)
+        : precision_(precision) {
+        if (precision < 4 || precision > 18) {
+            throw std::invalid_argument("HyperLogLog precision out of range");
+        }
+        registers_.assign(std::size_t(1) << precision, 0);
+    }
+
+    void add(uint64_t hash) {
+        const std::size_t i = std::size_t(hash >> (64 - precision_));
+        const uint64_t rest = hash << precision_;
+        const unsigned char rank =
+            rest ? static_cast<unsigned char>(detail::leading_zeros64(rest) + 1)
+                 : static_cast<unsigned char>(64 - precision_ + 1);
+        if (rank > registers_[i])
+            registers_[i] = rank;
+    }
+
+    /// @brief Adds the values of <tt>other</tt>, which must have the same
+    /// precision.
+    void merge(const hyperloglog &other) {
+        if (other.precision_ != precision_) {
+            throw std::invalid_argument("HyperLogLog precisions differ");
+        }
+        for (std::size_t i = 0; i < registers_.size(); ++i) {
+            if (other.registers_[i] > registers_[i])
+                registers_[i] = other.registers_[i];
+        }
+    }
+
+    /// @brief Returns the estimated number of distinct values.
+    double estimate() const;
+
+    unsigned precision() const { return precision_; }
+
+    void clear() { std::fill(registers_.begin(), registers_.end(), 0); }
+
+private:
+    unsigned precision_;
+    std::vector<unsigned char> registers_;
+};
+
+/// @brief Approximate quantiles of a stream of numbers (KLL sketch).
+///
+/// @details Values are kept in a hierarchy of compactors; when a level
+/// is full it is sorted and every other value is promoted to the next
+/// level with twice the weight. Memory is about 3k values regardless of
+/// the stream length, and the rank error is about 1.7 / k for the
+/// default k of 200. Compaction uses a deterministic pseudo-random
+/// sequence, so results are reproducible. NaN has no rank and is
+/// ignored by add().
+class quantile_sketch {
+public:
+    explicit quantile_sketch(std::size_t k = 200)
+        : k_(k < 8 ? 8 : k)
+        , count_(0)
+        , size_(0)
+        , capacity_(0)
+        , coin_(0x9e3779b97f4a7c15ULL) {
+        resize(1);
+    }
+
+    void add(double x) {
+        if (x != x)
+            return;
+        levels_[0].push_back(x);
+        ++count_;
+        if (++size_ > capacity_)
+            compress();
+    }
+
+    /// @brief Adds the values of <tt>other</tt>.
+    void merge(const quantile_sketch &other);
+
+    /// @brief Returns the value of rank approximately <tt>q</tt> * count(),
+    /// or NaN if no values were added.
+    double quantile(double q) const;
+
+    /// @brief Returns number of values added.
+    uint64_t count() const { return count_; }
+
+    /// @brief Returns number of values retained.
+    std::size_t size() const { return size_; }
+
+    void clear() {
+        levels_.clear();
+        resize(1);
+        count_ = 0;
+        size_ = 0;
+    }
+
+private:
+    std::size_t capacity(std::size_t level) const {
+        double c = double(k_);
+        for (std::size_t d = level + 1; d < levels_.size(); ++d)
+            c *= 2.0 / 3.0;
+        return c < 2 ? 2 : std::size_t(c);
+    }
+
+    /// Resizes to <tt>levels</tt> levels and recomputes the total
+    /// capacity, which changes only with the number of levels.
+    void resize(std::size_t levels) {
+        levels_.resize(levels);
+        capacity_ = 0;
+        for (std::size_t h = 0; h < levels_.size(); ++h)
+            capacity_ += capacity(h);
+    }
+
+    bool flip() {
+        coin_ ^= coin_ << 13;
+        coin_ ^= coin_ >> 7;
+        coin_ ^= coin_ << 17;
+        return coin_ & 1;
+    }
+
+    void compress();
+
+private:
+    std::size_t k_;
+    uint64_t count_;
+    std::size_t size_;
+    std::size_t capacity_;
+    uint64_t coin_;
+    std::vector<std::vector<double> > levels_;
+};
+
+// Implementation
+
+inline double hyperloglog::estimate() const {
+    const double m = double(registers_.size());
+    double sum = 0;
+    std::size_t zeros = 0;
+    for (std::size_t i = 0; i < registers_.size(); ++i) {
+        sum += std::ldexp(1.0, -int(registers_[i]));
+        if (registers_[i] == 0)
+            ++zeros;
+    }
+    const double alpha = 0.7213 / (1 + 1.079 / m);
+    const double e = alpha * m * m / sum;
+    if (e <= 2.5 * m && zeros) {
+        // Linear counting is more accurate for small cardinalities.
+        return m * std::log(m / double(zeros));
+    }
+    return e;
+}
+
+inline void quantile_sketch::compress() {
+    for (std::size_t h = 0; h < levels_.size(); ++h) {
+        if (levels_[h].size() < capacity(h))
+            continue;
+        if (h + 1 == levels_.size())
+            resize(h + 2);
+
+        std::vector<double> &v = levels_[h];
+        std::vector<double> &up = levels_[h + 1];
+        std::sort(v.begin(), v.end());
+        // An odd value out stays on this level.
+        const std::size_t start = v.size() % 2;
+        const std::size_t n = v.size() - start;
+        for (std::size_t i = start + (flip() ? 1 : 0); i < v.size(); i += 2)
+            up.push_back(v[i]);
+        v.resize(start);
+        size_ -= n / 2;
+        return;
+    }
+}
+
+inline void quantile_sketch::merge(const quantile_sketch &other) {
+    if (other.levels_.size() > levels_.size())
+        resize(other.levels_.size());
+    for (std::size_t h = 0; h < other.levels_.size(); ++h) {
+        levels_[h].insert(levels_[h].end(), other.levels_[h].begin(),
+                          other.levels_[h].end());
+    }
+    count_ += other.count_;
+    size_ += other.size_;
+    while (size_ > capacity_)
+        compress();
+}
+
+inline double quantile_sketch::quantile(double q) const {
+    if (count_ == 0)
+        return std::numeric_limits<double>::quiet_NaN();
+
+    std::vector<std::pair<double, uint64_t> > items;
+    items.reserve(size_);
+    for (std::size_t h = 0; h < levels_.size(); ++h) {
+        for (std::size_t i = 0; i < levels_[h].size(); ++i) {
+            items.push_back(std::make_pair(levels_[h][i], uint64_t(1) << h));
+        }
+    }
+    std::sort(items.begin(), items.end());
+
+    const double target = (q < 0 ? 0 : q > 1 ? 1 : q) * double(count_);
+    uint64_t rank = 0;
+    for (std::size_t i = 0; i < items.size(); ++i) {
+        rank += items[i].second;
+        if (double(rank) >= target)
+            return items[i].first;
+    }
+    return items.back().first;
+}
+} // namespace csv
+} // namespace text
+
+#endif
@@ -0,0 +1,586 @@
+#ifndef TEXT_CSV_SORT_HPP
+#define TEXT_CSV_SORT_HPP
+
+//          Copyright Roman Kashitsyn 2014 - 2015.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "batch.hpp"
+#include "schema.hpp"
+#include "sink.hpp"
+#include "temp_files.hpp"
+#include "timestamp.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if __cplusplus >= 201103
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#endif
+
+// External merge sort
+// ===================
+//
+// basic_external_sort orders files larger than memory. Records are
+// read in runs bounded by a memory budget; each run is sorted and
+// spilled to a temporary file written with basic_csv_ostream, and the
+// runs are combined with a k-way merge. Since records are parsed as
+// CSV, quoted fields with embedded line breaks are handled correctly.
+//
+// With C++11, runs are sorted and spilled by worker threads while the
+// next run is being read.
+
+namespace text {
+namespace csv {
+
+/// @brief A column to order records by.
+struct sort_key {
+    sort_key(std::size_t col, column_type t = string_column, bool desc = false)
+        : column(col)
+        , type(t)
+        , descending(desc) {}
+
+    std::size_t column;
+    /// string_column compares fields lexicographically; other types
+    /// compare converted values. Empty, missing and invalid values, and
+    /// NaN in double columns, order before valid ones.
+    column_type type;
+    bool descending;
+};
+
+namespace detail {
+
+template <typename Char, typename Traits>
+struct key_value {
+    basic_field_view<Char, Traits> field;
+    int64_t integer;
+    double real;
+    bool valid;
+};
+
+template <typename Char, typename Traits>
+void make_key(const sort_key &k, const basic_field_view<Char, Traits> &f,
+              key_value<Char, Traits> &v) {
+    v.field = f;
+    v.integer = 0;
+    v.real = 0;
+    v.valid = true;
+    if (k.type == string_column)
+        return;
+
+    if (f.empty()) {
+        v.valid = false;
+        return;
+    }
+
+    const Char *const b = f.begin();
+    const Char *const e = f.end();
+    switch (k.type) {
+    case int64_column:
+        v.valid = convert<int64_t>::parse(b, e, v.integer);
+        break;
+    case double_column:
+        // NaN is unordered, so it is sorted with the invalid values.
+        v.valid = convert<double>::parse(b, e, v.real) && v.real == v.real;
+        break;
+    case bool_column: {
+        bool x = false;
+        v.valid = convert<bool>::parse(b, e, x);
+        v.integer = x;
+        break;
+    }
+    case timestamp_column: {
+        timestamp ts;
+        v.valid = convert<timestamp>::parse(b, e, ts);
+        v.integer = ts.micros;
+        break;
+    }
+    case string_column:
+        break;
+    }
+}
+
+template <typename Char, typename Traits>
+int compare_keys(const std::vector<sort_key> &keys,
+                 const key_value<Char, Traits> *a,
+                 const key_value<Char, Traits> *b) {
+    for (std::size_t i = 0, n = keys.size(); i < n; ++i) {
+        int c;
+        if (a[i].valid != b[i].valid) {
+            c = a[i].valid ? 1 : -1;
+        } else if (keys[i].type == string_column || !a[i].valid) {
+            c = a[i].field.compare(b[i].field);
+        } else if (keys[i].type == double_column) {
+            c = a[i].real < b[i].real ? -1 : (b[i].real < a[i].real ? 1 : 0);
+        } else {
+            c = a[i].integer < b[i].integer
+                    ? -1
+                    : (b[i].integer < a[i].integer ? 1 : 0);
+        }
+        if (c != 0)
+            return keys[i].descending ? -c : c;
+    }
+    return 0;
+}
+
+/// A block of records sorted in memory.
+template <typename Char, typename Traits>
+struct sort_run {
+    typedef basic_row_batch<Char, Traits> batch_type;
+    typedef basic_field_view<Char, Traits> field_type;
+    typedef key_value<Char, Traits> key_type;
+
+    struct ref {
+        std::size_t batch;
+        std::size_t row;
+    };
+
+    struct less {
+        less(const std::vector<sort_key> &k, const key_type *v)
+            : keys(&k)
+            , values(v) {}
+
+        bool operator()(std::size_t a, std::size_t b) const {
+            const std::size_t n = keys->size();
+            return compare_keys(*keys, values + a * n, values + b * n) < 0;
+        }
+
+        const std::vector<sort_key> *keys;
+        const key_type *values;
+    };
+
+    sort_run()
+        : memory(0) {}
+
+    /// Reads records until the run uses <tt>budget</tt> bytes.
+    bool fill(basic_batch_reader<Char, Traits> &reader, std::size_t budget);
+
+    void write(const std::vector<sort_key> &keys,
+               std::basic_ostream<Char, Traits> &out) const;
+
+    std::deque<batch_type> batches;
+    std::size_t memory;
+};
+
+template <typename Char, typename Traits>
+bool sort_run<Char, Traits>::fill(basic_batch_reader<Char, Traits> &reader,
+                                  std::size_t budget) {
+    while (memory < budget) {
+        batches.push_back(batch_type());
+        if (!reader.next(batches.back())) {
+            batches.pop_back();
+            break;
+        }
+        memory += batches.back().memory_size();
+    }
+    return !batches.empty();
+}
+
+template <typename Char, typename Traits>
+void sort_run<Char, Traits>::write(const std::vector<sort_key> &keys,
+                                   std::basic_ostream<Char, Traits> &out) const {
+    std::vector<ref> refs;
+    for (std::size_t b = 0; b < batches.size(); ++b) {
+        for (std::size_t r = 0, n = batches[b].size(); r < n; ++r) {
+            const ref x = { b, r };
+            refs.push_back(x);
+        }
+    }
+
+    const std::size_t k = keys.size();
+    std::vector<key_type> values(refs.size() * k);
+    for (std::size_t i = 0; i < refs.size(); ++i) {
+        const batch_type &batch = batches[refs[i].batch];
+        const std::size_t fields = batch.field_count(refs[i].row);
+        for (std::size_t j = 0; j < k; ++j) {
+            const std::size_t col = keys[j].column;
+            make_key(keys[j],
+                     col < fields ? batch.field(refs[i].row, col)
+                                  : field_type(),
+                     values[i * k + j]);
+        }
+    }
+
+    std::vector<std::size_t> order(refs.size());
+    for (std::size_t i = 0; i < order.size(); ++i)
+        order[i] = i;
+    std::stable_sort(order.begin(), order.end(),
+                     less(keys, values.empty() ? 0 : &values[0]));
+
+    basic_csv_ostream<Char, Traits> csv(out);
+    csv.buffer_size(output_block_size());
+    for (std::size_t i = 0; i < order.size(); ++i) {
+        const ref &x = refs[order[i]];
+        const batch_type &batch = batches[x.batch];
+        for (std::size_t c = 0, n = batch.field_count(x.row); c < n; ++c) {
+            csv << batch.field(x.row, c);
+        }
+        csv.end_line();
+    }
+    csv.flush();
+}
+
+/// Current record of one of the merged inputs.
+template <typename Char, typename Traits>
+struct merge_cursor {
+    typedef basic_field_view<Char, Traits> field_type;
+
+    merge_cursor(std::basic_istream<Char, Traits> &in, std::size_t k)
+        : is(in)
+        , values(k)
+        , done(false) {}
+
+    void advance(const std::vector<sort_key> &keys) {
+        if (!is) {
+            done = true;
+            return;
+        }
+        is >> row;
+        for (std::size_t j = 0; j < keys.size(); ++j) {
+            const std::size_t col = keys[j].column;
+            make_key(keys[j],
+                     col < row.size() ? field_type(row[col]) : field_type(),
+                     values[j]);
+        }
+    }
+
+    basic_csv_istream<Char, Traits> is;
+    basic_row<Char, Traits> row;
+    std::vector<key_value<Char, Traits> > values;
+    bool done;
+};
+
+/// Orders cursor indices for a min-heap; ties go to the earlier input.
+template <typename Char, typename Traits>
+struct cursor_greater {
+    cursor_greater(const std::vector<sort_key> &k,
+                   const std::vector<merge_cursor<Char, Traits> *> &c)
+        : keys(&k)
+        , cursors(&c) {}
+
+    bool operator()(std::size_t a, std::size_t b) const {
+        const int c = compare_keys(*keys, &(*cursors)[a]->values[0],
+                                   &(*cursors)[b]->values[0]);
+        return c != 0 ? c > 0 : a > b;
+    }
+
+    const std::vector<sort_key> *keys;
+    const std::vector<merge_cursor<Char, Traits> *> *cursors;
+};
+
+/// Merges sorted inputs into <tt>out</tt>. If <tt>header</tt> is true,
+/// the first record of every input is skipped and the first input's
+/// one is written out.
+template <typename Char, typename Traits>
+void merge_streams(const std::vector<std::basic_istream<Char, Traits> *> &in,
+                   std::basic_ostream<Char, Traits> &out,
+                   const std::vector<sort_key> &keys, bool header) {
+    typedef merge_cursor<Char, Traits> cursor;
+    const std::vector<sort_key> &k = keys;
+    // Key arrays must not be empty to take their address.
+    const std::size_t slots = k.empty() ? 1 : k.size();
+
+    std::vector<cursor *> cursors;
+    try {
+        basic_csv_ostream<Char, Traits> csv(out);
+        csv.buffer_size(output_block_size());
+        std::vector<std::size_t> heap;
+        const cursor_greater<Char, Traits> greater(k, cursors);
+
+        for (std::size_t i = 0; i < in.size(); ++i) {
+            cursors.push_back(new cursor(*in[i], slots));
+            if (header) {
+                basic_row<Char, Traits> h;
+                cursors.back()->is >> h;
+                if (i == 0)
+                    csv << h;
+            }
+            cursors.back()->advance(k);
+            if (!cursors.back()->done) {
+                heap.push_back(i);
+                std::push_heap(heap.begin(), heap.end(), greater);
+            }
+        }
+
+        while (!heap.empty()) {
+            std::pop_heap(heap.begin(), heap.end(), greater);
+            cursor &c = *cursors[heap.back()];
+            csv << c.row;
+            c.advance(k);
+            if (c.done) {
+                heap.pop_back();
+            } else {
+                std::push_heap(heap.begin(), heap.end(), greater);
+            }
+        }
+        csv.flush();
+    } catch (...) {
+        for (std::size_t i = 0; i < cursors.size(); ++i)
+            delete cursors[i];
+        throw;
+    }
+    for (std::size_t i = 0; i < cursors.size(); ++i)
+        delete cursors[i];
+}
+
+template <typename Char, typename Traits>
+void merge_files(const std::vector<std::string> &names,
+                 std::basic_ostream<Char, Traits> &out,
+                 const std::vector<sort_key> &keys) {
+    typedef std::basic_ifstream<Char, Traits> file_type;
+    std::vector<file_type *> files;
+    std::vector<std::basic_istream<Char, Traits> *> streams;
+    try {
+        for (std::size_t i = 0; i < names.size(); ++i) {
+            files.push_back(
+                new file_type(names[i].c_str(), std::ios_base::binary));
+            if (!*files.back()) {
+                throw std::runtime_error("Cannot open temporary file");
+            }
+            streams.push_back(files.back());
+        }
+        merge_streams(streams, out, keys, false);
+    } catch (...) {
+        for (std::size_t i = 0; i < files.size(); ++i)
+            delete files[i];
+        throw;
+    }
+    for (std::size_t i = 0; i < files.size(); ++i)
+        delete files[i];
+}
+
+template <typename Char, typename Traits>
+void spill_run(const sort_run<Char, Traits> &run,
+               const std::vector<sort_key> &keys, const std::string &name) {
+    std::basic_ofstream<Char, Traits> out(name.c_str(), std::ios_base::binary);
+    run.write(keys, out);
+    out.flush();
+    if (!out) {
+        throw std::runtime_error("Cannot write temporary file");
+    }
+}
+} // namespace detail
+
+/// @brief Merges inputs that are already sorted by <tt>keys</tt>.
+///
+/// @details If <tt>has_header</tt> is true, every input starts with a
+/// header record; the header of the first input is copied to the output.
+/// Records with equal keys keep the order of the inputs.
+template <typename Char, typename Traits>
+void merge_sorted(const std::vector<std::basic_istream<Char, Traits> *> &in,
+                  std::basic_ostream<Char, Traits> &out,
+                  const std::vector<sort_key> &keys, bool has_header = false) {
+    detail::merge_streams(in, out, keys, has_header);
+}
+
+/// @brief Sorts CSV files that do not fit in memory.
+///
+/// @details The sort is stable. Memory used by records in flight is
+/// bounded by memory_budget(); runs that do not fit are spilled to
+/// temp_directory() and merged at most max_fan_in() at a time.
+template <typename Char, typename Traits = std::char_traits<Char> >
+class basic_external_sort {
+public:
+    typedef std::basic_istream<Char, Traits> istream_type;
+    typedef std::basic_ostream<Char, Traits> ostream_type;
+
+    basic_external_sort()
+        : memory_budget_(std::size_t(256) << 20)
+        , threads_(1)
+        , max_fan_in_(64)
+        , has_header_(false)
+        , temp_directory_(detail::default_temp_directory()) {}
+
+    /// @brief Appends a key; records are ordered by the first key, ties
+    /// are broken by the following ones.
+    void add_key(const sort_key &key) { keys_.push_back(key); }
+
+    const std::vector<sort_key> &keys() const { return keys_; }
+
+    std::size_t memory_budget() const { return memory_budget_; }
+
+    void memory_budget(std::size_t bytes) { memory_budget_ = bytes; }
+
+    /// @brief Number of threads sorting and spilling runs. Ignored
+    /// without C++11.
+    unsigned threads() const { return threads_; }
+
+    void threads(unsigned n) { threads_ = n ? n : 1; }
+
+    std::size_t max_fan_in() const { return max_fan_in_; }
+
+    void max_fan_in(std::size_t n) { max_fan_in_ = n < 2 ? 2 : n; }
+
+    bool has_header() const { return has_header_; }
+
+    void has_header(bool h) { has_header_ = h; }
+
+    const std::string &temp_directory() const { return temp_directory_; }
+
+    void temp_directory(const std::string &dir) { temp_directory_ = dir; }
+
+    /// @brief Writes records of <tt>in</tt> to <tt>out</tt> in order.
+    void sort(istream_type &in, ostream_type &out) const;
+
+private:
+    typedef detail::sort_run<Char, Traits> run_type;
+
+    void write_header(const basic_header<Char, Traits> &h,
+                      ostream_type &out) const;
+
+    void merge(std::vector<std::string> runs, detail::temp_files &tmp,
+               ostream_type &out) const;
+
+private:
+    std::vector<sort_key> keys_;
+    std::size_t memory_budget_;
+    unsigned threads_;
+    std::size_t max_fan_in_;
+    bool has_header_;
+    std::string temp_directory_;
+};
+
+typedef basic_external_sort<char> external_sort;
+typedef basic_external_sort<wchar_t> wexternal_sort;
+
+// Implementation
+
+template <typename Char, typename Traits>
+void basic_external_sort<Char, Traits>::write_header(
+    const basic_header<Char, Traits> &h, ostream_type &out) const {
+    basic_csv_ostream<Char, Traits> csv(out);
+    for (std::size_t i = 0; i < h.size(); ++i) {
+        csv << h.name_of(i);
+    }
+    csv.end_line();
+}
+
+template <typename Char, typename Traits>
+void basic_external_sort<Char, Traits>::sort(istream_type &in,
+                                             ostream_type &out) const {
+    basic_batch_reader<Char, Traits> reader(in);
+    reader.batch_size(64);
+    if (has_header_) {
+        write_header(reader.read_header(), out);
+    }
+
+#if __cplusplus >= 201103
+    // One run is being read while the workers sort the others.
+    const std::size_t in_flight = threads_ > 1 ? threads_ + 1 : 1;
+#else
+    const std::size_t in_flight = 1;
+#endif
+    std::size_t budget = memory_budget_ / in_flight;
+    if (budget == 0)
+        budget = 1;
+
+    detail::temp_files tmp(temp_directory_);
+    std::vector<std::string> runs;
+
+#if __cplusplus >= 201103
+    std::deque<std::thread> workers;
+    std::mutex error_mutex;
+    std::exception_ptr error;
+
+    struct join_guard {
+        std::deque<std::thread> &workers;
+        ~join_guard() {
+            for (std::thread &t : workers)
+                t.join();
+        }
+    } guard{ workers };
+#endif
+
+    for (;;) {
+#if __cplusplus >= 201103
+        std::shared_ptr<run_type> run(new run_type);
+#else
+        run_type storage;
+        run_type *const run = &storage;
+#endif
+        if (!run->fill(reader, budget))
+            break;
+
+        if (runs.empty() && !reader.stream()) {
+            // Everything fits in memory.
+            run->write(keys_, out);
+            return;
+        }
+
+        runs.push_back(tmp.create());
+
+#if __cplusplus >= 201103
+        if (threads_ > 1) {
+            if (workers.size() >= threads_) {
+                workers.front().join();
+                workers.pop_front();
+            }
+            const std::string name = runs.back();
+            const std::vector<sort_key> &keys = keys_;
+            workers.emplace_back([run, name, &keys, &error, &error_mutex] {
+                try {
+                    detail::spill_run(*run, keys, name);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(error_mutex);
+                    if (!error)
+                        error = std::current_exception();
+                }
+            });
+            continue;
+        }
+#endif
+        detail::spill_run(*run, keys_, runs.back());
+    }
+
+#if __cplusplus >= 201103
+    while (!workers.empty()) {
+        workers.front().join();
+        workers.pop_front();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+#endif
+
+    merge(runs, tmp, out);
+}
+
+template <typename Char, typename Traits>
+void basic_external_sort<Char, Traits>::merge(std::vector<std::string> runs,
+                                              detail::temp_files &tmp,
+                                              ostream_type &out) const {
+    while (runs.size() > max_fan_in_) {
+        std::vector<std::string> merged;
+        for (std::size_t i = 0; i < runs.size(); i += max_fan_in_) {
+            const std::size_t end = std::min(runs.size(), i + max_fan_in_);
+            const std::vector<std::string> group(runs.begin() + i,
+                                                 runs.begin() + end);
+            merged.push_back(tmp.create());
+            std::basic_ofstream<Char, Traits> f(merged.back().c_str(),
+                                                std::ios_base::binary);
+            detail::merge_files(group, f, keys_);
+            f.flush();
+            if (!f) {
+                throw std::runtime_error("Cannot write temporary file");
+            }
+            for (std::size_t j = 0; j < group.size(); ++j) {
+                std::remove(group[j].c_str());
+            }
+        }
+        runs.swap(merged);
+    }
+    detail::merge_files(runs, out, keys_);
+}
+} // namespace csv
+} // namespace text
+
+#endif
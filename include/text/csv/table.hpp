@@ -0,0 +1,373 @@
+#ifndef TEXT_CSV_TABLE_HPP
+#define TEXT_CSV_TABLE_HPP
+
+//          Copyright Roman Kashitsyn 2014 - 2015.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "batch.hpp"
+#include "schema.hpp"
+#include "timestamp.hpp"
+
+#include <istream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace text {
+namespace csv {
+
+/// @brief Growable sequence of bits packed into 64-bit words.
+class bitmap {
+public:
+    bitmap()
+        : size_(0) {}
+
+    void push_back(bool bit) {
+        if (size_ % 64 == 0)
+            words_.push_back(0);
+        if (bit)
+            words_.back() |= uint64_t(1) << (size_ % 64);
+        ++size_;
+    }
+
+    bool operator[](std::size_t i) const {
+        return (words_[i / 64] >> (i % 64)) & 1;
+    }
+
+    std::size_t size() const { return size_; }
+
+    /// @brief Returns number of set bits.
+    std::size_t count() const;
+
+    const uint64_t *data() const { return words_.empty() ? 0 : &words_[0]; }
+
+    void reserve(std::size_t n) { words_.reserve((n + 63) / 64); }
+
+    void clear() {
+        words_.clear();
+        size_ = 0;
+    }
+
+private:
+    std::vector<uint64_t> words_;
+    std::size_t size_;
+};
+
+template <typename Char, typename Traits = std::char_traits<Char> >
+class basic_table;
+
+/// @brief A single column of a basic_table.
+///
+/// @details Numeric columns are contiguous arrays, boolean columns are
+/// bitmaps, string columns keep their characters back to back in one
+/// buffer with an offsets array, and dictionary-encoded string columns
+/// keep one 32-bit code per row. Every column has a validity bitmap;
+/// values of null rows are zero, false or empty.
+template <typename Char, typename Traits = std::char_traits<Char> >
+class basic_table_column {
+public:
+    typedef Char char_type;
+    typedef std::basic_string<Char, Traits> string_type;
+    typedef basic_field_view<Char, Traits> field_type;
+    typedef basic_dictionary<Char, Traits> dictionary_type;
+    typedef typename dictionary_type::code_type code_type;
+
+    basic_table_column()
+        : type_(string_column)
+        , encoded_(false) {}
+
+    const string_type &name() const { return name_; }
+
+    column_type type() const { return type_; }
+
+    std::size_t size() const { return validity_.size(); }
+
+    bool is_null(std::size_t i) const { return !validity_[i]; }
+
+    std::size_t null_count() const { return size() - validity_.count(); }
+
+    const bitmap &validity() const { return validity_; }
+
+    /// @brief Returns values of an integer column, or microseconds since
+    /// the epoch for a timestamp column.
+    /// @pre type() == int64_column || type() == timestamp_column
+    const int64_t *int64_data() const { return ints_.empty() ? 0 : &ints_[0]; }
+
+    /// @pre type() == double_column
+    const double *double_data() const {
+        return doubles_.empty() ? 0 : &doubles_[0];
+    }
+
+    /// @pre type() == bool_column
+    bool bool_value(std::size_t i) const { return bools_[i]; }
+
+    /// @pre type() == string_column
+    field_type string_value(std::size_t i) const;
+
+    /// @brief Checks whether the string column is dictionary-encoded.
+    bool is_encoded() const { return encoded_; }
+
+    /// @pre is_encoded()
+    const code_type *codes() const { return codes_.empty() ? 0 : &codes_[0]; }
+
+    /// @pre is_encoded()
+    const dictionary_type &dictionary() const { return dictionary_; }
+
+private:
+    friend class basic_table<Char, Traits>;
+
+    void push_null();
+
+private:
+    string_type name_;
+    column_type type_;
+    bool encoded_;
+    bitmap validity_;
+    std::vector<int64_t> ints_;
+    std::vector<double> doubles_;
+    bitmap bools_;
+    std::vector<char_type> chars_;
+    std::vector<std::size_t> offsets_;
+    std::vector<code_type> codes_;
+    dictionary_type dictionary_;
+};
+
+/// @brief Whole CSV file loaded into typed columns.
+///
+/// @details The first record of the input is the header. Without a
+/// schema every column is loaded as a nullable string column. Column
+/// access by index is O(1).
+template <typename Char, typename Traits>
+class basic_table {
+public:
+    typedef Char char_type;
+    typedef std::basic_istream<Char, Traits> stream_type;
+    typedef std::basic_string<Char, Traits> string_type;
+    typedef basic_table_column<Char, Traits> table_column;
+    typedef basic_schema<Char, Traits> schema_type;
+    typedef basic_header<Char, Traits> header_type;
+    typedef basic_batch_reader<Char, Traits> reader_type;
+
+    basic_table()
+        : rows_(0) {}
+
+    explicit basic_table(stream_type &in);
+
+    basic_table(stream_type &in, const schema_type &schema);
+
+    /// @brief Replaces the contents of the table with all remaining
+    /// records of <tt>reader</tt>, typed according to <tt>schema</tt>.
+    ///
+    /// @details Throws std::runtime_error for a missing or empty value
+    /// in a non-nullable column and for a value that cannot be converted.
+    /// The table then holds the records loaded so far and may hold part
+    /// of the failed batch; load() it again before using it.
+    void load(reader_type &reader, const schema_type &schema);
+
+    std::size_t row_count() const { return rows_; }
+
+    std::size_t column_count() const { return columns_.size(); }
+
+    const schema_type &schema() const { return schema_; }
+
+    const table_column &column(std::size_t i) const { return columns_[i]; }
+
+    /// @brief Returns the column named <tt>name</tt>.
+    /// @throws std::out_of_range if there is no such column.
+    const table_column &column(const string_type &name) const;
+
+private:
+    void append(const typename reader_type::batch_type &batch);
+
+private:
+    schema_type schema_;
+    std::vector<table_column> columns_;
+    std::size_t rows_;
+};
+
+typedef basic_table<char> table;
+typedef basic_table<wchar_t> wtable;
+
+// Implementation
+
+inline std::size_t bitmap::count() const {
+    std::size_t n = 0;
+    for (std::size_t i = 0; i < words_.size(); ++i) {
+#if defined(__GNUC__)
+        n += std::size_t(__builtin_popcountll(words_[i]));
+#else
+        for (uint64_t w = words_[i]; w; w &= w - 1)
+            ++n;
+#endif
+    }
+    return n;
+}
+
+template <typename Char, typename Traits>
+typename basic_table_column<Char, Traits>::field_type
+basic_table_column<Char, Traits>::string_value(std::size_t i) const {
+    if (encoded_) {
+        return validity_[i] ? dictionary_.value(codes_[i]) : field_type();
+    }
+    const char_type *const base = chars_.empty() ? 0 : &chars_[0];
+    return field_type(base + offsets_[i], base + offsets_[i + 1]);
+}
+
+template <typename Char, typename Traits>
+void basic_table_column<Char, Traits>::push_null() {
+    validity_.push_back(false);
+    switch (type_) {
+    case int64_column:
+    case timestamp_column:
+        ints_.push_back(0);
+        break;
+    case double_column:
+        doubles_.push_back(0);
+        break;
+    case bool_column:
+        bools_.push_back(false);
+        break;
+    case string_column:
+        if (encoded_) {
+            codes_.push_back(dictionary_type::npos);
+        } else {
+            offsets_.push_back(chars_.size());
+        }
+        break;
+    }
+}
+
+template <typename Char, typename Traits>
+basic_table<Char, Traits>::basic_table(stream_type &in)
+    : rows_(0) {
+    reader_type reader(in);
+    load(reader, schema_type(reader.read_header()));
+}
+
+template <typename Char, typename Traits>
+basic_table<Char, Traits>::basic_table(stream_type &in,
+                                       const schema_type &schema)
+    : rows_(0) {
+    reader_type reader(in);
+    reader.read_header();
+    load(reader, schema);
+}
+
+template <typename Char, typename Traits>
+void basic_table<Char, Traits>::load(reader_type &reader,
+                                     const schema_type &schema) {
+    schema_ = schema;
+    rows_ = 0;
+    columns_.assign(schema.size(), table_column());
+
+    for (std::size_t i = 0; i < schema.size(); ++i) {
+        table_column &c = columns_[i];
+        c.name_ = schema[i].name;
+        c.type_ = schema[i].type;
+        c.encoded_ = c.type_ == string_column && schema[i].dictionary;
+        if (c.encoded_) {
+            reader.encode_column(i);
+        } else if (c.type_ == string_column) {
+            c.offsets_.push_back(0);
+        }
+    }
+
+    typename reader_type::batch_type batch;
+    while (reader.next(batch)) {
+        append(batch);
+    }
+
+    for (std::size_t i = 0; i < columns_.size(); ++i) {
+        if (columns_[i].encoded_) {
+            reader.release_dictionary(i, columns_[i].dictionary_);
+        }
+    }
+}
+
+template <typename Char, typename Traits>
+void basic_table<Char, Traits>::append(
+    const typename reader_type::batch_type &batch) {
+    typedef typename reader_type::batch_type::field_type field_type;
+    const std::size_t n = batch.size();
+
+    for (std::size_t i = 0; i < columns_.size(); ++i) {
+        table_column &c = columns_[i];
+        const bool nullable = schema_[i].nullable;
+
+        for (std::size_t r = 0; r < n; ++r) {
+            if (i >= batch.field_count(r)) {
+                if (!nullable) {
+                    throw std::runtime_error("Missing value in column");
+                }
+                c.push_null();
+                continue;
+            }
+
+            const field_type f = batch.field(r, i);
+            if (f.empty() && (nullable || c.type_ != string_column)) {
+                if (!nullable) {
+                    throw std::runtime_error("Missing value in column");
+                }
+                c.push_null();
+                continue;
+            }
+
+            bool ok = true;
+            switch (c.type_) {
+            case int64_column: {
+                int64_t v = 0;
+                if ((ok = convert<int64_t>::parse(f.begin(), f.end(), v)))
+                    c.ints_.push_back(v);
+                break;
+            }
+            case timestamp_column: {
+                timestamp v;
+                if ((ok = convert<timestamp>::parse(f.begin(), f.end(), v)))
+                    c.ints_.push_back(v.micros);
+                break;
+            }
+            case double_column: {
+                double v = 0;
+                if ((ok = convert<double>::parse(f.begin(), f.end(), v)))
+                    c.doubles_.push_back(v);
+                break;
+            }
+            case bool_column: {
+                bool v = false;
+                if ((ok = convert<bool>::parse(f.begin(), f.end(), v)))
+                    c.bools_.push_back(v);
+                break;
+            }
+            case string_column:
+                if (c.encoded_) {
+                    c.codes_.push_back(batch.code(r, i));
+                } else {
+                    c.chars_.insert(c.chars_.end(), f.begin(), f.end());
+                    c.offsets_.push_back(c.chars_.size());
+                }
+                break;
+            }
+            if (!ok) {
+                throw std::runtime_error("Invalid value in column");
+            }
+            c.validity_.push_back(true);
+        }
+    }
+    rows_ += n;
+}
+
+template <typename Char, typename Traits>
+const typename basic_table<Char, Traits>::table_column &
+basic_table<Char, Traits>::column(const string_type &name) const {
+    const std::size_t i = schema_.index_of(name);
+    if (i == schema_type::npos) {
+        throw std::out_of_range("Unknown column");
+    }
+    return columns_[i];
+}
+} // namespace csv
+} // namespace text
+
+#endif
@@ -0,0 +1,82 @@
+#ifndef TEXT_CSV_TEMP_FILES_HPP
+#define TEXT_CSV_TEMP_FILES_HPP
+
+//          Copyright Roman Kashitsyn 2014 - 2015.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// Temporary files of the external sort and de-duplication.
+
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+namespace text {
+namespace csv {
+namespace detail {
+
+/// Temporary files removed on destruction.
+class temp_files {
+public:
+    explicit temp_files(const std::string &dir)
+        : dir_(dir) {}
+
+    ~temp_files() {
+        for (std::size_t i = 0; i < names_.size(); ++i) {
+            std::remove(names_[i].c_str());
+        }
+    }
+
+    /// Creates a new empty file and returns its name.
+    std::string create();
+
+private:
+    temp_files(temp_files const &);
+    temp_files &operator=(temp_files const &);
+
+private:
+    std::string dir_;
+    std::vector<std::string> names_;
+};
+
+inline std::string default_temp_directory() {
+    const char *dir = std::getenv("TMPDIR");
+#if defined(__unix__) || defined(__APPLE__)
+    return dir && *dir ? dir : "/tmp";
+#else
+    return dir && *dir ? dir : ".";
+#endif
+}
+
+inline std::string temp_files::create() {
+#if defined(__unix__) || defined(__APPLE__)
+    const std::string pattern = dir_ + "/text-csv-XXXXXX";
+    std::vector<char> name(pattern.begin(), pattern.end());
+    name.push_back('\0');
+    const int fd = ::mkstemp(&name[0]);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot create temporary file");
+    }
+    ::close(fd);
+    names_.push_back(&name[0]);
+#else
+    char name[L_tmpnam];
+    if (!std::tmpnam(name)) {
+        throw std::runtime_error("Cannot create temporary file");
+    }
+    names_.push_back(name);
+#endif
+    return names_.back();
+}
+} // namespace detail
+} // namespace csv
+} // namespace text
+
+#endif
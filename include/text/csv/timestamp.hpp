@@ -0,0 +1,158 @@
+#ifndef TEXT_CSV_TIMESTAMP_HPP
+#define TEXT_CSV_TIMESTAMP_HPP
+
+//          Copyright Roman Kashitsyn 2014 - 2015.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "convert.hpp"
+#include <stdint.h>
+
+namespace text {
+namespace csv {
+
+/// @brief Point in time, in microseconds since 1970-01-01T00:00:00Z.
+struct timestamp {
+    timestamp()
+        : micros(0) {}
+
+    explicit timestamp(int64_t us)
+        : micros(us) {}
+
+    bool operator==(const timestamp &rhs) const { return micros == rhs.micros; }
+
+    bool operator!=(const timestamp &rhs) const { return micros != rhs.micros; }
+
+    bool operator<(const timestamp &rhs) const { return micros < rhs.micros; }
+
+    int64_t micros;
+};
+
+namespace detail {
+
+/// Days since 1970-01-01 of a proleptic Gregorian date
+/// (H. Hinnant's days_from_civil).
+inline int64_t days_from_civil(int64_t y, unsigned m, unsigned d) {
+    y -= m <= 2;
+    const int64_t era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = static_cast<unsigned>(y - era * 400);
+    const unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + int64_t(doe) - 719468;
+}
+
+inline bool is_leap_year(int64_t y) {
+    return (y % 4 == 0 && y % 100 != 0) || y % 400 == 0;
+}
+
+inline unsigned days_in_month(int64_t y, unsigned m) {
+    static const unsigned days[] = { 31, 28, 31, 30, 31, 30,
+                                     31, 31, 30, 31, 30, 31 };
+    return m == 2 && is_leap_year(y) ? 29 : days[m - 1];
+}
+
+/// Reads exactly <tt>n</tt> digits.
+template <typename Char>
+bool read_digits(const Char *&p, const Char *end, unsigned n,
+                 unsigned &value) {
+    if (end - p < static_cast<std::ptrdiff_t>(n))
+        return false;
+    value = 0;
+    for (unsigned i = 0; i < n; ++i, ++p) {
+        unsigned d;
+        if (!to_digit(*p, d))
+            return false;
+        value = value * 10 + d;
+    }
+    return true;
+}
+
+template <typename Char>
+bool expect(const Char *&p, const Char *end, char c) {
+    if (p == end || *p != Char(c))
+        return false;
+    ++p;
+    return true;
+}
+} // namespace detail
+
+/// @brief Parses ISO 8601 dates and date-times:
+/// <tt>YYYY-MM-DD</tt> optionally followed by <tt>T</tt> or a space,
+/// <tt>hh:mm[:ss[.fraction]]</tt> and a zone designator (<tt>Z</tt> or
+/// <tt>+hh[:mm]</tt>/<tt>-hh[:mm]</tt>). Times without a zone are UTC.
+template <>
+struct convert<timestamp> {
+    template <typename Char>
+    static bool parse(const Char *begin, const Char *end, timestamp &dest) {
+        using namespace detail;
+        trim_blanks(begin, end);
+        const Char *p = begin;
+        unsigned y, mo, d, h = 0, mi = 0, s = 0;
+        int64_t frac = 0;
+
+        if (!read_digits(p, end, 4, y) || !expect(p, end, '-') ||
+            !read_digits(p, end, 2, mo) || !expect(p, end, '-') ||
+            !read_digits(p, end, 2, d))
+            return false;
+        if (mo < 1 || mo > 12 || d < 1 || d > days_in_month(y, mo))
+            return false;
+
+        int64_t offset = 0;
+        if (p != end) {
+            if (*p != Char('T') && *p != Char(' '))
+                return false;
+            ++p;
+            if (!read_digits(p, end, 2, h) || !expect(p, end, ':') ||
+                !read_digits(p, end, 2, mi))
+                return false;
+            if (p != end && *p == Char(':')) {
+                ++p;
+                if (!read_digits(p, end, 2, s))
+                    return false;
+                if (p != end && (*p == Char('.') || *p == Char(','))) {
+                    ++p;
+                    int64_t scale = 100000;
+                    unsigned digit, n = 0;
+                    for (; p != end && to_digit(*p, digit); ++p, ++n) {
+                        frac += scale * digit;
+                        scale /= 10;
+                    }
+                    if (n == 0)
+                        return false;
+                }
+            }
+            if (h > 23 || mi > 59 || s > 60)
+                return false;
+
+            if (p != end && *p == Char('Z')) {
+                ++p;
+            } else if (p != end && (*p == Char('+') || *p == Char('-'))) {
+                const bool negative = *p == Char('-');
+                unsigned oh, om = 0;
+                ++p;
+                if (!read_digits(p, end, 2, oh))
+                    return false;
+                if (p != end && *p == Char(':'))
+                    ++p;
+                if (p != end && !read_digits(p, end, 2, om))
+                    return false;
+                offset = (int64_t(oh) * 60 + om) * 60;
+                if (negative)
+                    offset = -offset;
+            }
+            if (p != end)
+                return false;
+        }
+
+        const int64_t seconds = days_from_civil(y, mo, d) * 86400 +
+                                int64_t(h) * 3600 + int64_t(mi) * 60 + s -
+                                offset;
+        dest.micros = seconds * 1000000 + frac;
+        return true;
+    }
+};
+} // namespace csv
+} // namespace text
+
+#endif
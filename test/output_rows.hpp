@@ -0,0 +1,28 @@
+#ifndef TEXT_CSV_TEST_OUTPUT_ROWS_HPP
+#define TEXT_CSV_TEST_OUTPUT_ROWS_HPP
+
+// Records shared by the tests of the output stream buffers: integers,
+// doubles and fields that need quoting.
+
+#include "text/csv/ostream.hpp"
+
+#include <sstream>
+#include <string>
+
+inline void format_rows(::text::csv::csv_ostream &out, std::size_t rows) {
+    for (std::size_t i = 0; i < rows; ++i) {
+        out << static_cast<unsigned long>(i) << double(i) / 3
+            << (i % 7 ? "plain" : "with, \"quotes\"") << ::text::csv::endl;
+    }
+}
+
+/// Returns what format_rows() writes to an ordinary string stream.
+inline std::string expected_rows(std::size_t rows) {
+    std::ostringstream os;
+    ::text::csv::csv_ostream out(os);
+    format_rows(out, rows);
+    out.flush();
+    return os.str();
+}
+
+#endif
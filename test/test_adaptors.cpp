@@ -0,0 +1,94 @@
+#if __cplusplus >= 201103
+
+#include "text/csv/adaptors.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace csv = ::text::csv;
+
+BOOST_AUTO_TEST_SUITE(csv_adaptors)
+
+BOOST_AUTO_TEST_CASE(filter_transform_test) {
+    std::istringstream in("1,a\n2,b\n3,c\n4,d\n5,e\n6,f");
+    csv::row_range rows(in);
+    std::vector<int> odd;
+    for (int v : rows | csv::filter([](const csv::row &r) {
+                     return r.as<int>(0) % 2 == 1;
+                 }) | csv::transform([](const csv::row &r) {
+                     return r.as<int>(0) * 10;
+                 }))
+        odd.push_back(v);
+    BOOST_REQUIRE_EQUAL(odd.size(), 3u);
+    BOOST_CHECK_EQUAL(odd[0], 10);
+    BOOST_CHECK_EQUAL(odd[2], 50);
+}
+
+BOOST_AUTO_TEST_CASE(take_drop_test) {
+    std::istringstream in("1\n2\n3\n4\n5\n6\n");
+    csv::row_range rows(in);
+    std::vector<std::string> seen;
+    for (const csv::row &r : rows | csv::drop(1) | csv::take(2))
+        seen.push_back(r[0]);
+    BOOST_REQUIRE_EQUAL(seen.size(), 2u);
+    BOOST_CHECK_EQUAL(seen[0], "2");
+    BOOST_CHECK_EQUAL(seen[1], "3");
+
+    // take() stops reading as soon as it is satisfied.
+    std::string rest;
+    std::getline(in, rest);
+    BOOST_CHECK_EQUAL(rest, "4");
+
+    std::istringstream short_in("1\n2\n");
+    csv::row_range short_rows(short_in);
+    auto none = short_rows | csv::drop(5);
+    BOOST_CHECK(none.begin() == none.end());
+}
+
+BOOST_AUTO_TEST_CASE(select_test) {
+    std::istringstream in("x,y,z\n1,2,3\n4,5,6\n");
+    csv::map_row_range rows(in);
+    auto picked = rows | csv::select({"z", "x"});
+    std::vector<csv::row> out(picked.begin(), picked.end());
+    BOOST_REQUIRE_EQUAL(out.size(), 2u);
+    BOOST_CHECK_EQUAL(out[1].size(), 2u);
+    BOOST_CHECK_EQUAL(out[1][0], "6");
+    BOOST_CHECK_EQUAL(out[1][1], "4");
+
+    std::istringstream in2("1,2,3\n4\n");
+    csv::row_range plain(in2);
+    auto cols = plain | csv::select({2, 0});
+    auto i = cols.begin();
+    BOOST_CHECK_EQUAL((*i)[0], "3");
+    BOOST_CHECK_THROW(++i, std::out_of_range);
+
+    std::istringstream in3("x\n1\n");
+    csv::map_row_range named(in3);
+    auto unknown = named | csv::select({"nope"});
+    BOOST_CHECK_THROW(unknown.begin(), std::out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE(composition_test) {
+    std::vector<csv::row> table;
+    for (int i = 0; i < 10; ++i) {
+        csv::row r;
+        r.push_back(std::to_string(i));
+        table.push_back(r);
+    }
+    auto evens = table | csv::filter([](const csv::row &r) {
+                     return r.as<int>(0) % 2 == 0;
+                 });
+    auto firsts = std::move(evens) | csv::take(3);
+    std::string joined;
+    for (const csv::row &r : firsts)
+        joined += r[0];
+    BOOST_CHECK_EQUAL(joined, "024");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+#endif
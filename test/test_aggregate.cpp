@@ -0,0 +1,122 @@
+#include "text/csv/aggregate.hpp"
+#include "text/csv/iterator.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <cmath>
+#include <map>
+#include <sstream>
+#include <string>
+
+namespace csv = ::text::csv;
+
+namespace {
+
+const char *const SALES = "region,product,amount\n"
+                          "EU,apple,10\n"
+                          "US,apple,5\n"
+                          "EU,pear,\n"
+                          "EU,apple,2.5\n"
+                          "US,pear,7\n"
+                          "EU,apple,x\n";
+
+std::string make_big_input(std::size_t n) {
+    std::ostringstream os;
+    os << "k,v\n";
+    for (std::size_t i = 0; i < n; ++i) {
+        os << "key" << (i % 97) << "," << i << "\n";
+    }
+    return os.str();
+}
+}
+
+BOOST_AUTO_TEST_SUITE(csv_aggregate)
+
+BOOST_AUTO_TEST_CASE(group_by_test) {
+    std::istringstream in(SALES);
+    csv::batch_reader reader(in);
+    reader.read_header();
+
+    csv::aggregator agg;
+    agg.group_by(0);
+    agg.group_by(1);
+    const std::size_t count = agg.aggregate(csv::count_aggregate, 2);
+    const std::size_t sum = agg.aggregate(csv::sum_aggregate, 2);
+    const std::size_t min = agg.aggregate(csv::min_aggregate, 2);
+    const std::size_t max = agg.aggregate(csv::max_aggregate, 2);
+    const std::size_t mean = agg.aggregate(csv::mean_aggregate, 2);
+    agg.consume(reader);
+
+    BOOST_REQUIRE_EQUAL(4u, agg.size());
+    BOOST_CHECK_EQUAL(6u, agg.rows_consumed());
+
+    // Groups are numbered in order of first appearance.
+    BOOST_CHECK_EQUAL("EU", agg.key(0, 0).str());
+    BOOST_CHECK_EQUAL("apple", agg.key(0, 1).str());
+    BOOST_CHECK_EQUAL(3u, agg.rows(0));
+    BOOST_CHECK_EQUAL(2.0, agg.value(0, count));
+    BOOST_CHECK_EQUAL(12.5, agg.value(0, sum));
+    BOOST_CHECK_EQUAL(2.5, agg.value(0, min));
+    BOOST_CHECK_EQUAL(10.0, agg.value(0, max));
+    BOOST_CHECK_EQUAL(6.25, agg.value(0, mean));
+
+    BOOST_CHECK_EQUAL("pear", agg.key(2, 1).str());
+    BOOST_CHECK_EQUAL(0.0, agg.value(2, count));
+    BOOST_CHECK(std::isnan(agg.value(2, mean)));
+}
+
+BOOST_AUTO_TEST_CASE(row_range_aggregate_test) {
+    std::istringstream in(SALES);
+    csv::map_row_range range(in);
+
+    csv::aggregator agg;
+    agg.group_by(1);
+    const std::size_t sum = agg.aggregate(csv::sum_aggregate, 2);
+    for (csv::map_row_range::iterator i = range.begin(), e = range.end();
+         i != e; ++i) {
+        agg.consume(*i);
+    }
+
+    BOOST_REQUIRE_EQUAL(2u, agg.size());
+    BOOST_CHECK_EQUAL(17.5, agg.value(0, sum));
+    BOOST_CHECK_EQUAL(7.0, agg.value(1, sum));
+}
+
+BOOST_AUTO_TEST_CASE(merge_and_parallel_test) {
+    const std::string text = make_big_input(5000);
+
+    std::istringstream serial_in(text);
+    csv::batch_reader serial_reader(serial_in);
+    serial_reader.read_header();
+    csv::aggregator serial;
+    serial.group_by(0);
+    const std::size_t sum = serial.aggregate(csv::sum_aggregate, 1);
+    serial.consume(serial_reader);
+
+    std::istringstream parallel_in(text);
+    csv::batch_reader parallel_reader(parallel_in);
+    parallel_reader.read_header();
+    parallel_reader.batch_size(100);
+    csv::aggregator parallel;
+    parallel.group_by(0);
+    parallel.aggregate(csv::sum_aggregate, 1);
+#if __cplusplus >= 201103
+    parallel.consume(parallel_reader, 4);
+#else
+    parallel.consume(parallel_reader);
+#endif
+
+    BOOST_REQUIRE_EQUAL(serial.size(), parallel.size());
+    BOOST_CHECK_EQUAL(serial.rows_consumed(), parallel.rows_consumed());
+
+    std::map<std::string, double> expected;
+    for (std::size_t g = 0; g < serial.size(); ++g) {
+        expected[serial.key(g, 0).str()] = serial.value(g, sum);
+    }
+    for (std::size_t g = 0; g < parallel.size(); ++g) {
+        BOOST_CHECK_EQUAL(expected[parallel.key(g, 0).str()],
+                          parallel.value(g, sum));
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,97 @@
+#include "text/csv/async_buf.hpp"
+
+#include "output_rows.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <sstream>
+#include <string>
+
+#if __cplusplus >= 201103
+
+#include <cerrno>
+#include <cstdio>
+#include <fstream>
+#include <system_error>
+
+namespace csv = ::text::csv;
+
+namespace {
+
+struct full_buf : std::streambuf {};
+}
+
+BOOST_AUTO_TEST_SUITE(csv_async_buf)
+
+BOOST_AUTO_TEST_CASE(streambuf_target_test) {
+    std::stringbuf target;
+    {
+        csv::async_buf buf(&target, 64, 3);
+        std::ostream os(&buf);
+        csv::csv_ostream out(os);
+        out.buffer_size(128);
+        format_rows(out, 1000);
+        out.flush();
+        os.flush();
+        BOOST_CHECK(os.good());
+        buf.close();
+    }
+    BOOST_CHECK(target.str() == expected_rows(1000));
+}
+
+#if defined(TEXT_CSV_HAS_POSIX_IO)
+
+BOOST_AUTO_TEST_CASE(fd_target_test) {
+    char path[] = "/tmp/text_csv_async_XXXXXX";
+    const int fd = ::mkstemp(path);
+    BOOST_REQUIRE(fd >= 0);
+    {
+        csv::async_buf buf(fd, 100);
+        std::ostream os(&buf);
+        csv::csv_ostream out(os);
+        format_rows(out, 5000);
+        out.flush();
+        buf.close();
+        BOOST_CHECK(!buf.error());
+    }
+    ::close(fd);
+
+    std::ifstream in(path);
+    std::ostringstream contents;
+    contents << in.rdbuf();
+    std::remove(path);
+    BOOST_CHECK(contents.str() == expected_rows(5000));
+}
+
+BOOST_AUTO_TEST_CASE(fd_error_test) {
+    csv::async_buf buf(-1, 16);
+    std::ostream os(&buf);
+    csv::csv_ostream out(os);
+    format_rows(out, 10);
+    out.flush();
+    os.flush();
+    BOOST_CHECK(os.bad());
+    BOOST_CHECK(buf.error() ==
+                std::error_code(EBADF, std::system_category()));
+    BOOST_CHECK_THROW(buf.close(), std::system_error);
+}
+
+#endif
+
+BOOST_AUTO_TEST_CASE(failed_target_test) {
+    full_buf target;
+    csv::async_buf buf(&target, 16);
+    std::ostream os(&buf);
+    os << "some text that does not fit";
+    BOOST_CHECK(buf.pubsync() == -1);
+    BOOST_CHECK(static_cast<bool>(buf.error()));
+    BOOST_CHECK_THROW(buf.close(), std::system_error);
+    // Nothing is written after close.
+    os << "more";
+    os.flush();
+    BOOST_CHECK(os.bad());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+#endif
@@ -0,0 +1,104 @@
+#include "text/csv/batch.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace csv = ::text::csv;
+
+BOOST_AUTO_TEST_SUITE(csv_batch)
+
+BOOST_AUTO_TEST_CASE(dictionary_intern_test) {
+    csv::dictionary d;
+    const std::string values[] = { "USD", "EUR", "USD", "", "GBP", "EUR" };
+    const csv::dictionary::code_type expected[] = { 0, 1, 0, 2, 3, 1 };
+
+    for (std::size_t i = 0; i < 6; ++i) {
+        BOOST_CHECK_EQUAL(expected[i], d.intern(values[i]));
+    }
+    BOOST_CHECK_EQUAL(4u, d.size());
+    BOOST_CHECK_EQUAL("GBP", d[3].str());
+    BOOST_CHECK_EQUAL(1u, d.find(csv::field_view(values[1])));
+    BOOST_CHECK_EQUAL(csv::dictionary::npos,
+                      d.find(csv::field_view(std::string("JPY"))));
+}
+
+BOOST_AUTO_TEST_CASE(dictionary_growth_test) {
+    csv::dictionary d;
+    for (int i = 0; i < 1000; ++i) {
+        std::ostringstream ss;
+        ss << "value" << i;
+        BOOST_CHECK_EQUAL(csv::dictionary::code_type(i), d.intern(ss.str()));
+    }
+    for (int i = 0; i < 1000; ++i) {
+        std::ostringstream ss;
+        ss << "value" << i;
+        BOOST_CHECK_EQUAL(ss.str(), d[i].str());
+        BOOST_CHECK_EQUAL(csv::dictionary::code_type(i), d.intern(ss.str()));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(batch_reader_test) {
+    std::istringstream in("a,b,c\n1,\"x,y\",3\n4,5\n6,7,8\n");
+    csv::batch_reader reader(in);
+    reader.batch_size(2);
+    csv::row_batch batch;
+
+    BOOST_REQUIRE(reader.next(batch));
+    BOOST_CHECK_EQUAL(2u, batch.size());
+    BOOST_CHECK_EQUAL(0u, batch.first_row());
+    BOOST_CHECK_EQUAL(3u, batch.field_count(0));
+    BOOST_CHECK_EQUAL("c", batch.field(0, 2).str());
+    BOOST_CHECK_EQUAL("x,y", batch.field(1, 1).str());
+    BOOST_CHECK_EQUAL(3, batch.as<int>(1, 2));
+
+    BOOST_REQUIRE(reader.next(batch));
+    BOOST_CHECK_EQUAL(2u, batch.size());
+    BOOST_CHECK_EQUAL(2u, batch.first_row());
+    BOOST_CHECK_EQUAL(2u, batch.field_count(0));
+    BOOST_CHECK_EQUAL("5", batch.field(0, 1).str());
+
+    csv::row r;
+    batch.copy_row(1, r);
+    BOOST_CHECK_EQUAL(3u, r.size());
+    BOOST_CHECK_EQUAL("8", r[2]);
+
+    BOOST_CHECK(!reader.next(batch));
+}
+
+BOOST_AUTO_TEST_CASE(batch_reader_encoding_test) {
+    std::istringstream in("id,currency\n1,USD\n2,EUR\n3,USD\n4\n");
+    csv::batch_reader reader(in);
+    reader.read_header();
+    reader.encode_column("currency");
+    csv::row_batch batch;
+
+    BOOST_REQUIRE(reader.next(batch));
+    BOOST_CHECK_EQUAL(4u, batch.size());
+    BOOST_CHECK(batch.is_encoded(1));
+    BOOST_CHECK(!batch.is_encoded(0));
+    BOOST_CHECK_EQUAL(0u, batch.code(0, 1));
+    BOOST_CHECK_EQUAL(1u, batch.code(1, 1));
+    BOOST_CHECK_EQUAL(0u, batch.code(2, 1));
+    BOOST_CHECK_EQUAL(csv::dictionary::npos, batch.code(3, 1));
+    BOOST_CHECK_EQUAL("EUR", batch.field(1, 1).str());
+    BOOST_CHECK_EQUAL("3", batch.field(2, 0).str());
+    BOOST_CHECK_EQUAL(2u, reader.dictionary(1).size());
+
+    BOOST_CHECK_THROW(reader.encode_column("missing"), std::out_of_range);
+    BOOST_CHECK_THROW(reader.encode_column("id"), std::logic_error);
+    reader.encode_column("currency");
+}
+
+BOOST_AUTO_TEST_CASE(wide_batch_reader_test) {
+    std::wistringstream in(L"x|y\n1|2");
+    csv::wbatch_reader reader(in, L'|');
+    csv::wrow_batch batch;
+    BOOST_REQUIRE(reader.next(batch));
+    BOOST_CHECK_EQUAL(2u, batch.size());
+    BOOST_CHECK(batch.field(1, 1).str() == L"2");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,97 @@
+#include <boost/test/unit_test.hpp>
+
+#if __cplusplus >= 201103 && defined(TEXT_CSV_TEST_ZLIB)
+
+#include "text/csv/compress.hpp"
+
+#include "output_rows.hpp"
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <zlib.h>
+
+namespace csv = ::text::csv;
+
+namespace {
+
+/// Inflates concatenated gzip members one by one.
+std::vector<std::string> gunzip_members(const std::string &data) {
+    std::vector<std::string> members;
+    std::size_t pos = 0;
+    while (pos < data.size()) {
+        z_stream z = z_stream();
+        BOOST_REQUIRE(inflateInit2(&z, 15 + 16) == Z_OK);
+        z.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(&data[pos]));
+        z.avail_in = uInt(data.size() - pos);
+        std::string member;
+        char buf[4096];
+        int rc;
+        do {
+            z.next_out = reinterpret_cast<Bytef *>(buf);
+            z.avail_out = sizeof(buf);
+            rc = inflate(&z, Z_NO_FLUSH);
+            BOOST_REQUIRE(rc == Z_OK || rc == Z_STREAM_END);
+            member.append(buf, sizeof(buf) - z.avail_out);
+        } while (rc != Z_STREAM_END);
+        pos += z.total_in;
+        inflateEnd(&z);
+        members.push_back(member);
+    }
+    return members;
+}
+}
+
+BOOST_AUTO_TEST_SUITE(csv_compress)
+
+BOOST_AUTO_TEST_CASE(parallel_gzip_test) {
+    std::stringbuf target;
+    {
+        csv::compress_buf buf(&target, csv::gzip_compression, 6, 4, 1024);
+        BOOST_CHECK_EQUAL(buf.threads(), 4u);
+        std::ostream os(&buf);
+        csv::csv_ostream out(os);
+        out.buffer_size(256);
+        format_rows(out, 5000);
+        out.flush();
+        buf.close();
+    }
+
+    const std::vector<std::string> members = gunzip_members(target.str());
+    BOOST_CHECK(members.size() > 1);
+    std::string all;
+    for (std::size_t i = 0; i < members.size(); ++i) {
+        // Blocks are cut between records.
+        BOOST_REQUIRE(!members[i].empty());
+        BOOST_CHECK_EQUAL(members[i][members[i].size() - 1], '\n');
+        BOOST_CHECK(members[i].size() <= 1024);
+        all += members[i];
+    }
+    BOOST_CHECK(all == expected_rows(5000));
+}
+
+BOOST_AUTO_TEST_CASE(empty_gzip_test) {
+    std::stringbuf target;
+    {
+        csv::compress_buf buf(&target, csv::gzip_compression, -1, 1);
+    }
+    const std::vector<std::string> members = gunzip_members(target.str());
+    BOOST_REQUIRE_EQUAL(members.size(), 1u);
+    BOOST_CHECK(members[0].empty());
+}
+
+#if !defined(TEXT_CSV_WITH_ZSTD)
+
+BOOST_AUTO_TEST_CASE(zstd_disabled_test) {
+    std::stringbuf target;
+    BOOST_CHECK_THROW(csv::compress_buf(&target, csv::zstd_compression),
+                      std::runtime_error);
+}
+
+#endif
+
+BOOST_AUTO_TEST_SUITE_END()
+
+#endif
@@ -0,0 +1,183 @@
+#include "text/csv/rows.hpp"
+#include "text/csv/iterator.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <sstream>
+#include <string>
+#include <vector>
+#include <limits>
+
+namespace csv = ::text::csv;
+
+namespace {
+
+struct point {
+    int x;
+    int y;
+};
+
+bool operator==(const point &lhs, const point &rhs) {
+    return lhs.x == rhs.x && lhs.y == rhs.y;
+}
+
+template <typename T>
+bool parse(const char *text, T &dest) {
+    const std::string s(text);
+    return csv::convert<T>::parse(s.data(), s.data() + s.size(), dest);
+}
+}
+
+namespace text {
+namespace csv {
+
+template <>
+struct convert<point> {
+    template <typename Char>
+    static bool parse(const Char *begin, const Char *end, point &dest) {
+        const Char *sep = begin;
+        while (sep != end && *sep != Char(':'))
+            ++sep;
+        return sep != end && convert<int>::parse(begin, sep, dest.x) &&
+               convert<int>::parse(sep + 1, end, dest.y);
+    }
+};
+} // namespace csv
+} // namespace text
+
+BOOST_AUTO_TEST_SUITE(csv_convert)
+
+BOOST_AUTO_TEST_CASE(integer_convert_test) {
+    int i = 0;
+    BOOST_CHECK(parse("42", i));
+    BOOST_CHECK_EQUAL(42, i);
+    BOOST_CHECK(parse(" -17 ", i));
+    BOOST_CHECK_EQUAL(-17, i);
+    BOOST_CHECK(parse("-2147483648", i));
+    BOOST_CHECK_EQUAL(std::numeric_limits<int>::min(), i);
+    BOOST_CHECK(!parse("2147483648", i));
+    BOOST_CHECK(!parse("", i));
+    BOOST_CHECK(!parse("-", i));
+    BOOST_CHECK(!parse("12abc", i));
+
+    unsigned u = 0;
+    BOOST_CHECK(parse("4294967295", u));
+    BOOST_CHECK_EQUAL(4294967295u, u);
+    BOOST_CHECK(!parse("4294967296", u));
+    BOOST_CHECK(!parse("-1", u));
+}
+
+BOOST_AUTO_TEST_CASE(floating_convert_test) {
+    double d = 0;
+    BOOST_CHECK(parse("0.3", d));
+    BOOST_CHECK_EQUAL(0.3, d);
+    BOOST_CHECK(parse("-1.5e3", d));
+    BOOST_CHECK_EQUAL(-1500.0, d);
+    BOOST_CHECK(parse("+2", d));
+    BOOST_CHECK_EQUAL(2.0, d);
+    BOOST_CHECK(!parse("1.5x", d));
+    BOOST_CHECK(!parse("", d));
+    BOOST_CHECK(!parse("0x1p3", d));
+    BOOST_CHECK(!parse("1e999", d));
+    BOOST_CHECK(!parse("1e", d));
+    BOOST_CHECK(parse("-inf", d));
+    BOOST_CHECK_EQUAL(-std::numeric_limits<double>::infinity(), d);
+
+    float f = 0;
+    BOOST_CHECK(parse("0.25", f));
+    BOOST_CHECK_EQUAL(0.25f, f);
+}
+
+BOOST_AUTO_TEST_CASE(floating_sign_test) {
+    double d = 0;
+    BOOST_CHECK(!parse("+-1", d));
+    BOOST_CHECK(!parse("++1", d));
+    BOOST_CHECK(!parse("+-inf", d));
+    BOOST_CHECK(!parse("+", d));
+    BOOST_CHECK(parse("+nan", d));
+    BOOST_CHECK(d != d);
+    BOOST_CHECK(parse("-0.5", d));
+    BOOST_CHECK_EQUAL(-0.5, d);
+}
+
+BOOST_AUTO_TEST_CASE(classic_floating_fallback_test) {
+    // The parser used when the standard library lacks from_chars.
+    const char *const valid[] = {"0.3", "-1.5e3", "1.", ".5", "2E+2",
+                                 "-inf", "Infinity", "nan"};
+    const double values[] = {0.3, -1500.0, 1.0, 0.5, 200.0};
+    for (std::size_t i = 0; i < sizeof(valid) / sizeof(valid[0]); ++i) {
+        const std::string s(valid[i]);
+        double d = 0;
+        BOOST_CHECK(csv::detail::parse_classic_floating(
+            s.data(), s.data() + s.size(), d));
+        if (i < sizeof(values) / sizeof(values[0]))
+            BOOST_CHECK_EQUAL(values[i], d);
+    }
+
+    const char *const invalid[] = {"", "-", ".", "1e", "1e+", "0x1p3",
+                                   "1e999", "1,5", "1.5x", "+1", "--1"};
+    for (std::size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); ++i) {
+        const std::string s(invalid[i]);
+        double d = 7;
+        BOOST_CHECK(!csv::detail::parse_classic_floating(
+            s.data(), s.data() + s.size(), d));
+        BOOST_CHECK_EQUAL(7.0, d);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(bool_and_string_convert_test) {
+    bool b = false;
+    BOOST_CHECK(parse("1", b));
+    BOOST_CHECK(b);
+    BOOST_CHECK(parse("False", b));
+    BOOST_CHECK(!b);
+    BOOST_CHECK(parse("TRUE", b));
+    BOOST_CHECK(b);
+    BOOST_CHECK(!parse("yes", b));
+
+    std::string s;
+    BOOST_CHECK(parse(" two words ", s));
+    BOOST_CHECK_EQUAL(" two words ", s);
+}
+
+BOOST_AUTO_TEST_CASE(wide_convert_test) {
+    const std::wstring text(L"-123");
+    long l = 0;
+    BOOST_CHECK(csv::convert<long>::parse(text.data(),
+                                          text.data() + text.size(), l));
+    BOOST_CHECK_EQUAL(-123, l);
+}
+
+BOOST_AUTO_TEST_CASE(user_defined_convert_test) {
+    std::istringstream ss("a,b\n1:2,3:4");
+    csv::csv_istream is(ss);
+    csv::map_row r(is);
+
+    const point p = r.as<point>("b");
+    BOOST_CHECK_EQUAL(3, p.x);
+    BOOST_CHECK_EQUAL(4, p.y);
+
+    std::istringstream points("5:6,7:8");
+    csv::csv_istream pis(points);
+    csv::input_column_iterator<point> it(pis), end;
+    BOOST_CHECK_EQUAL(5, it->x);
+    ++it;
+    BOOST_CHECK_EQUAL(8, it->y);
+    ++it;
+    BOOST_CHECK(it == end);
+}
+
+BOOST_AUTO_TEST_CASE(invalid_field_throws_test) {
+    csv::row r(1);
+    r[0] = "abc";
+    BOOST_CHECK_THROW(r.as<int>(0), std::runtime_error);
+
+    std::istringstream ss("1,x");
+    csv::csv_istream is(ss);
+    int i = 0;
+    is >> i;
+    BOOST_CHECK_EQUAL(1, i);
+    BOOST_CHECK_THROW(is >> i, std::runtime_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,113 @@
+#include "text/csv/dedup.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace csv = ::text::csv;
+
+namespace {
+
+std::string make_input(std::size_t n) {
+    std::ostringstream os;
+    csv::csv_ostream out(os);
+    for (std::size_t i = 0; i < n; ++i) {
+        // Every third record repeats the one before it.
+        const std::size_t id = i % 3 == 2 ? i - 1 : i;
+        out << int(id) << "value\n" << int(id % 5) << csv::endl;
+    }
+    return os.str();
+}
+
+std::vector<std::string> lines(const std::string &text) {
+    std::vector<std::string> v;
+    std::istringstream in(text);
+    csv::batch_reader reader(in);
+    csv::row_batch batch;
+    csv::row row;
+    while (reader.next(batch)) {
+        for (std::size_t r = 0; r < batch.size(); ++r) {
+            batch.copy_row(r, row);
+            std::string s;
+            for (std::size_t c = 0; c < row.size(); ++c)
+                s += row[c] + '|';
+            v.push_back(s);
+        }
+    }
+    return v;
+}
+}
+
+BOOST_AUTO_TEST_SUITE(csv_dedup)
+
+BOOST_AUTO_TEST_CASE(hash128_test) {
+    const char text[] = "The quick brown fox jumps over the lazy dog";
+    const csv::hash128 a = csv::hash_bytes128(text, sizeof text - 1);
+    const csv::hash128 b = csv::hash_bytes128(text, sizeof text - 1);
+    const csv::hash128 c = csv::hash_bytes128(text, sizeof text - 2);
+    BOOST_CHECK(a == b);
+    BOOST_CHECK(a != c);
+    BOOST_CHECK(csv::hash_bytes128(text, 0) ==
+                csv::hash_bytes128(text + 1, 0));
+}
+
+BOOST_AUTO_TEST_CASE(whole_record_test) {
+    std::istringstream in("id,v\n1,a\n2,b\n1,a\n1,b\n\"1\",a\n1,a,\n");
+    std::ostringstream out;
+    csv::deduplicator d;
+    d.has_header(true);
+    d.dedup(in, out);
+    BOOST_CHECK_EQUAL("id,v\r\n1,a\r\n2,b\r\n1,b\r\n1,a,\r\n", out.str());
+    BOOST_CHECK_EQUAL(6u, d.rows_read());
+    BOOST_CHECK_EQUAL(4u, d.rows_written());
+}
+
+BOOST_AUTO_TEST_CASE(key_columns_test) {
+    std::istringstream in("1,a,x\n2,b,x\n1,a,y\n1,b,z\n");
+    std::ostringstream out;
+    csv::deduplicator d;
+    d.key(0);
+    d.key(1);
+    d.dedup(in, out);
+    BOOST_CHECK_EQUAL("1,a,x\r\n2,b,x\r\n1,b,z\r\n", out.str());
+
+    std::istringstream again("1,a,q\n3,c,q\n");
+    csv::batch_reader reader(again);
+    csv::row_batch batch;
+    reader.next(batch);
+    BOOST_CHECK(d.insert(batch, 0));
+    BOOST_CHECK(!d.insert(batch, 0));
+    BOOST_CHECK(d.insert(batch, 1));
+    BOOST_CHECK_EQUAL(2u, d.size());
+}
+
+BOOST_AUTO_TEST_CASE(spill_test) {
+    const std::string text = make_input(3000);
+
+    std::istringstream in_memory(text);
+    std::ostringstream expected;
+    csv::deduplicator a;
+    a.dedup(in_memory, expected);
+    BOOST_CHECK_EQUAL(2000u, a.rows_written());
+
+    std::istringstream spilled_in(text);
+    std::ostringstream spilled;
+    csv::deduplicator b;
+    b.memory_budget(1024);
+    b.partitions(4);
+    b.dedup(spilled_in, spilled);
+    BOOST_CHECK_EQUAL(3000u, b.rows_read());
+    BOOST_CHECK_EQUAL(2000u, b.rows_written());
+
+    // Spilled records come out grouped by partition.
+    std::vector<std::string> x = lines(expected.str());
+    std::vector<std::string> y = lines(spilled.str());
+    std::sort(x.begin(), x.end());
+    std::sort(y.begin(), y.end());
+    BOOST_CHECK(x == y);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,143 @@
+#include "text/csv/indexed.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace csv = ::text::csv;
+
+namespace {
+
+struct key_less {
+    bool operator()(const csv::row &r, unsigned long key) const {
+        return csv::field_cast<unsigned long>(r[0]) < key;
+    }
+};
+
+std::string sorted_rows(std::size_t rows) {
+    std::ostringstream os;
+    csv::csv_ostream out(os);
+    out << "id" << "name" << csv::endl;
+    for (std::size_t i = 0; i < rows; ++i) {
+        out << static_cast<unsigned long>(i * 2)
+            << (i % 5 ? "plain" : "with, \"quotes\"\nand a newline")
+            << csv::endl;
+    }
+    out.flush();
+    return os.str();
+}
+}
+
+BOOST_AUTO_TEST_SUITE(csv_indexed)
+
+BOOST_AUTO_TEST_CASE(random_access_test) {
+    const std::string text = "a,b\r\n"
+                             "1,\"x\"\"y\"\r\n"
+                             "2,\"multi\nline\"\n"
+                             "3,\n"
+                             "4,last";
+    csv::indexed_file rows(text.data(), text.data() + text.size());
+    BOOST_REQUIRE_EQUAL(rows.size(), 4u);
+    BOOST_CHECK_EQUAL(rows.header().index_of("b"), 1u);
+
+    BOOST_CHECK_EQUAL(rows[0][1], "x\"y");
+    BOOST_CHECK_EQUAL(rows[1][1], "multi\nline");
+    BOOST_CHECK_EQUAL(rows[2].size(), 2u);
+    BOOST_CHECK_EQUAL(rows[2][1], "");
+    BOOST_CHECK_EQUAL(rows[3][1], "last");
+    BOOST_CHECK_EQUAL(rows.field(0, 1), "x\"y");
+    BOOST_CHECK_EQUAL(rows.as<int>(3, 0), 4);
+    BOOST_CHECK_THROW(rows.at(4), std::out_of_range);
+    BOOST_CHECK_THROW(rows.field(0, 2), std::runtime_error);
+
+    csv::indexed_file::const_iterator i = rows.end();
+    BOOST_CHECK_EQUAL(i - rows.begin(), 4);
+    --i;
+    BOOST_CHECK_EQUAL((*i)[0], "4");
+    BOOST_CHECK_EQUAL(rows.begin()[2][0], "3");
+    BOOST_CHECK(rows.begin() + 4 == rows.end());
+
+    csv::indexed_file no_header(text.data(), text.data() + text.size(), false);
+    BOOST_CHECK_EQUAL(no_header.size(), 5u);
+    BOOST_CHECK_EQUAL(no_header[0][0], "a");
+}
+
+BOOST_AUTO_TEST_CASE(binary_search_test) {
+    const std::string text = sorted_rows(1000);
+    csv::indexed_file rows(text.data(), text.data() + text.size());
+    BOOST_REQUIRE_EQUAL(rows.size(), 1000u);
+
+    csv::indexed_file::const_iterator i =
+        std::lower_bound(rows.begin(), rows.end(), 500ul, key_less());
+    BOOST_CHECK_EQUAL(i.index(), 250u);
+    BOOST_CHECK_EQUAL((*i)[1], "with, \"quotes\"\nand a newline");
+
+    BOOST_CHECK_EQUAL(rows.lower_bound(0, 501ul).index(), 251u);
+    BOOST_CHECK_EQUAL(rows.upper_bound(0, 500ul).index(), 251u);
+    BOOST_CHECK(rows.lower_bound(0, 5000ul) == rows.end());
+    BOOST_CHECK(rows.lower_bound(0, 0ul) == rows.begin());
+
+    const std::string names = "name\nb\nd\nf\n";
+    csv::indexed_file by_name(names.data(), names.data() + names.size());
+    BOOST_CHECK_EQUAL(by_name.lower_bound(0, std::string("c")).index(), 1u);
+    BOOST_CHECK_EQUAL(by_name.upper_bound(0, std::string("d")).index(), 2u);
+}
+
+BOOST_AUTO_TEST_CASE(errors_test) {
+    const std::string open = "a\n\"unterminated\n";
+    BOOST_CHECK_THROW(csv::indexed_file(open.data(), open.data() + open.size()),
+                      std::runtime_error);
+
+    const std::string empty;
+    csv::indexed_file none(empty.data(), empty.data());
+    BOOST_CHECK(none.empty());
+    BOOST_CHECK(none.begin() == none.end());
+}
+
+BOOST_AUTO_TEST_CASE(wide_test) {
+    const std::wstring text = L"k;v\n1;one\n2;two\n";
+    csv::windexed_file rows(text.data(), text.data() + text.size(), true,
+                            L';');
+    BOOST_REQUIRE_EQUAL(rows.size(), 2u);
+    BOOST_CHECK(rows[1][1] == L"two");
+}
+
+#if defined(TEXT_CSV_HAS_POSIX_IO)
+
+BOOST_AUTO_TEST_CASE(mapped_file_test) {
+    char path[] = "/tmp/text_csv_indexed_XXXXXX";
+    const int fd = ::mkstemp(path);
+    BOOST_REQUIRE(fd >= 0);
+    ::close(fd);
+
+    const std::string text = sorted_rows(10000);
+    {
+        std::ofstream out(path, std::ios_base::binary);
+        out << text;
+    }
+    {
+        csv::indexed_file rows(path);
+        BOOST_REQUIRE_EQUAL(rows.size(), 10000u);
+        BOOST_CHECK_EQUAL(rows.header().name_of(1), "name");
+        BOOST_CHECK_EQUAL(rows.lower_bound(0, 12345ul).index(), 6173u);
+        BOOST_CHECK_EQUAL(rows[9999][0], "19998");
+    }
+    {
+        std::ofstream truncate(path, std::ios_base::binary);
+    }
+    {
+        csv::indexed_file rows(path);
+        BOOST_CHECK(rows.empty());
+    }
+    std::remove(path);
+    BOOST_CHECK_THROW(csv::indexed_file rows(path), std::runtime_error);
+}
+
+#endif
+
+BOOST_AUTO_TEST_SUITE_END()
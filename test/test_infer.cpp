@@ -0,0 +1,92 @@
+#include "text/csv/infer.hpp"
+#include "text/csv/table.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <sstream>
+#include <string>
+
+namespace csv = ::text::csv;
+
+namespace {
+
+bool parse_timestamp(const char *text, csv::timestamp &ts) {
+    const std::string s(text);
+    return csv::convert<csv::timestamp>::parse(s.data(), s.data() + s.size(),
+                                               ts);
+}
+}
+
+BOOST_AUTO_TEST_SUITE(csv_infer)
+
+BOOST_AUTO_TEST_CASE(timestamp_convert_test) {
+    csv::timestamp ts;
+    BOOST_CHECK(parse_timestamp("1970-01-01", ts));
+    BOOST_CHECK_EQUAL(0, ts.micros);
+    BOOST_CHECK(parse_timestamp("2000-03-01T00:00:01.5Z", ts));
+    BOOST_CHECK_EQUAL(951868801500000LL, ts.micros);
+    BOOST_CHECK(parse_timestamp("2000-03-01 02:00:01.5+02:00", ts));
+    BOOST_CHECK_EQUAL(951868801500000LL, ts.micros);
+    BOOST_CHECK(parse_timestamp("1969-12-31T23:59", ts));
+    BOOST_CHECK_EQUAL(-60000000LL, ts.micros);
+
+    BOOST_CHECK(!parse_timestamp("2001-02-29", ts));
+    BOOST_CHECK(!parse_timestamp("2000-13-01", ts));
+    BOOST_CHECK(!parse_timestamp("2000-01-01T25:00", ts));
+    BOOST_CHECK(!parse_timestamp("12", ts));
+}
+
+BOOST_AUTO_TEST_CASE(infer_schema_test) {
+    std::istringstream in("id,price,flag,when,name,sparse\n"
+                          "1,2,true,2020-01-01,a,\n"
+                          "2,2.5,false,2020-01-02T10:00,b,3\n"
+                          "3,-1,1,2020-01-03,7,4\n");
+    const csv::schema s = csv::infer_schema(in);
+
+    BOOST_REQUIRE_EQUAL(6u, s.size());
+    BOOST_CHECK_EQUAL(csv::int64_column, s[0].type);
+    BOOST_CHECK(!s[0].nullable);
+    BOOST_CHECK_EQUAL(csv::double_column, s[1].type);
+    BOOST_CHECK_EQUAL(csv::bool_column, s[2].type);
+    BOOST_CHECK_EQUAL(csv::timestamp_column, s[3].type);
+    BOOST_CHECK_EQUAL(csv::string_column, s[4].type);
+    BOOST_CHECK_EQUAL(csv::int64_column, s[5].type);
+    BOOST_CHECK(s[5].nullable);
+    BOOST_CHECK_EQUAL("when", s[3].name);
+}
+
+BOOST_AUTO_TEST_CASE(infer_non_finite_test) {
+    std::istringstream in("note,score\nNaN,1.5\ninf,nan\nNaN,-Infinity\n");
+    const csv::schema s = csv::infer_schema(in);
+
+    BOOST_REQUIRE_EQUAL(2u, s.size());
+    BOOST_CHECK_EQUAL(csv::string_column, s[0].type);
+    BOOST_CHECK_EQUAL(csv::double_column, s[1].type);
+}
+
+BOOST_AUTO_TEST_CASE(infer_from_sample_test) {
+    const std::string text = "x,y\n1,a\n2\n3.5,b\n";
+
+    std::istringstream in(text);
+    const csv::schema s = csv::infer_schema(in, 2);
+    BOOST_CHECK_EQUAL(csv::int64_column, s[0].type);
+    BOOST_CHECK_EQUAL(csv::string_column, s[1].type);
+    BOOST_CHECK(s[1].nullable);
+
+    std::istringstream all(text);
+    BOOST_CHECK_EQUAL(csv::double_column, csv::infer_schema(all)[0].type);
+}
+
+BOOST_AUTO_TEST_CASE(load_inferred_schema_test) {
+    const std::string text = "when,count\n2020-01-01,1\n1970-01-02,\n";
+    std::istringstream sample(text);
+    const csv::schema s = csv::infer_schema(sample);
+
+    std::istringstream in(text);
+    csv::table t(in, s);
+    BOOST_CHECK_EQUAL(csv::timestamp_column, t.column(0).type());
+    BOOST_CHECK_EQUAL(86400000000LL, t.column(0).int64_data()[1]);
+    BOOST_CHECK(t.column("count").is_null(1));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -7,6 +7,8 @@
 #include <vector>
 #include <algorithm>
 #include <map>
+#include <numeric>
+#include <stdexcept>
 
 namespace csv = ::text::csv;
 
@@ -113,4 +115,44 @@ BOOST_AUTO_TEST_CASE(map_construction_test) {
     BOOST_CHECK_EQUAL(map["c"], "3");
 }
 
+BOOST_AUTO_TEST_CASE(column_scan_iterator_test) {
+    std::istringstream in("name,price,note\r\n"
+                          "\"a, \"\"quoted\"\"\",1.5,x\r\n"
+                          "b,2.25,\"multi\nline\"\n"
+                          "c,3,\r\n"
+                          "d,4,last");
+    csv::csv_istream is(in);
+    const double sum = std::accumulate(csv::column_begin<double>(is, "price"),
+                                       csv::column_end<double>(), 0.0);
+    BOOST_CHECK_EQUAL(sum, 10.75);
+}
+
+BOOST_AUTO_TEST_CASE(column_scan_by_index_test) {
+    std::istringstream in("1,one\n2,two\n3,three\n");
+    csv::csv_istream is(in);
+    std::vector<std::string> names(csv::column_begin<std::string>(is, 1),
+                                   csv::column_end<std::string>());
+    BOOST_REQUIRE_EQUAL(names.size(), 3u);
+    BOOST_CHECK_EQUAL(names[0], "one");
+    BOOST_CHECK_EQUAL(names[2], "three");
+
+    std::wistringstream win(L"x,y\n1,2\n3,4\n");
+    csv::csv_wistream wis(win);
+    const int total = std::accumulate(csv::column_begin<int>(wis, L"y"),
+                                      csv::column_end<int, wchar_t>(), 0);
+    BOOST_CHECK_EQUAL(total, 6);
+}
+
+BOOST_AUTO_TEST_CASE(column_scan_errors_test) {
+    std::istringstream unknown("a,b\n1,2\n");
+    csv::csv_istream is(unknown);
+    BOOST_CHECK_THROW(csv::column_begin<int>(is, "c"), std::out_of_range);
+
+    std::istringstream short_row("a,b\n1,2\n3\n");
+    csv::csv_istream short_is(short_row);
+    csv::column_scan_iterator<int> it = csv::column_begin<int>(short_is, "b");
+    BOOST_CHECK_EQUAL(*it, 2);
+    BOOST_CHECK_THROW(++it, std::runtime_error);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
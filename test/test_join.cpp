@@ -0,0 +1,129 @@
+#include "text/csv/join.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace csv = ::text::csv;
+
+namespace {
+
+const char *const USERS = "id,name,country\n"
+                          "1,alice,NL\n"
+                          "2,bob,US\n"
+                          "3,\"carol, jr\",DE\n"
+                          "2,bobby,CA\n";
+
+const char *const ORDERS = "order,user,total\n"
+                           "100,2,9.5\n"
+                           "101,4,1\n"
+                           "102,1,20\n";
+
+std::string join(csv::join_kind kind) {
+    std::istringstream users(USERS);
+    csv::batch_reader build(users);
+    build.read_header();
+
+    csv::hash_join j(kind);
+    j.on(0, 1);
+    j.build(build);
+
+    std::istringstream orders(ORDERS);
+    csv::batch_reader probe(orders);
+    probe.read_header();
+
+    std::ostringstream os;
+    csv::csv_ostream out(os);
+    j.probe(probe, out);
+    return os.str();
+}
+
+struct collector {
+    explicit collector(const csv::hash_join &j, std::vector<std::string> &v)
+        : join(&j)
+        , out(&v) {}
+
+    void operator()(const csv::row_batch &batch, std::size_t row,
+                    std::size_t record) const {
+        std::string s = batch.field(row, 0).str();
+        s += record == csv::hash_join::npos
+                 ? std::string("-")
+                 : join->payload_field(record, 0).str();
+        out->push_back(s);
+    }
+
+    const csv::hash_join *join;
+    std::vector<std::string> *out;
+};
+}
+
+BOOST_AUTO_TEST_SUITE(csv_join)
+
+BOOST_AUTO_TEST_CASE(inner_join_test) {
+    BOOST_CHECK_EQUAL("order,user,total,name,country\r\n"
+                      "100,2,9.5,bob,US\r\n"
+                      "100,2,9.5,bobby,CA\r\n"
+                      "102,1,20,alice,NL\r\n",
+                      join(csv::inner_join));
+}
+
+BOOST_AUTO_TEST_CASE(left_join_test) {
+    BOOST_CHECK_EQUAL("order,user,total,name,country\r\n"
+                      "100,2,9.5,bob,US\r\n"
+                      "100,2,9.5,bobby,CA\r\n"
+                      "101,4,1,,\r\n"
+                      "102,1,20,alice,NL\r\n",
+                      join(csv::left_join));
+}
+
+BOOST_AUTO_TEST_CASE(callback_probe_test) {
+    std::istringstream build_in("a,x,1\nb,y,2\na,y,3\n");
+    csv::batch_reader build(build_in);
+
+    csv::hash_join j(csv::left_join);
+    j.on(0, 1);
+    j.on(1, 2);
+    j.payload(2);
+    j.build(build);
+    BOOST_CHECK_EQUAL(3u, j.size());
+    BOOST_CHECK_EQUAL(1u, j.payload_size());
+
+    std::istringstream probe_in("p,a,y\nq,b,x\nr,a,x\ns,a\n");
+    csv::batch_reader probe(probe_in);
+    probe.batch_size(2);
+
+    std::vector<std::string> rows;
+    j.probe(probe, collector(j, rows));
+
+    BOOST_REQUIRE_EQUAL(4u, rows.size());
+    BOOST_CHECK_EQUAL("p3", rows[0]);
+    BOOST_CHECK_EQUAL("q-", rows[1]);
+    BOOST_CHECK_EQUAL("r1", rows[2]);
+    BOOST_CHECK_EQUAL("s-", rows[3]);
+}
+
+BOOST_AUTO_TEST_CASE(ragged_probe_test) {
+    std::istringstream build_in("1,alice\n2,bob\n");
+    csv::batch_reader build(build_in);
+
+    csv::hash_join j(csv::left_join);
+    j.on(0, 0);
+    j.build(build);
+
+    std::istringstream probe_in("id,qty,note\n1,5,x\n2\n3,7\n");
+    csv::batch_reader probe(probe_in);
+    probe.read_header();
+
+    std::ostringstream os;
+    csv::csv_ostream out(os);
+    j.probe(probe, out);
+    BOOST_CHECK_EQUAL("id,qty,note,\r\n"
+                      "1,5,x,alice\r\n"
+                      "2,,,bob\r\n"
+                      "3,7,,\r\n",
+                      os.str());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
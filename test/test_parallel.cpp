@@ -0,0 +1,104 @@
+#if __cplusplus >= 201103
+
+#include "text/csv/iterator.hpp"
+#include "text/csv/parallel.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace csv = ::text::csv;
+
+namespace {
+
+std::string make_rows(std::size_t rows) {
+    std::ostringstream os;
+    csv::csv_ostream out(os);
+    out << "id" << "text" << csv::endl;
+    for (std::size_t i = 0; i < rows; ++i) {
+        out << static_cast<unsigned long>(i)
+            << (i % 3 ? "a,b" : "line\nbreak \"quoted\"") << csv::endl;
+    }
+    out.flush();
+    return os.str();
+}
+}
+
+BOOST_AUTO_TEST_SUITE(csv_parallel)
+
+BOOST_AUTO_TEST_CASE(parallel_for_each_test) {
+    const std::string text = make_rows(10000);
+    csv::indexed_file file(text.data(), text.data() + text.size());
+
+    std::istringstream in(text);
+    csv::row_range serial(in);
+    std::vector<std::string> expected;
+    csv::row_range::iterator i = serial.begin();
+    for (++i; i != serial.end(); ++i)
+        expected.push_back((*i)[1]);
+
+    for (unsigned threads = 0; threads <= 4; threads += 2) {
+        std::vector<std::string> seen(file.size());
+        std::vector<unsigned> calls(std::max(threads, 1u));
+        csv::parallel_for_each(file, threads,
+                               [&](unsigned worker, const csv::row &r) {
+                                   seen[r.as<std::size_t>(0)] = r[1];
+                                   ++calls[worker];
+                               });
+        BOOST_CHECK(seen == expected);
+        unsigned total = 0;
+        for (unsigned n : calls)
+            total += n;
+        BOOST_CHECK_EQUAL(total, 10000u);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(parallel_transform_reduce_test) {
+    const std::string text = make_rows(5000);
+    csv::indexed_file file(text.data(), text.data() + text.size());
+
+    const unsigned long sum = csv::parallel_transform_reduce(
+        file, 4, 7ul,
+        [](unsigned long a, unsigned long b) { return a + b; },
+        [](const csv::row &r) { return r.as<unsigned long>(0); });
+    BOOST_CHECK_EQUAL(sum, 7ul + 4999ul * 5000ul / 2);
+
+    // Chunk results are combined in file order.
+    const std::string ids = csv::parallel_transform_reduce(
+        file, 3, std::string(),
+        [](std::string a, const std::string &b) { return a + b; },
+        [](const csv::row &r) { return r[0].substr(r[0].size() - 1); });
+    std::string expected;
+    for (std::size_t i = 0; i < 5000; ++i)
+        expected += char('0' + i % 10);
+    BOOST_CHECK(ids == expected);
+
+    csv::indexed_file empty(text.data(), text.data());
+    BOOST_CHECK_EQUAL(csv::parallel_transform_reduce(
+                          empty, 4, 1, [](int a, int b) { return a + b; },
+                          [](const csv::row &) { return 1; }),
+                      1);
+}
+
+BOOST_AUTO_TEST_CASE(parallel_error_test) {
+    const std::string text = make_rows(1000);
+    csv::indexed_file file(text.data(), text.data() + text.size());
+    std::atomic<unsigned> calls(0);
+    BOOST_CHECK_THROW(
+        csv::parallel_for_each(file, 4,
+                               [&](unsigned, const csv::row &r) {
+                                   ++calls;
+                                   if (r[0] == "500")
+                                       throw std::runtime_error("stop");
+                               }),
+        std::runtime_error);
+    BOOST_CHECK(calls.load() <= 1000u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+#endif
@@ -0,0 +1,107 @@
+#include "text/csv/parallel_writer.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <sstream>
+#include <string>
+
+#if __cplusplus >= 201103
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace csv = ::text::csv;
+
+namespace {
+
+const std::size_t BLOCK_ROWS = 50;
+
+void format_block(csv::csv_ostream &out, uint64_t seq) {
+    for (std::size_t i = 0; i < BLOCK_ROWS; ++i) {
+        const uint64_t row = seq * BLOCK_ROWS + i;
+        out << static_cast<unsigned long>(row) << double(row) / 7
+            << (row % 5 ? "plain" : "with, \"quotes\"") << csv::endl;
+    }
+}
+}
+
+BOOST_AUTO_TEST_SUITE(csv_parallel_writer)
+
+BOOST_AUTO_TEST_CASE(ordered_commit_test) {
+    const uint64_t blocks = 200;
+
+    std::ostringstream expected;
+    {
+        csv::csv_ostream out(expected);
+        for (uint64_t b = 0; b < blocks; ++b)
+            format_block(out, b);
+    }
+
+    std::ostringstream os;
+    csv::parallel_writer writer(os, 8);
+    std::atomic<uint64_t> next(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&] {
+            for (uint64_t b; (b = next++) < blocks;) {
+                writer.write(b, [b](csv::csv_ostream &out) {
+                    format_block(out, b);
+                });
+            }
+        });
+    }
+    for (std::thread &t : threads)
+        t.join();
+    writer.close();
+
+    BOOST_CHECK_EQUAL(blocks, writer.committed());
+    BOOST_CHECK(expected.str() == os.str());
+}
+
+BOOST_AUTO_TEST_CASE(failed_block_test) {
+    std::ostringstream os;
+    csv::parallel_writer writer(os, ';', '\'');
+
+    writer.write(1, [](csv::csv_ostream &out) {
+        out << "b;c" << 2 << csv::endl;
+    });
+    BOOST_CHECK_THROW(writer.write(0,
+                                   [](csv::csv_ostream &out) {
+                                       out << "lost" << csv::endl;
+                                       throw std::runtime_error("failed");
+                                   }),
+                      std::runtime_error);
+    writer.write(3, [](csv::csv_ostream &out) { out << "d" << csv::endl; });
+    BOOST_CHECK_EQUAL(2u, writer.committed());
+    BOOST_CHECK_THROW(writer.close(), std::runtime_error);
+
+    writer.write(2, [](csv::csv_ostream &) {});
+    writer.close();
+    BOOST_CHECK_EQUAL("'b;c';2\r\nd\r\n", os.str());
+}
+
+BOOST_AUTO_TEST_CASE(close_waits_for_writers_test) {
+    std::ostringstream os;
+    csv::parallel_writer writer(os);
+    std::atomic<bool> started(false);
+    std::thread t([&] {
+        writer.write(0, [&](csv::csv_ostream &out) {
+            started = true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            out << "late" << csv::endl;
+        });
+    });
+    while (!started)
+        std::this_thread::yield();
+    writer.close();
+    BOOST_CHECK_EQUAL(1u, writer.committed());
+    BOOST_CHECK_EQUAL("late\r\n", os.str());
+    t.join();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+#endif
@@ -0,0 +1,185 @@
+#include "text/csv/partition.hpp"
+#include "text/csv/temp_files.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace csv = ::text::csv;
+
+namespace {
+
+std::string make_input(std::size_t n) {
+    std::ostringstream os;
+    csv::csv_ostream out(os);
+    out << "id" << "key" << "value" << csv::endl;
+    for (std::size_t i = 0; i < n; ++i) {
+        const char *const keys[] = {"a", "b", "c/d", "e, f"};
+        out << int(i) << keys[i % 4] << "text" << csv::endl;
+    }
+    return os.str();
+}
+
+std::vector<std::string> read_lines(const std::string &path) {
+    std::ifstream in(path.c_str(), std::ios_base::binary);
+    std::vector<std::string> v;
+    std::string line;
+    while (std::getline(in, line))
+        v.push_back(line);
+    return v;
+}
+
+void remove_files(const std::vector<std::string> &paths) {
+    for (std::size_t i = 0; i < paths.size(); ++i)
+        std::remove(paths[i].c_str());
+}
+
+std::string temp_prefix(csv::detail::temp_files &tmp) {
+    return tmp.create() + "-";
+}
+}
+
+BOOST_AUTO_TEST_SUITE(csv_partition)
+
+BOOST_AUTO_TEST_CASE(hash_partitions_test) {
+    csv::detail::temp_files tmp(csv::detail::default_temp_directory());
+    const std::string input = make_input(1000);
+
+    std::vector<std::string> paths;
+    {
+        csv::partitioned_writer writer(temp_prefix(tmp));
+        writer.by_hash(1, 3);
+        writer.has_header(true);
+        // Force repeated flushes and reopening of evicted files.
+        writer.buffer_size(64);
+        writer.max_open_files(2);
+
+        std::istringstream in(input);
+        csv::batch_reader reader(in);
+        writer.write(reader);
+        writer.close();
+        BOOST_CHECK_EQUAL(writer.rows_written(), 1000u);
+        paths = writer.paths();
+    }
+    BOOST_REQUIRE_EQUAL(paths.size(), 3u);
+
+    std::multiset<std::string> expected, actual;
+    {
+        std::istringstream in(input);
+        std::string line;
+        std::getline(in, line);
+        while (std::getline(in, line))
+            expected.insert(line);
+    }
+    std::map<std::string, std::size_t> key_files;
+    for (std::size_t f = 0; f < paths.size(); ++f) {
+        const std::vector<std::string> lines = read_lines(paths[f]);
+        BOOST_REQUIRE(!lines.empty());
+        BOOST_CHECK_EQUAL(lines[0], "id,key,value\r");
+        for (std::size_t i = 1; i < lines.size(); ++i) {
+            actual.insert(lines[i]);
+            // Every key goes to exactly one file.
+            const std::string key =
+                lines[i].substr(lines[i].find(',') + 1, 1);
+            if (key_files.count(key))
+                BOOST_CHECK_EQUAL(key_files[key], f);
+            key_files[key] = f;
+        }
+    }
+    BOOST_CHECK(actual == expected);
+    remove_files(paths);
+}
+
+BOOST_AUTO_TEST_CASE(value_partitions_test) {
+    csv::detail::temp_files tmp(csv::detail::default_temp_directory());
+    const std::string prefix = temp_prefix(tmp);
+
+    std::vector<std::string> paths;
+    {
+        csv::partitioned_writer writer(prefix, ".txt");
+        writer.by_value(1);
+        std::istringstream in(make_input(8));
+        csv::batch_reader reader(in);
+        reader.read_header();
+        writer.write(reader);
+        paths = writer.paths();
+        BOOST_CHECK(paths.empty());
+    }
+
+    std::vector<std::string> names;
+    names.push_back(prefix + "a.txt");
+    names.push_back(prefix + "b.txt");
+    names.push_back(prefix + "c_d.txt");
+    names.push_back(prefix + "e__f.txt");
+    for (std::size_t i = 0; i < names.size(); ++i) {
+        const std::vector<std::string> lines = read_lines(names[i]);
+        BOOST_REQUIRE_EQUAL(lines.size(), 2u);
+        std::ostringstream first, second;
+        first << i << ",";
+        second << i + 4 << ",";
+        BOOST_CHECK_EQUAL(lines[0].substr(0, 2), first.str());
+        BOOST_CHECK_EQUAL(lines[1].substr(0, 2), second.str());
+    }
+    remove_files(names);
+}
+
+BOOST_AUTO_TEST_CASE(colliding_value_names_test) {
+    csv::detail::temp_files tmp(csv::detail::default_temp_directory());
+    const std::string prefix = temp_prefix(tmp);
+
+    std::vector<std::string> paths;
+    {
+        csv::partitioned_writer writer(prefix);
+        writer.by_value(0);
+        std::istringstream in("a/b,1\na_b,2\na b,3\na_b_2,4\na/b,5\n");
+        csv::batch_reader reader(in);
+        writer.write(reader);
+        writer.close();
+        paths = writer.paths();
+    }
+    BOOST_REQUIRE_EQUAL(paths.size(), 4u);
+    BOOST_CHECK_EQUAL(paths[0], prefix + "a_b.csv");
+    BOOST_CHECK_EQUAL(paths[1], prefix + "a_b_2.csv");
+    BOOST_CHECK_EQUAL(paths[2], prefix + "a_b_3.csv");
+    BOOST_CHECK_EQUAL(paths[3], prefix + "a_b_2_2.csv");
+
+    const std::vector<std::string> first = read_lines(paths[0]);
+    BOOST_REQUIRE_EQUAL(first.size(), 2u);
+    BOOST_CHECK_EQUAL(first[0], "a/b,1\r");
+    BOOST_CHECK_EQUAL(first[1], "a/b,5\r");
+    BOOST_CHECK_EQUAL(read_lines(paths[1]).at(0), "a_b,2\r");
+    BOOST_CHECK_EQUAL(read_lines(paths[2]).at(0), "a b,3\r");
+    BOOST_CHECK_EQUAL(read_lines(paths[3]).at(0), "a_b_2,4\r");
+    remove_files(paths);
+}
+
+BOOST_AUTO_TEST_CASE(rolling_test) {
+    csv::detail::temp_files tmp(csv::detail::default_temp_directory());
+
+    std::vector<std::string> paths;
+    {
+        csv::partitioned_writer writer(temp_prefix(tmp));
+        writer.rolling(3, 0);
+        writer.has_header(true);
+        std::istringstream in(make_input(10));
+        csv::batch_reader reader(in);
+        writer.write(reader);
+        writer.close();
+        paths = writer.paths();
+    }
+    BOOST_REQUIRE_EQUAL(paths.size(), 4u);
+    for (std::size_t f = 0; f < paths.size(); ++f) {
+        const std::vector<std::string> lines = read_lines(paths[f]);
+        BOOST_CHECK_EQUAL(lines.size(), f < 3 ? 4u : 2u);
+        BOOST_CHECK_EQUAL(lines[0], "id,key,value\r");
+    }
+    remove_files(paths);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,146 @@
+#include "text/csv/profile.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <cmath>
+#include <limits>
+#include <sstream>
+#include <string>
+
+namespace csv = ::text::csv;
+
+namespace {
+
+std::string make_input(std::size_t n) {
+    std::ostringstream os;
+    for (std::size_t i = 0; i < n; ++i) {
+        os << "user" << (i % 1000) << "," << i;
+        if (i % 10 != 0)
+            os << "," << (i % 2 ? "x" : "");
+        os << "\n";
+    }
+    return os.str();
+}
+}
+
+BOOST_AUTO_TEST_SUITE(csv_profile)
+
+BOOST_AUTO_TEST_CASE(hyperloglog_test) {
+    csv::hyperloglog a, b;
+    for (int i = 0; i < 20000; ++i) {
+        (i % 2 ? a : b).add(csv::hash_bytes(&i, sizeof i));
+    }
+    a.merge(b);
+    BOOST_CHECK_CLOSE(20000.0, a.estimate(), 5.0);
+
+    csv::hyperloglog small;
+    for (int i = 0; i < 200; ++i) {
+        const int v = i % 100;
+        small.add(csv::hash_bytes(&v, sizeof v));
+    }
+    BOOST_CHECK_CLOSE(100.0, small.estimate(), 3.0);
+}
+
+BOOST_AUTO_TEST_CASE(quantile_sketch_test) {
+    csv::quantile_sketch a, b;
+    for (int i = 0; i < 100000; ++i) {
+        // Interleave values so that both halves cover the whole range.
+        (i % 3 ? a : b).add(double((i * 7919) % 100000));
+    }
+    BOOST_CHECK(a.size() < 1000);
+    a.merge(b);
+    BOOST_CHECK_EQUAL(100000u, a.count());
+    BOOST_CHECK(std::fabs(a.quantile(0.5) - 50000) < 2000);
+    BOOST_CHECK(std::fabs(a.quantile(0.9) - 90000) < 2000);
+    BOOST_CHECK(std::isnan(csv::quantile_sketch().quantile(0.5)));
+}
+
+BOOST_AUTO_TEST_CASE(column_profile_test) {
+    std::istringstream in("name,score\n"
+                          "bob,10\n"
+                          "alice,\n"
+                          "carol,4\n"
+                          "bob,7,extra\n"
+                          "dave\n");
+    csv::batch_reader reader(in);
+    reader.read_header();
+    csv::profiler p;
+    p.consume(reader);
+
+    BOOST_CHECK_EQUAL(5u, p.rows());
+    BOOST_REQUIRE_EQUAL(3u, p.size());
+
+    const csv::column_profile &name = p[0];
+    BOOST_CHECK(!name.is_numeric());
+    BOOST_CHECK_EQUAL(5u, name.count());
+    BOOST_CHECK_EQUAL("alice", name.min_value());
+    BOOST_CHECK_EQUAL("dave", name.max_value());
+    BOOST_CHECK_EQUAL(5u, name.max_length());
+    BOOST_CHECK_CLOSE(4.0, name.distinct(), 1.0);
+    BOOST_CHECK(std::isnan(name.mean()));
+
+    const csv::column_profile &score = p[1];
+    BOOST_CHECK(score.is_numeric());
+    BOOST_CHECK_EQUAL(1u, p.missing(1));
+    BOOST_CHECK_EQUAL(1u, score.empty_count());
+    BOOST_CHECK_EQUAL(3u, score.numeric_count());
+    BOOST_CHECK_EQUAL(4.0, score.min());
+    BOOST_CHECK_EQUAL(10.0, score.max());
+    BOOST_CHECK_CLOSE(7.0, score.mean(), 1e-9);
+    BOOST_CHECK_CLOSE(6.0, score.variance(), 1e-9);
+    BOOST_CHECK_EQUAL(7.0, score.quantile(0.5));
+
+    BOOST_CHECK_EQUAL(4u, p.missing(2));
+}
+
+BOOST_AUTO_TEST_CASE(non_finite_profile_test) {
+    std::istringstream in("1\n2\nnan\n3\ninf\n-Infinity\n");
+    csv::batch_reader reader(in);
+    csv::profiler p;
+    p.consume(reader);
+
+    const csv::column_profile &c = p[0];
+    BOOST_CHECK(c.is_numeric());
+    BOOST_CHECK_EQUAL(3u, c.numeric_count());
+    BOOST_CHECK_EQUAL(3u, c.non_finite_count());
+    BOOST_CHECK_EQUAL(1.0, c.min());
+    BOOST_CHECK_EQUAL(3.0, c.max());
+    BOOST_CHECK_CLOSE(2.0, c.mean(), 1e-9);
+    BOOST_CHECK_EQUAL(2.0, c.quantile(0.5));
+
+    csv::quantile_sketch s;
+    s.add(std::numeric_limits<double>::quiet_NaN());
+    BOOST_CHECK_EQUAL(0u, s.count());
+}
+
+BOOST_AUTO_TEST_CASE(parallel_profile_test) {
+    const std::string text = make_input(20000);
+
+    std::istringstream serial_in(text);
+    csv::batch_reader serial_reader(serial_in);
+    csv::profiler serial;
+    serial.consume(serial_reader);
+
+    std::istringstream parallel_in(text);
+    csv::batch_reader parallel_reader(parallel_in);
+    parallel_reader.batch_size(500);
+    csv::profiler parallel;
+#if __cplusplus >= 201103
+    parallel.consume(parallel_reader, 4);
+#else
+    parallel.consume(parallel_reader);
+#endif
+
+    BOOST_CHECK_EQUAL(20000u, parallel.rows());
+    BOOST_REQUIRE_EQUAL(3u, parallel.size());
+    BOOST_CHECK_EQUAL(2000u, parallel.missing(2));
+    BOOST_CHECK_EQUAL(8000u, parallel[2].empty_count());
+    BOOST_CHECK_EQUAL(serial[0].distinct(), parallel[0].distinct());
+    BOOST_CHECK_CLOSE(1000.0, parallel[0].distinct(), 5.0);
+    BOOST_CHECK_CLOSE(serial[1].mean(), parallel[1].mean(), 1e-9);
+    BOOST_CHECK_CLOSE(serial[1].variance(), parallel[1].variance(), 1e-9);
+    BOOST_CHECK_EQUAL(19999.0, parallel[1].max());
+    BOOST_CHECK(std::fabs(parallel[1].quantile(0.25) - 5000) < 400);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
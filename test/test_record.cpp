@@ -0,0 +1,128 @@
+#include <boost/test/unit_test.hpp>
+
+#if __cplusplus >= 201103
+
+#include "text/csv/record.hpp"
+
+#include <sstream>
+#include <string>
+#include <tuple>
+
+namespace csv = ::text::csv;
+
+namespace {
+
+struct trade {
+    long id;
+    std::string symbol;
+    double price;
+    bool settled;
+};
+}
+
+namespace text {
+namespace csv {
+
+template <>
+struct record_fields<trade> {
+    static auto get(const trade &t)
+        -> decltype(std::tie(t.id, t.symbol, t.price, t.settled)) {
+        return std::tie(t.id, t.symbol, t.price, t.settled);
+    }
+};
+}
+}
+
+namespace {
+
+/// Writes the record with operator<< for comparison.
+template <typename Char>
+std::basic_string<Char> stream_record(const std::basic_ostringstream<Char> &fmt,
+                                      Char delim, int i, double d,
+                                      const std::basic_string<Char> &s,
+                                      const Char *c, bool b) {
+    std::basic_ostringstream<Char> os;
+    os.copyfmt(fmt);
+    csv::basic_csv_ostream<Char, std::char_traits<Char> > out(os, delim);
+    out << i << d << s << c << b << csv::endl;
+    out.flush();
+    return os.str();
+}
+
+template <typename Char>
+std::basic_string<Char> tuple_record(const std::basic_ostringstream<Char> &fmt,
+                                     Char delim, int i, double d,
+                                     const std::basic_string<Char> &s,
+                                     const Char *c, bool b) {
+    std::basic_ostringstream<Char> os;
+    os.copyfmt(fmt);
+    csv::basic_csv_ostream<Char, std::char_traits<Char> > out(os, delim);
+    csv::write_record(out, std::make_tuple(i, d, s, c, b));
+    return os.str();
+}
+}
+
+BOOST_AUTO_TEST_SUITE(csv_record)
+
+BOOST_AUTO_TEST_CASE(tuple_test) {
+    std::ostringstream os;
+    csv::csv_ostream out(os);
+    csv::write_record(out, std::make_tuple(1, 2.5, std::string("a,b"),
+                                           "say \"hi\"", true));
+    csv::write_record(out, std::make_tuple(short(-3), 'x', 7u));
+    BOOST_CHECK_EQUAL(os.str(), "1,2.5,\"a,b\",\"say \"\"hi\"\"\",1\r\n"
+                                "-3,120,7\r\n");
+}
+
+BOOST_AUTO_TEST_CASE(struct_test) {
+    const trade trades[] = {{1, "ABC", 10.25, true}, {2, "X\nY", -1, false}};
+    std::ostringstream os;
+    csv::csv_ostream out(os);
+    out.buffer_size(1024);
+    for (const trade &t : trades)
+        csv::write_record(out, t);
+    out.flush();
+    BOOST_CHECK_EQUAL(os.str(), "1,ABC,10.25,1\r\n"
+                                "2,\"X\nY\",-1,0\r\n");
+}
+
+BOOST_AUTO_TEST_CASE(continued_record_test) {
+    std::ostringstream os;
+    csv::csv_ostream out(os);
+    out << "key";
+    csv::write_record(out, std::make_tuple(1, 2));
+    BOOST_CHECK_EQUAL(os.str(), "key,1,2\r\n");
+}
+
+BOOST_AUTO_TEST_CASE(quoting_test) {
+    std::ostringstream os;
+    csv::csv_ostream out(os);
+    out.quoting(csv::quote_all);
+    csv::write_record(out, std::make_tuple(1, std::string("a"), 0.5));
+    out.quoting(csv::quote_non_numeric);
+    csv::write_record(out, std::make_tuple(1, std::string("a"), 0.5));
+    BOOST_CHECK_EQUAL(os.str(), "\"1\",\"a\",\"0.5\"\r\n"
+                                "1,\"a\",0.5\r\n");
+}
+
+BOOST_AUTO_TEST_CASE(same_as_stream_test) {
+    const std::string s = "with; \"quote\"";
+    std::ostringstream plain, hex;
+    hex << std::hex << std::showbase;
+    const char delims[] = {',', ';', '.', '1'};
+    for (char delim : delims) {
+        BOOST_CHECK_EQUAL(tuple_record(plain, delim, 42, 0.1, s, "c", true),
+                          stream_record(plain, delim, 42, 0.1, s, "c", true));
+        BOOST_CHECK_EQUAL(tuple_record(hex, delim, 42, 0.1, s, "c", true),
+                          stream_record(hex, delim, 42, 0.1, s, "c", true));
+    }
+
+    const std::wstring ws = L"wide, text";
+    std::wostringstream wplain;
+    BOOST_CHECK(tuple_record(wplain, L',', -7, 1e100, ws, L"c", false) ==
+                stream_record(wplain, L',', -7, 1e100, ws, L"c", false));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+#endif
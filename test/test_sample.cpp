@@ -0,0 +1,177 @@
+#if __cplusplus >= 201103
+
+#include "text/csv/sample.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace csv = ::text::csv;
+
+namespace {
+
+// Every record is "id,label"; labels of every third record contain a
+// quoted delimiter and line break.
+std::string make_rows(std::size_t rows) {
+    std::ostringstream os;
+    csv::csv_ostream out(os);
+    out << "id" << "label" << csv::endl;
+    for (std::size_t i = 0; i < rows; ++i) {
+        out << static_cast<unsigned long>(i)
+            << (i % 3 ? "plain" : "quoted, \"multi\"\nline") << csv::endl;
+    }
+    out.flush();
+    return os.str();
+}
+
+void check_row(const csv::row &r) {
+    BOOST_REQUIRE_EQUAL(r.size(), 2u);
+    const std::size_t id = r.as<std::size_t>(0);
+    BOOST_CHECK_EQUAL(r[1], id % 3 ? "plain" : "quoted, \"multi\"\nline");
+}
+}
+
+BOOST_AUTO_TEST_SUITE(csv_sample)
+
+BOOST_AUTO_TEST_CASE(bernoulli_sample_test) {
+    const std::string text = make_rows(10000);
+    std::istringstream in(text);
+    csv::csv_istream is(in);
+    csv::header h(is);
+    std::mt19937 rng(42);
+    std::vector<std::size_t> ids;
+    csv::bernoulli_sample(is, 0.1, rng, [&](const csv::row &r) {
+        check_row(r);
+        ids.push_back(r.as<std::size_t>(0));
+    });
+    BOOST_CHECK(ids.size() > 800 && ids.size() < 1200);
+    for (std::size_t i = 1; i < ids.size(); ++i)
+        BOOST_CHECK(ids[i - 1] < ids[i]);
+
+    std::istringstream all_in(text);
+    csv::csv_istream all(all_in);
+    csv::header all_header(all);
+    std::size_t count = 0;
+    csv::bernoulli_sample(all, 1.0, rng, [&](const csv::row &) { ++count; });
+    BOOST_CHECK_EQUAL(count, 10000u);
+}
+
+BOOST_AUTO_TEST_CASE(reservoir_sample_test) {
+    const std::string text = make_rows(5000);
+    std::istringstream in(text);
+    csv::csv_istream is(in);
+    csv::header h(is);
+    std::mt19937 rng(7);
+    const std::vector<csv::row> sample = csv::reservoir_sample(is, 100, rng);
+    BOOST_REQUIRE_EQUAL(sample.size(), 100u);
+    std::set<std::size_t> ids;
+    for (const csv::row &r : sample) {
+        check_row(r);
+        ids.insert(r.as<std::size_t>(0));
+    }
+    BOOST_CHECK_EQUAL(ids.size(), 100u);
+    // Not just the first records.
+    BOOST_CHECK(*ids.rbegin() > 1000u);
+
+    std::istringstream small_in("1\n2\n3\n");
+    csv::csv_istream small(small_in);
+    BOOST_CHECK_EQUAL(csv::reservoir_sample(small, 10, rng).size(), 3u);
+}
+
+BOOST_AUTO_TEST_CASE(block_sample_test) {
+    const std::string text = make_rows(1000);
+    std::istringstream in(text);
+    csv::csv_istream is(in);
+    csv::header h(is);
+    std::mt19937 rng(3);
+    std::vector<std::size_t> ids;
+    csv::block_sample(is, 10, 0.2, rng, [&](const csv::row &r) {
+        check_row(r);
+        ids.push_back(r.as<std::size_t>(0));
+    });
+    BOOST_CHECK(!ids.empty());
+    BOOST_CHECK_EQUAL(ids.size() % 10, 0u);
+    for (std::size_t i = 0; i < ids.size(); i += 10) {
+        BOOST_CHECK_EQUAL(ids[i] % 10, 0u);
+        BOOST_CHECK_EQUAL(ids[i + 9], ids[i] + 9);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(sample_rows_test) {
+    const std::string text = make_rows(1000);
+    csv::indexed_file file(text.data(), text.data() + text.size());
+    std::mt19937 rng(11);
+    const std::vector<csv::row> sample = csv::sample_rows(file, 50, rng);
+    BOOST_REQUIRE_EQUAL(sample.size(), 50u);
+    for (std::size_t i = 0; i < sample.size(); ++i) {
+        check_row(sample[i]);
+        if (i > 0)
+            BOOST_CHECK(sample[i - 1].as<std::size_t>(0) <
+                        sample[i].as<std::size_t>(0));
+    }
+    BOOST_CHECK_EQUAL(csv::sample_rows(file, 5000, rng).size(), 1000u);
+}
+
+BOOST_AUTO_TEST_CASE(offset_sampler_test) {
+    const std::string text = make_rows(3000);
+    csv::offset_sampler sampler(text.data(), text.data() + text.size());
+    BOOST_CHECK_EQUAL(sampler.header().index_of("label"), 1u);
+    BOOST_CHECK(sampler.estimated_size() > 2500 &&
+                sampler.estimated_size() < 3500);
+
+    std::mt19937 rng(5);
+    std::vector<std::size_t> ids;
+    sampler.sample(200, rng, [&](const csv::row &r) {
+        BOOST_REQUIRE_EQUAL(r.size(), 2u);
+        ids.push_back(r.as<std::size_t>(0));
+    });
+    BOOST_CHECK_EQUAL(ids.size(), 200u);
+
+    std::size_t blocks = 0;
+    sampler.blocks(20, 5, rng, [&](const csv::row &) { ++blocks; });
+    BOOST_CHECK(blocks > 90 && blocks <= 100);
+
+    std::size_t kept = 0;
+    sampler.bernoulli(0.01, rng, [&](const csv::row &) { ++kept; });
+    BOOST_CHECK(kept > 10 && kept < 60);
+
+    const std::string header_only = "a,b\n";
+    csv::offset_sampler none(header_only.data(),
+                             header_only.data() + header_only.size());
+    BOOST_CHECK(none.empty());
+    none.sample(10, rng, [](const csv::row &) { BOOST_ERROR("no rows"); });
+}
+
+#if defined(TEXT_CSV_HAS_POSIX_IO)
+
+BOOST_AUTO_TEST_CASE(mapped_offset_sampler_test) {
+    char path[] = "/tmp/text_csv_sample_XXXXXX";
+    const int fd = ::mkstemp(path);
+    BOOST_REQUIRE(fd >= 0);
+    ::close(fd);
+    {
+        std::ofstream out(path, std::ios_base::binary);
+        out << "x;y\n1;2\n3;4\n";
+    }
+    {
+        csv::offset_sampler sampler(path, true, ';');
+        std::mt19937 rng(1);
+        std::size_t sum = 0;
+        sampler.sample(10, rng,
+                       [&](const csv::row &r) { sum += r.as<int>(1); });
+        BOOST_CHECK(sum >= 20 && sum <= 40);
+    }
+    std::remove(path);
+}
+
+#endif
+
+BOOST_AUTO_TEST_SUITE_END()
+
+#endif
@@ -0,0 +1,132 @@
+#include "text/csv/sink.hpp"
+
+#include "output_rows.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+namespace csv = ::text::csv;
+
+#if defined(TEXT_CSV_HAS_POSIX_IO)
+
+namespace {
+
+std::string read_file(const char *path) {
+    std::ifstream in(path, std::ios_base::binary);
+    std::ostringstream contents;
+    contents << in.rdbuf();
+    return contents.str();
+}
+}
+
+#endif
+
+BOOST_AUTO_TEST_SUITE(csv_sink)
+
+BOOST_AUTO_TEST_CASE(growable_memory_test) {
+    csv::memory_buf buf;
+    BOOST_CHECK(buf.growable());
+    std::ostream os(&buf);
+    csv::csv_ostream out(os);
+    format_rows(out, 3000);
+    BOOST_CHECK(os.good());
+    BOOST_CHECK_EQUAL(std::string(buf.data(), buf.size()), expected_rows(3000));
+
+    std::string taken;
+    buf.swap(taken);
+    BOOST_CHECK_EQUAL(buf.size(), 0u);
+    BOOST_CHECK(taken == expected_rows(3000));
+
+    format_rows(out, 2);
+    BOOST_CHECK_EQUAL(std::string(buf.data(), buf.size()), expected_rows(2));
+}
+
+BOOST_AUTO_TEST_CASE(fixed_memory_test) {
+    char storage[16];
+    csv::memory_buf buf(storage, sizeof(storage));
+    BOOST_CHECK(!buf.growable());
+    std::ostream os(&buf);
+    csv::csv_ostream out(os);
+    out << "abc" << 12 << csv::endl;
+    BOOST_CHECK(os.good());
+    BOOST_CHECK_EQUAL(std::string(buf.data(), buf.size()), "abc,12\r\n");
+
+    out << "too long to fit" << csv::endl;
+    BOOST_CHECK(os.bad());
+    BOOST_CHECK_EQUAL(buf.size(), sizeof(storage));
+
+    // A record that fills the buffer exactly still fits.
+    csv::memory_buf exact(storage, sizeof(storage));
+    std::ostream exact_os(&exact);
+    csv::csv_ostream exact_out(exact_os);
+    exact_out << "abc" << 12 << csv::endl << "1234" << 5 << csv::endl;
+    BOOST_CHECK(exact_os.good());
+    BOOST_CHECK_EQUAL(std::string(exact.data(), exact.size()),
+                      "abc,12\r\n1234,5\r\n");
+    exact_out << "" << csv::endl;
+    BOOST_CHECK(exact_os.bad());
+}
+
+#if defined(TEXT_CSV_HAS_POSIX_IO)
+
+BOOST_AUTO_TEST_CASE(fd_test) {
+    char path[] = "/tmp/text_csv_sink_XXXXXX";
+    const int fd = ::mkstemp(path);
+    BOOST_REQUIRE(fd >= 0);
+    {
+        csv::fd_buf buf(fd, 100);
+        std::ostream os(&buf);
+        csv::csv_ostream out(os);
+        format_rows(out, 1000);
+        os.flush();
+        BOOST_CHECK(os.good());
+        BOOST_CHECK_EQUAL(buf.error(), 0);
+    }
+    ::close(fd);
+    BOOST_CHECK(read_file(path) == expected_rows(1000));
+    std::remove(path);
+
+    csv::fd_buf bad(-1, 0);
+    std::ostream os(&bad);
+    csv::csv_ostream out(os);
+    out << "x" << csv::endl;
+    BOOST_CHECK(os.bad());
+    BOOST_CHECK_EQUAL(bad.error(), EBADF);
+}
+
+BOOST_AUTO_TEST_CASE(mmap_test) {
+    char path[] = "/tmp/text_csv_mmap_XXXXXX";
+    const int fd = ::mkstemp(path);
+    BOOST_REQUIRE(fd >= 0);
+    ::close(fd);
+
+    const std::string expected = expected_rows(1000);
+    {
+        csv::mmap_buf buf(path, expected.size() + 100);
+        std::ostream os(&buf);
+        csv::csv_ostream out(os);
+        format_rows(out, 1000);
+        BOOST_CHECK(os.good());
+        BOOST_CHECK_EQUAL(buf.size(), expected.size());
+        buf.close();
+    }
+    BOOST_CHECK(read_file(path) == expected);
+
+    {
+        csv::mmap_buf buf(path, 4);
+        std::ostream os(&buf);
+        csv::csv_ostream out(os);
+        out << "abcdef" << csv::endl;
+        BOOST_CHECK(os.bad());
+    }
+    BOOST_CHECK_EQUAL(read_file(path), "abcd");
+    std::remove(path);
+}
+
+#endif
+
+BOOST_AUTO_TEST_SUITE_END()
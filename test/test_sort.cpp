@@ -0,0 +1,139 @@
+#include "text/csv/sort.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace csv = ::text::csv;
+
+namespace {
+
+struct record {
+    int key;
+    std::string text;
+    int seq;
+};
+
+bool by_key(const record &a, const record &b) { return a.key < b.key; }
+
+std::vector<record> make_records(std::size_t n) {
+    std::vector<record> v;
+    unsigned state = 12345;
+    for (std::size_t i = 0; i < n; ++i) {
+        state = state * 1103515245u + 12345u;
+        record r;
+        r.key = int((state >> 16) % 100) - 50;
+        std::ostringstream text;
+        text << "line " << i << (i % 7 == 0 ? "\r\nwith \"break\"" : ", x");
+        r.text = text.str();
+        r.seq = int(i);
+        v.push_back(r);
+    }
+    return v;
+}
+
+std::string to_csv(const std::vector<record> &v, bool header) {
+    std::ostringstream os;
+    csv::csv_ostream out(os);
+    if (header)
+        out << "key" << "text" << "seq" << csv::endl;
+    for (std::size_t i = 0; i < v.size(); ++i)
+        out << v[i].key << v[i].text << v[i].seq << csv::endl;
+    return os.str();
+}
+
+std::string external_sort(const std::string &text, std::size_t budget,
+                          unsigned threads) {
+    csv::external_sort sorter;
+    sorter.add_key(csv::sort_key(0, csv::int64_column));
+    sorter.has_header(true);
+    sorter.memory_budget(budget);
+    sorter.max_fan_in(3);
+    sorter.threads(threads);
+
+    std::istringstream in(text);
+    std::ostringstream out;
+    sorter.sort(in, out);
+    return out.str();
+}
+}
+
+BOOST_AUTO_TEST_SUITE(csv_sort)
+
+BOOST_AUTO_TEST_CASE(in_memory_sort_test) {
+    std::vector<record> v = make_records(200);
+    const std::string text = to_csv(v, true);
+    std::stable_sort(v.begin(), v.end(), by_key);
+    BOOST_CHECK(to_csv(v, true) == external_sort(text, 1 << 20, 1));
+}
+
+BOOST_AUTO_TEST_CASE(spilling_sort_test) {
+    std::vector<record> v = make_records(2000);
+    const std::string text = to_csv(v, true);
+    std::stable_sort(v.begin(), v.end(), by_key);
+    const std::string expected = to_csv(v, true);
+
+    BOOST_CHECK(expected == external_sort(text, 4096, 1));
+    BOOST_CHECK(expected == external_sort(text, 4096, 4));
+}
+
+BOOST_AUTO_TEST_CASE(nan_key_sort_test) {
+    std::ostringstream text, nans;
+    std::vector<std::string> by_value(13);
+    for (int i = 0; i < 2000; ++i) {
+        std::ostringstream line;
+        if (i % 3 == 1) {
+            line << "nan," << i << "\r\n";
+            nans << line.str();
+        } else {
+            line << (i * 7) % 13 << "," << i << "\r\n";
+            by_value[(i * 7) % 13] += line.str();
+        }
+        text << line.str();
+    }
+    std::string expected = nans.str();
+    for (std::size_t k = 0; k < by_value.size(); ++k)
+        expected += by_value[k];
+
+    for (std::size_t budget = 4096; budget <= (1 << 20); budget <<= 8) {
+        csv::external_sort sorter;
+        sorter.add_key(csv::sort_key(0, csv::double_column));
+        sorter.memory_budget(budget);
+        std::istringstream in(text.str());
+        std::ostringstream out;
+        sorter.sort(in, out);
+        BOOST_CHECK(expected == out.str());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(lexicographic_descending_sort_test) {
+    std::istringstream in("b,1\na,2\nc,3\n,4\n");
+    std::ostringstream out;
+    csv::external_sort sorter;
+    sorter.add_key(csv::sort_key(0, csv::string_column, true));
+    sorter.sort(in, out);
+    BOOST_CHECK_EQUAL("c,3\r\nb,1\r\na,2\r\n,4\r\n", out.str());
+}
+
+BOOST_AUTO_TEST_CASE(merge_sorted_test) {
+    std::istringstream a("id,v\n1,a\n4,d\n10,j\n");
+    std::istringstream b("id,v\n2,b\n4,e\n");
+    std::istringstream c("id,v\n");
+    std::vector<std::istream *> inputs;
+    inputs.push_back(&a);
+    inputs.push_back(&b);
+    inputs.push_back(&c);
+
+    std::vector<csv::sort_key> keys;
+    keys.push_back(csv::sort_key(0, csv::int64_column));
+
+    std::ostringstream out;
+    csv::merge_sorted(inputs, out, keys, true);
+    BOOST_CHECK_EQUAL("id,v\r\n1,a\r\n2,b\r\n4,d\r\n4,e\r\n10,j\r\n",
+                      out.str());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
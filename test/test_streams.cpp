@@ -105,6 +105,33 @@ BOOST_AUTO_TEST_CASE(numbers_with_commas) {
     BOOST_CHECK_EQUAL(os.str(), "\"1,000,000\",\"20,000\",100\r\n");
 }
 
+BOOST_AUTO_TEST_CASE(shortest_numbers_test) {
+    std::ostringstream os;
+    os.precision(3);
+    csv::csv_ostream csv_out(os);
+    BOOST_CHECK(csv_out.format() == csv::shortest_format);
+
+    csv_out << 0.1 + 0.2 << 0.1f << 1e21 << -2.5 << 100.0 << csv::endl;
+    csv_out << -2147483647 - 1 << 4294967295u << true << 0L << csv::endl;
+    BOOST_CHECK_EQUAL(os.str(), "0.30000000000000004,0.1,1e+21,-2.5,100\r\n"
+                                "-2147483648,4294967295,1,0\r\n");
+
+    os.str("");
+    csv_out.format(csv::stream_format);
+    csv_out << 0.1 + 0.2 << 1234.5 << csv::endl;
+    BOOST_CHECK_EQUAL(os.str(), "0.3,1.23e+03\r\n");
+}
+
+BOOST_AUTO_TEST_CASE(numbers_with_stream_flags) {
+    std::ostringstream os;
+    csv::csv_ostream csv_out(os, '.');
+
+    csv_out << 1.5 << 2 << csv::endl;
+    os << std::hex;
+    csv_out << 255 << csv::endl;
+    BOOST_CHECK_EQUAL(os.str(), "\"1.5\".2\r\nff\r\n");
+}
+
 BOOST_AUTO_TEST_CASE(line_break_in_field) {
     std::ostringstream os;
     csv::csv_ostream csv_out(os);
@@ -115,6 +142,114 @@ BOOST_AUTO_TEST_CASE(line_break_in_field) {
     BOOST_CHECK_EQUAL(os.str(), "\"\r\n\",\"\r\",\"\n\"");
 }
 
+BOOST_AUTO_TEST_CASE(buffered_output_test) {
+    std::ostringstream os;
+    {
+        csv::csv_ostream csv_out(os);
+        csv_out.buffer_size(32);
+
+        csv_out << "a" << "b,c" << csv::endl;
+        BOOST_CHECK(os.str().empty());
+        csv_out << "a \"quoted\" word" << 12 << csv::endl;
+        BOOST_CHECK_EQUAL(os.str(), "a,\"b,c\"\r\n"
+                                    "\"a \"\"quoted\"\" word\",12\r\n");
+
+        csv_out << "tail" << csv::endl;
+        csv_out << "x";
+        csv_out.flush();
+        BOOST_CHECK_EQUAL(os.str(), "a,\"b,c\"\r\n"
+                                    "\"a \"\"quoted\"\" word\",12\r\n"
+                                    "tail\r\nx");
+        csv_out << "y" << csv::endl;
+    }
+    // The rest is committed on destruction.
+    BOOST_CHECK_EQUAL(os.str(), "a,\"b,c\"\r\n"
+                                "\"a \"\"quoted\"\" word\",12\r\n"
+                                "tail\r\nx,y\r\n");
+}
+
+namespace {
+
+template <typename Char>
+std::basic_string<Char> quote_naively(const std::basic_string<Char> &s) {
+    const Char special[] = { ',', '"', '\r', '\n' };
+    if (s.find_first_of(special, 0, 4) == std::basic_string<Char>::npos)
+        return s;
+    std::basic_string<Char> r(1, '"');
+    for (std::size_t i = 0; i < s.size(); ++i) {
+        if (s[i] == '"')
+            r += Char('"');
+        r += s[i];
+    }
+    return r + Char('"');
+}
+
+template <typename Char>
+void long_field_test() {
+    const char alphabet[] = "abcdefgh ,\"\r\n";
+    unsigned state = 1;
+    for (std::size_t len = 0; len < 80; ++len) {
+        for (int round = 0; round < 20; ++round) {
+            std::basic_string<Char> s;
+            for (std::size_t i = 0; i < len; ++i) {
+                state = state * 1103515245u + 12345u;
+                // Special symbols are rare, so most of them land in the
+                // middle of a long field.
+                const unsigned r = (state >> 16) % 64;
+                s += Char(alphabet[r < 8 ? r : r < 59 ? 0 : r - 51]);
+            }
+            std::basic_ostringstream<Char> os;
+            text::csv::basic_csv_ostream<Char> csv_out(os);
+            csv_out << s;
+            BOOST_CHECK(os.str() == quote_naively(s));
+        }
+    }
+}
+}
+
+BOOST_AUTO_TEST_CASE(long_field_quoting_test) {
+    long_field_test<char>();
+    long_field_test<wchar_t>();
+}
+
+BOOST_AUTO_TEST_CASE(quoting_modes_test) {
+    std::ostringstream os;
+    csv::csv_ostream csv_out(os);
+    BOOST_CHECK(csv_out.quoting() == csv::quote_minimal);
+
+    const char *const styles[] = {"minimal", "all", "non-numeric", "none"};
+    const csv::quote_style modes[] = {csv::quote_minimal, csv::quote_all,
+                                      csv::quote_non_numeric,
+                                      csv::quote_none};
+    for (std::size_t i = 0; i < 4; ++i) {
+        csv_out.quoting(modes[i]);
+        csv_out << styles[i] << "a,b" << "say \"hi\"" << 12 << -0.5 << ""
+                << csv::endl;
+    }
+    BOOST_CHECK_EQUAL(
+        os.str(),
+        "minimal,\"a,b\",\"say \"\"hi\"\"\",12,-0.5,\r\n"
+        "\"all\",\"a,b\",\"say \"\"hi\"\"\",\"12\",\"-0.5\",\"\"\r\n"
+        "\"non-numeric\",\"a,b\",\"say \"\"hi\"\"\",12,-0.5,\"\"\r\n"
+        "none,a,b,say \"hi\",12,-0.5,\r\n");
+
+    std::wostringstream wos;
+    wos << std::hex;
+    csv::csv_wostream wcsv_out(wos);
+    wcsv_out.quoting(csv::quote_all);
+    wcsv_out << L"x" << 255 << csv::endl;
+    BOOST_CHECK(wos.str() == L"\"x\",\"ff\"\r\n");
+}
+
+BOOST_AUTO_TEST_CASE(failed_output_test) {
+    // The default overflow() of a stream buffer rejects every character.
+    struct full_buf : std::streambuf {} sb;
+    std::ostream os(&sb);
+    csv::csv_ostream csv_out(os);
+    csv_out << "a";
+    BOOST_CHECK(os.bad());
+}
+
 BOOST_AUTO_TEST_CASE(empty_cells_test) {
     std::ostringstream os;
     csv::csv_ostream csv_out(os);
@@ -228,6 +363,29 @@ BOOST_AUTO_TEST_CASE(line_splitting) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(skip_field_test) {
+    std::istringstream in("\"skip, \"\"me\"\"\",plain,keep\r\n"
+                          "\"a\nb\"\rnext");
+    csv::csv_istream is(in);
+    std::string s;
+    is.skip_field();
+    BOOST_CHECK(is.has_more_fields());
+    is.skip_field();
+    is >> s;
+    BOOST_CHECK_EQUAL(s, "keep");
+    BOOST_CHECK(!is.has_more_fields());
+    is.skip_field();
+    BOOST_CHECK(!is.has_more_fields());
+    BOOST_CHECK_EQUAL(is.line_number(), 3u);
+    is >> s;
+    BOOST_CHECK_EQUAL(s, "next");
+    BOOST_CHECK(!is);
+
+    std::istringstream bad("\"open");
+    csv::csv_istream bad_is(bad);
+    BOOST_CHECK_THROW(bad_is.skip_field(), std::runtime_error);
+}
+
 BOOST_AUTO_TEST_CASE(wide_input_stream) {
     const wchar_t *parts[] = { L"1", L"2", L"3", L"4" };
     const wchar_t *const text = L"1,2,3,4";
@@ -0,0 +1,99 @@
+#include "text/csv/table.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <sstream>
+#include <string>
+
+namespace csv = ::text::csv;
+
+BOOST_AUTO_TEST_SUITE(csv_table)
+
+BOOST_AUTO_TEST_CASE(bitmap_test) {
+    csv::bitmap b;
+    for (int i = 0; i < 130; ++i) {
+        b.push_back(i % 3 == 0);
+    }
+    BOOST_CHECK_EQUAL(130u, b.size());
+    BOOST_CHECK_EQUAL(44u, b.count());
+    BOOST_CHECK(b[0]);
+    BOOST_CHECK(!b[64]);
+    BOOST_CHECK(b[129]);
+}
+
+BOOST_AUTO_TEST_CASE(string_table_test) {
+    std::istringstream in("name,city\nJohn,Paris\n\"Smith, Jr\",\nAnn,Rome\n");
+    csv::table t(in);
+
+    BOOST_CHECK_EQUAL(3u, t.row_count());
+    BOOST_CHECK_EQUAL(2u, t.column_count());
+
+    const csv::table::table_column &name = t.column("name");
+    BOOST_CHECK_EQUAL(csv::string_column, name.type());
+    BOOST_CHECK_EQUAL("Smith, Jr", name.string_value(1).str());
+
+    const csv::table::table_column &city = t.column(1);
+    BOOST_CHECK_EQUAL("Rome", city.string_value(2).str());
+    BOOST_CHECK(city.is_null(1));
+    BOOST_CHECK_EQUAL(1u, city.null_count());
+
+    BOOST_CHECK_THROW(t.column("age"), std::out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE(typed_table_test) {
+    std::istringstream in("id,price,active,currency\n"
+                          "1,9.5,true,USD\n"
+                          "2,,false,EUR\n"
+                          "3,0.25,1,USD\n"
+                          "4,1e3\n");
+    csv::schema s;
+    s.add("id", csv::int64_column, false);
+    s.add("price", csv::double_column);
+    s.add("active", csv::bool_column);
+    s.add("currency");
+    s[3].dictionary = true;
+
+    csv::table t(in, s);
+    BOOST_REQUIRE_EQUAL(4u, t.row_count());
+
+    const int64_t *ids = t.column(0).int64_data();
+    BOOST_CHECK_EQUAL(1, ids[0]);
+    BOOST_CHECK_EQUAL(4, ids[3]);
+
+    const csv::table::table_column &price = t.column("price");
+    BOOST_CHECK_EQUAL(9.5, price.double_data()[0]);
+    BOOST_CHECK(price.is_null(1));
+    BOOST_CHECK_EQUAL(1000.0, price.double_data()[3]);
+
+    const csv::table::table_column &active = t.column(2);
+    BOOST_CHECK(active.bool_value(0));
+    BOOST_CHECK(!active.bool_value(1));
+    BOOST_CHECK(active.bool_value(2));
+    BOOST_CHECK(active.is_null(3));
+
+    const csv::table::table_column &currency = t.column(3);
+    BOOST_CHECK(currency.is_encoded());
+    BOOST_CHECK_EQUAL(2u, currency.dictionary().size());
+    BOOST_CHECK_EQUAL(currency.codes()[0], currency.codes()[2]);
+    BOOST_CHECK_EQUAL("EUR", currency.string_value(1).str());
+    BOOST_CHECK(currency.is_null(3));
+}
+
+BOOST_AUTO_TEST_CASE(invalid_table_value_test) {
+    csv::schema s;
+    s.add("id", csv::int64_column, false);
+
+    std::istringstream bad("id\n1\nx\n");
+    BOOST_CHECK_THROW(csv::table(bad, s), std::runtime_error);
+
+    std::istringstream missing("id\n1\n\n2\n");
+    BOOST_CHECK_THROW(csv::table(missing, s), std::runtime_error);
+
+    csv::schema names;
+    names.add("id");
+    names.add("name", csv::string_column, false);
+    std::istringstream short_row("id,name\n1,ann\n2\n");
+    BOOST_CHECK_THROW(csv::table(short_row, names), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()